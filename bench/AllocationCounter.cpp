@@ -0,0 +1,51 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//                               This file is part of CosmoScout VR                               //
+//      and may be used under the terms of the MIT license. See the LICENSE file for details.     //
+//                        Copyright: (c) 2019 German Aerospace Center (DLR)                       //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "AllocationCounter.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+std::atomic<uint64_t> sAllocations{0};
+
+} // namespace
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void* operator new(std::size_t size) {
+  sAllocations.fetch_add(1, std::memory_order_relaxed);
+
+  if (void* ptr = std::malloc(size == 0 ? 1 : size)) {
+    return ptr;
+  }
+
+  throw std::bad_alloc();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void operator delete(void* ptr) noexcept {
+  std::free(ptr);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void operator delete(void* ptr, std::size_t /*size*/) noexcept {
+  std::free(ptr);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace csp::measurementtools::bench {
+
+uint64_t getAllocationCount() {
+  return sAllocations.load(std::memory_order_relaxed);
+}
+
+} // namespace csp::measurementtools::bench
@@ -0,0 +1,21 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//                               This file is part of CosmoScout VR                               //
+//      and may be used under the terms of the MIT license. See the LICENSE file for details.     //
+//                        Copyright: (c) 2019 German Aerospace Center (DLR)                       //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef CSP_MEASUREMENT_TOOLS_BENCH_ALLOCATION_COUNTER_HPP
+#define CSP_MEASUREMENT_TOOLS_BENCH_ALLOCATION_COUNTER_HPP
+
+#include <cstdint>
+
+namespace csp::measurementtools::bench {
+
+/// The benchmark executable replaces the global operator new, so that the number of heap
+/// allocations of each benchmark can be reported. This returns the number of allocations since
+/// the start of the program on all threads.
+uint64_t getAllocationCount();
+
+} // namespace csp::measurementtools::bench
+
+#endif // CSP_MEASUREMENT_TOOLS_BENCH_ALLOCATION_COUNTER_HPP
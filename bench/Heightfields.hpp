@@ -0,0 +1,83 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//                               This file is part of CosmoScout VR                               //
+//      and may be used under the terms of the MIT license. See the LICENSE file for details.     //
+//                        Copyright: (c) 2019 German Aerospace Center (DLR)                       //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef CSP_MEASUREMENT_TOOLS_BENCH_HEIGHTFIELDS_HPP
+#define CSP_MEASUREMENT_TOOLS_BENCH_HEIGHTFIELDS_HPP
+
+#include "../src/HeightCache.hpp"
+
+#include <glm/glm.hpp>
+
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <utility>
+
+/// Analytic terrains which replace CelestialBody::getHeight() in the benchmarks. All of them are
+/// cheap to evaluate, so that the measured times are dominated by the calculations themselves.
+namespace csp::measurementtools::bench {
+
+/// The equatorial radius of the moon, all benchmarks use a body of this size.
+const double BODY_RADIUS = 1737400.0;
+
+struct Heightfield {
+  std::string               mName;
+  HeightCache::HeightSource mHeight;
+};
+
+/// A flat surface, the mesh is not refined because of the terrain then.
+inline double flat(glm::dvec2 const& /*lngLat*/) {
+  return 0.0;
+}
+
+/// Overlapping waves of a few hundred meters on a scale of some kilometers.
+inline double waves(glm::dvec2 const& lngLat) {
+  return 800.0 * std::sin(lngLat.x * 900.0) * std::cos(lngLat.y * 700.0) +
+         300.0 * std::sin(lngLat.y * 2300.0 + 1.0) + 1000.0;
+}
+
+/// A crater with a raised rim in the middle of the test polygons.
+inline double crater(glm::dvec2 const& lngLat) {
+  double r = glm::length(lngLat - glm::dvec2(0.3, 0.2)) * BODY_RADIUS / 5000.0;
+  return 500.0 * std::exp(-(r - 1.0) * (r - 1.0) * 8.0) - 800.0 * std::exp(-r * r * 2.0);
+}
+
+inline std::array<Heightfield, 3> const& getHeightfields() {
+  static const std::array<Heightfield, 3> heightfields{
+      {{"flat", flat}, {"waves", waves}, {"crater", crater}}};
+  return heightfields;
+}
+
+/// Wraps a heightfield and counts how often it is queried.
+class CountingHeightSource {
+ public:
+  explicit CountingHeightSource(HeightCache::HeightSource source)
+      : mSource(std::move(source)) {
+  }
+
+  double operator()(glm::dvec2 const& lngLat) {
+    ++mQueries;
+    return mSource(lngLat);
+  }
+
+  uint64_t getQueries() const {
+    return mQueries.load();
+  }
+
+  void reset() {
+    mQueries = 0;
+  }
+
+ private:
+  HeightCache::HeightSource mSource;
+  std::atomic<uint64_t>     mQueries{0};
+};
+
+} // namespace csp::measurementtools::bench
+
+#endif // CSP_MEASUREMENT_TOOLS_BENCH_HEIGHTFIELDS_HPP
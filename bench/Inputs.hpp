@@ -0,0 +1,130 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//                               This file is part of CosmoScout VR                               //
+//      and may be used under the terms of the MIT license. See the LICENSE file for details.     //
+//                        Copyright: (c) 2019 German Aerospace Center (DLR)                       //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef CSP_MEASUREMENT_TOOLS_BENCH_INPUTS_HPP
+#define CSP_MEASUREMENT_TOOLS_BENCH_INPUTS_HPP
+
+#include "../src/voronoi/Site.hpp"
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+/// Synthetic inputs for the benchmarks. All of them are generated with a fixed seed, so that the
+/// results of different builds can be compared.
+namespace csp::measurementtools::bench {
+
+enum class SiteSet { eRandom, eClustered, eCollinear, eGrid };
+
+/// Returns about count sites in the unit square. The grid has the next smaller square number of
+/// sites.
+inline std::vector<Site> createSites(SiteSet set, size_t count) {
+  std::vector<Site> sites;
+  std::mt19937      rng(42);
+
+  std::uniform_real_distribution<double> uniform(0.0, 1.0);
+
+  switch (set) {
+  case SiteSet::eRandom:
+    for (size_t i = 0; i < count; ++i) {
+      sites.emplace_back(uniform(rng), uniform(rng), static_cast<uint32_t>(i));
+    }
+    break;
+
+  case SiteSet::eClustered: {
+    // A few tight clusters, as they are created by the refinement of the mesh.
+    std::normal_distribution<double> normal(0.0, 0.02);
+
+    size_t                  clusters = std::max<size_t>(1, count / 64);
+    std::vector<glm::dvec2> centers(clusters);
+    for (auto& c : centers) {
+      c = glm::dvec2(0.1 + 0.8 * uniform(rng), 0.1 + 0.8 * uniform(rng));
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+      glm::dvec2 const& c = centers[i % clusters];
+      sites.emplace_back(c.x + normal(rng), c.y + normal(rng), static_cast<uint32_t>(i));
+    }
+    break;
+  }
+
+  case SiteSet::eCollinear:
+    // Points on the edges of a polygon are collinear, the sweep line has to cope with that.
+    for (size_t i = 0; i < count; ++i) {
+      double t = static_cast<double>(i) / static_cast<double>(count);
+      sites.emplace_back(t, 0.5 * t, static_cast<uint32_t>(i));
+    }
+    break;
+
+  case SiteSet::eGrid: {
+    // Many cocircular points, which are the worst case for the circle events.
+    // The grid spans the whole unit square. With size - 1 cells per row, the coordinates are not
+    // exactly representable, which is what happens for real meshes, too.
+    auto   size    = static_cast<size_t>(std::sqrt(static_cast<double>(count)));
+    double spacing = 1.0 / static_cast<double>(std::max<size_t>(size, 2) - 1);
+    for (size_t y = 0; y < size; ++y) {
+      for (size_t x = 0; x < size; ++x) {
+        sites.emplace_back(static_cast<double>(x) * spacing, static_cast<double>(y) * spacing,
+            static_cast<uint32_t>(sites.size()));
+      }
+    }
+    break;
+  }
+  }
+
+  return sites;
+}
+
+enum class Shape { eSquare, eStar, eBlob, eConcave };
+
+/// Returns the corners of a test polygon in lng/lat (radians). All polygons are a few kilometers
+/// large on a moon-sized body.
+inline std::vector<glm::dvec2> createPolygon(Shape shape) {
+  std::vector<glm::dvec2> corners;
+
+  const double pi = 3.14159265358979323846;
+  glm::dvec2   c(0.3, 0.2);
+
+  switch (shape) {
+  case Shape::eSquare: {
+    double s = 0.003;
+    corners  = {c + glm::dvec2(-s, -s), c + glm::dvec2(s, -s), c + glm::dvec2(s, s),
+        c + glm::dvec2(-s, s)};
+    break;
+  }
+
+  case Shape::eStar:
+    for (int i = 0; i < 10; ++i) {
+      double a = i * 2.0 * pi / 10.0;
+      double r = (i % 2 != 0) ? 0.004 : 0.0015;
+      corners.push_back(c + r * glm::dvec2(std::cos(a), std::sin(a)));
+    }
+    break;
+
+  case Shape::eBlob:
+    for (int i = 0; i < 25; ++i) {
+      double a = i * 2.0 * pi / 25.0;
+      double r = 0.01 * (1.0 + 0.3 * std::sin(3.0 * a) + 0.1 * std::cos(7.0 * a));
+      corners.push_back(c + r * glm::dvec2(std::cos(a), std::sin(a)));
+    }
+    break;
+
+  case Shape::eConcave:
+    corners = {c, c + glm::dvec2(0.008, 0.0), c + glm::dvec2(0.008, 0.008),
+        c + glm::dvec2(0.004, 0.002), c + glm::dvec2(0.0, 0.008)};
+    break;
+  }
+
+  return corners;
+}
+
+} // namespace csp::measurementtools::bench
+
+#endif // CSP_MEASUREMENT_TOOLS_BENCH_INPUTS_HPP
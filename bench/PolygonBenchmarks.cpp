@@ -0,0 +1,147 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//                               This file is part of CosmoScout VR                               //
+//      and may be used under the terms of the MIT license. See the LICENSE file for details.     //
+//                        Copyright: (c) 2019 German Aerospace Center (DLR)                       //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "../../../src/cs-utils/convert.hpp"
+#include "../src/PolygonCalculator.hpp"
+#include "../src/Statistics.hpp"
+#include "../src/ThreadPool.hpp"
+#include "AllocationCounter.hpp"
+#include "Heightfields.hpp"
+#include "Inputs.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <array>
+#include <string>
+
+namespace csp::measurementtools::bench {
+
+namespace {
+
+const std::array<char const*, 4> SHAPE_NAMES = {"square", "star", "blob", "concave"};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// The arguments of all polygon benchmarks are the shape, the heightfield and the maximum number of
+// mesh points.
+PolygonCalculator::Input createInput(
+    benchmark::State& state, CountingHeightSource& heights, ThreadPool* threadPool) {
+  auto shape = static_cast<Shape>(state.range(0));
+
+  PolygonCalculator::Input input;
+  input.mRadii        = glm::dvec3(BODY_RADIUS);
+  input.mHeightSource = [&heights](glm::dvec2 const& lngLat) { return heights(lngLat); };
+  input.mThreadPool   = threadPool;
+  input.mMaxPoints    = static_cast<uint32_t>(state.range(2));
+
+  for (auto const& lngLat : createPolygon(shape)) {
+    input.mPositions.push_back(
+        cs::utils::convert::toCartesian(lngLat, BODY_RADIUS, BODY_RADIUS, heights(lngLat)));
+  }
+
+  state.SetLabel(std::string(SHAPE_NAMES.at(static_cast<size_t>(shape))) + "/" +
+                 getHeightfields().at(static_cast<size_t>(state.range(1))).mName);
+
+  return input;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Runs the calculator with the given number of refinement attempts.
+void runCalculator(benchmark::State& state, uint32_t maxAttempt, ThreadPool* threadPool) {
+  CountingHeightSource heights(
+      getHeightfields().at(static_cast<size_t>(state.range(1))).mHeight);
+
+  PolygonCalculator::Input input = createInput(state, heights, threadPool);
+  input.mMaxAttempt              = maxAttempt;
+
+  uint64_t   allocations = 0;
+  uint64_t   queries     = 0;
+  size_t     vertices    = 0;
+  Statistics statistics;
+
+  PolygonCalculator::Result result;
+
+  for (auto _ : state) {
+    heights.reset();
+    uint64_t before = getAllocationCount();
+
+    PolygonCalculator calculator(input);
+    std::atomic_bool  cancel(false);
+    calculator.compute(cancel);
+
+    allocations += getAllocationCount() - before;
+    queries += heights.getQueries();
+
+    result   = std::move(calculator.getResult());
+    vertices = result.mMesh.empty() ? 0 : result.mMesh.back().mVertices.size();
+    statistics.merge(result.mStatistics);
+  }
+
+  if (!result.mValid) {
+    state.SkipWithError("The polygon is invalid.");
+    return;
+  }
+
+  state.counters["allocs"] =
+      benchmark::Counter(static_cast<double>(allocations), benchmark::Counter::kAvgIterations);
+  state.counters["queries"] =
+      benchmark::Counter(static_cast<double>(queries), benchmark::Counter::kAvgIterations);
+  state.counters["vertices"]  = static_cast<double>(vertices);
+  state.counters["area"]      = result.mArea;
+  state.counters["posVolume"] = result.mPosVolume;
+  state.counters["negVolume"] = result.mNegVolume;
+
+  // The time in milliseconds which was spent in each stage of the calculation per iteration. With
+  // a thread pool, this is the sum over all threads.
+  for (size_t i(0); i < static_cast<size_t>(Statistics::Stage::eCount); ++i) {
+    auto stage = static_cast<Statistics::Stage>(i);
+
+    if (statistics.getCalls(stage) > 0) {
+      state.counters[std::string(Statistics::getName(stage)) + "Ms"] =
+          benchmark::Counter(statistics.getTime(stage), benchmark::Counter::kAvgIterations);
+    }
+  }
+}
+
+} // namespace
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Only the Delaunay mesh of the polygon and the first estimate of area and volume.
+void PolygonFirstAttempt(benchmark::State& state) {
+  runCalculator(state, 1, nullptr);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void PolygonCompute(benchmark::State& state) {
+  runCalculator(state, PolygonCalculator::Input().mMaxAttempt, nullptr);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void PolygonComputeThreaded(benchmark::State& state) {
+  static ThreadPool threadPool;
+  runCalculator(state, PolygonCalculator::Input().mMaxAttempt, &threadPool);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+BENCHMARK(PolygonFirstAttempt)
+    ->ArgsProduct({{0, 1, 2, 3}, {0, 1, 2}, {1000}})
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(PolygonCompute)
+    ->ArgsProduct({{0, 1, 2, 3}, {0, 1, 2}, {1000, 10000}})
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(PolygonComputeThreaded)
+    ->ArgsProduct({{0, 1, 2, 3}, {0, 1, 2}, {10000}})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+} // namespace csp::measurementtools::bench
@@ -0,0 +1,88 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//                               This file is part of CosmoScout VR                               //
+//      and may be used under the terms of the MIT license. See the LICENSE file for details.     //
+//                        Copyright: (c) 2019 German Aerospace Center (DLR)                       //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef CSP_MEASUREMENT_TOOLS_BENCH_VALIDATION_HPP
+#define CSP_MEASUREMENT_TOOLS_BENCH_VALIDATION_HPP
+
+#include "../src/voronoi/VoronoiGenerator.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+/// Checks of the benchmark results, so that a faster but broken triangulation is not mistaken for
+/// an improvement.
+namespace csp::measurementtools::bench {
+
+/// Twice the signed area of the triangle (a, b, c) relative to a. Subtracting a first keeps the
+/// precision for sites far away from the origin.
+inline double orientation(Site const& a, Site const& b, Site const& c) {
+  return (b.mX - a.mX) * (c.mY - a.mY) - (b.mY - a.mY) * (c.mX - a.mX);
+}
+
+/// Returns the area of the convex hull of the sites, computed with Andrew's monotone chain.
+inline double getHullArea(std::vector<Site> sites) {
+  std::sort(sites.begin(), sites.end(), [](Site const& a, Site const& b) {
+    return a.mX < b.mX || (a.mX == b.mX && a.mY < b.mY);
+  });
+
+  std::vector<Site> hull;
+
+  for (int pass = 0; pass < 2; ++pass) {
+    size_t start = hull.size();
+
+    for (auto const& site : sites) {
+      while (hull.size() >= start + 2 &&
+             orientation(hull[hull.size() - 2], hull.back(), site) <= 0.0) {
+        hull.pop_back();
+      }
+      hull.push_back(site);
+    }
+
+    // The last point of each chain is the first one of the other chain.
+    hull.pop_back();
+    std::reverse(sites.begin(), sites.end());
+  }
+
+  double area = 0.0;
+  for (size_t i = 1; i + 1 < hull.size(); ++i) {
+    area += orientation(hull[0], hull[i], hull[i + 1]);
+  }
+
+  return 0.5 * std::abs(area);
+}
+
+/// Returns true if the triangles of the generator cover the convex hull of the given sites
+/// exactly once. Overlapping triangles or holes change the total area of the triangles. The
+/// tolerance is relative to the extent of the sites.
+inline bool isValidTriangulation(
+    VoronoiGenerator const& generator, std::vector<Site> const& sites) {
+  if (sites.empty()) {
+    return generator.getTriangles().empty();
+  }
+
+  auto const& corners = generator.getSites();
+  double      area    = 0.0;
+
+  for (auto const& triangle : generator.getTriangles()) {
+    Site a(corners.mX[triangle[0]], corners.mY[triangle[0]], 0);
+    Site b(corners.mX[triangle[1]], corners.mY[triangle[1]], 0);
+    Site c(corners.mX[triangle[2]], corners.mY[triangle[2]], 0);
+    area += 0.5 * std::abs(orientation(a, b, c));
+  }
+
+  auto [minX, maxX] = std::minmax_element(sites.begin(), sites.end(),
+      [](Site const& a, Site const& b) { return a.mX < b.mX; });
+  auto [minY, maxY] = std::minmax_element(sites.begin(), sites.end(),
+      [](Site const& a, Site const& b) { return a.mY < b.mY; });
+  double extent     = std::max(maxX->mX - minX->mX, maxY->mY - minY->mY);
+
+  return std::abs(area - getHullArea(sites)) <= 1e-9 * extent * extent;
+}
+
+} // namespace csp::measurementtools::bench
+
+#endif // CSP_MEASUREMENT_TOOLS_BENCH_VALIDATION_HPP
@@ -0,0 +1,124 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//                               This file is part of CosmoScout VR                               //
+//      and may be used under the terms of the MIT license. See the LICENSE file for details.     //
+//                        Copyright: (c) 2019 German Aerospace Center (DLR)                       //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "../src/voronoi/VoronoiGenerator.hpp"
+#include "AllocationCounter.hpp"
+#include "Inputs.hpp"
+#include "Validation.hpp"
+
+#include <benchmark/benchmark.h>
+
+namespace csp::measurementtools::bench {
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void VoronoiParse(benchmark::State& state, SiteSet set) {
+  auto sites = createSites(set, static_cast<size_t>(state.range(0)));
+
+  // The triangulation is deterministic, so it is validated once outside of the timed loop.
+  {
+    VoronoiGenerator generator;
+    generator.parse(sites);
+
+    if (!isValidTriangulation(generator, sites)) {
+      state.SkipWithError("The triangles do not cover the convex hull of the sites exactly once!");
+      return;
+    }
+  }
+
+  uint64_t allocations = 0;
+  size_t   triangles   = 0;
+
+  for (auto _ : state) {
+    uint64_t before = getAllocationCount();
+
+    VoronoiGenerator generator;
+    generator.parse(sites);
+    triangles = generator.getTriangles().size();
+    benchmark::DoNotOptimize(triangles);
+
+    allocations += getAllocationCount() - before;
+  }
+
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * sites.size()));
+  state.counters["allocs"] = benchmark::Counter(
+      static_cast<double>(allocations), benchmark::Counter::kAvgIterations);
+  state.counters["triangles"] = static_cast<double>(triangles);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void VoronoiInsert(benchmark::State& state, SiteSet set) {
+  auto sites = createSites(set, static_cast<size_t>(state.range(0)));
+
+  // All sites are inserted one by one into a triangle which contains all of them, as it is done
+  // by PolygonCalculator::createMesh(). If the triangulation would be spanned by the first sites,
+  // most others would be outside of it and insert() would parse everything again.
+  auto              addr = static_cast<uint32_t>(sites.size());
+  std::vector<Site> bounds;
+  bounds.emplace_back(-10.0, -10.0, addr);
+  bounds.emplace_back(10.0, -10.0, addr + 1);
+  bounds.emplace_back(0.0, 10.0, addr + 2);
+
+  auto insertAll = [&](VoronoiGenerator& generator) {
+    generator.parse(bounds);
+
+    for (auto const& site : sites) {
+      generator.insert(site);
+    }
+  };
+
+  {
+    VoronoiGenerator generator;
+    insertAll(generator);
+
+    std::vector<Site> all(sites);
+    all.insert(all.end(), bounds.begin(), bounds.end());
+
+    if (!isValidTriangulation(generator, all)) {
+      state.SkipWithError("The triangles do not cover the convex hull of the sites exactly once!");
+      return;
+    }
+  }
+
+  uint64_t allocations = 0;
+
+  for (auto _ : state) {
+    uint64_t before = getAllocationCount();
+
+    VoronoiGenerator generator;
+    insertAll(generator);
+
+    benchmark::DoNotOptimize(generator.getTriangles().size());
+
+    allocations += getAllocationCount() - before;
+  }
+
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * sites.size()));
+  state.counters["allocs"] = benchmark::Counter(
+      static_cast<double>(allocations), benchmark::Counter::kAvgIterations);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+BENCHMARK_CAPTURE(VoronoiParse, random, SiteSet::eRandom)->RangeMultiplier(4)->Range(64, 16384);
+BENCHMARK_CAPTURE(VoronoiParse, clustered, SiteSet::eClustered)
+    ->RangeMultiplier(4)
+    ->Range(64, 16384);
+BENCHMARK_CAPTURE(VoronoiParse, collinear, SiteSet::eCollinear)
+    ->RangeMultiplier(4)
+    ->Range(64, 16384);
+BENCHMARK_CAPTURE(VoronoiParse, grid, SiteSet::eGrid)->RangeMultiplier(4)->Range(64, 16384);
+
+BENCHMARK_CAPTURE(VoronoiInsert, random, SiteSet::eRandom)->RangeMultiplier(4)->Range(64, 4096);
+BENCHMARK_CAPTURE(VoronoiInsert, clustered, SiteSet::eClustered)
+    ->RangeMultiplier(4)
+    ->Range(64, 4096);
+BENCHMARK_CAPTURE(VoronoiInsert, grid, SiteSet::eGrid)->RangeMultiplier(4)->Range(64, 4096);
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+} // namespace csp::measurementtools::bench
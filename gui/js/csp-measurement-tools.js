@@ -49,6 +49,49 @@
         node.checked = false;
       });
     }
+
+    /**
+     * Shows or hides the statistics of the last polygon calculation
+     * @param enable {boolean}
+     */
+    // eslint-disable-next-line class-methods-use-this
+    showStatistics(enable) {
+      document.getElementById('measurement-tools-statistics').hidden = !enable;
+    }
+
+    /**
+     * Displays the statistics of a polygon calculation
+     * @param json {string} The milliseconds of each stage and the counters of the calculation
+     */
+    // eslint-disable-next-line class-methods-use-this
+    setStatistics(json) {
+      const statistics = JSON.parse(json);
+      const { counters } = statistics;
+
+      const setValue = (id, value) => {
+        document.getElementById(`measurement-tools-statistics-${id}`).textContent = value;
+      };
+
+      setValue('attempts', counters.attempts);
+      setValue('points', counters.points);
+      setValue('queries', counters.heightQueries);
+
+      const stages = document.getElementById('measurement-tools-statistics-stages');
+      stages.innerHTML = '';
+
+      Object.entries(statistics.stages).forEach(([name, milliseconds]) => {
+        const label = document.createElement('div');
+        label.className = 'col-8';
+        label.textContent = name;
+
+        const value = document.createElement('div');
+        value.className = 'col-4 text-right';
+        value.textContent = `${milliseconds.toFixed(1)} ms`;
+
+        stages.appendChild(label);
+        stages.appendChild(value);
+      });
+    }
   }
 
   CosmoScout.init(MeasurementToolsApi);
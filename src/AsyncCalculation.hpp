@@ -0,0 +1,130 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//                               This file is part of CosmoScout VR                               //
+//      and may be used under the terms of the MIT license. See the LICENSE file for details.     //
+//                        Copyright: (c) 2019 German Aerospace Center (DLR)                       //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef CSP_MEASUREMENT_TOOLS_ASYNC_CALCULATION_HPP
+#define CSP_MEASUREMENT_TOOLS_ASYNC_CALCULATION_HPP
+
+#include "ThreadPool.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <memory>
+
+namespace csp::measurementtools {
+
+/// Runs the calculations of a tool on the thread pool, one at a time. The Calculator has to be
+/// constructible from its Input and has to provide bool compute(std::atomic_bool const& cancel),
+/// like the PolygonCalculator and the EllipseCalculator. Each calculator works on its own
+/// snapshot of the tool and holds the results until the tool collects them with poll() on the
+/// main thread. Starting a new calculation cancels the running one.
+template <typename Calculator>
+class AsyncCalculation {
+ public:
+  AsyncCalculation() = default;
+
+  AsyncCalculation(AsyncCalculation const& other) = delete;
+  AsyncCalculation(AsyncCalculation&& other)      = delete;
+
+  AsyncCalculation& operator=(AsyncCalculation const& other) = delete;
+  AsyncCalculation& operator=(AsyncCalculation&& other) = delete;
+
+  /// The running calculation only references its own data, so it is cancelled but not waited
+  /// for.
+  ~AsyncCalculation();
+
+  /// Cancels the running calculation and starts a new one with the given input.
+  void start(ThreadPool& threadPool, typename Calculator::Input input);
+
+  /// Tells the running calculation to stop. Its results are discarded.
+  void cancel();
+
+  bool isRunning() const;
+
+  /// The calculator of the running calculation, for example to query its progress. This is
+  /// nullptr if no calculation is running.
+  Calculator* getCalculator() const;
+
+  /// Returns the calculator once its calculation has finished. As long as it is still running, or
+  /// if it has been cancelled, nullptr is returned. Exceptions of compute() are rethrown. In any
+  /// case, no calculation is running after a finished one has been returned.
+  std::shared_ptr<Calculator> poll();
+
+ private:
+  std::shared_ptr<Calculator>       mCalculator;
+  std::shared_ptr<std::atomic_bool> mCancel;
+  std::future<bool>                 mFinished;
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+template <typename Calculator>
+AsyncCalculation<Calculator>::~AsyncCalculation() {
+  cancel();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+template <typename Calculator>
+void AsyncCalculation<Calculator>::start(ThreadPool& threadPool, typename Calculator::Input input) {
+  cancel();
+
+  auto calculator = std::make_shared<Calculator>(std::move(input));
+  auto cancel     = std::make_shared<std::atomic_bool>(false);
+
+  mFinished =
+      threadPool.enqueue([calculator, cancel]() { return calculator->compute(*cancel); });
+  mCalculator = std::move(calculator);
+  mCancel     = std::move(cancel);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+template <typename Calculator>
+void AsyncCalculation<Calculator>::cancel() {
+  if (mCalculator) {
+    mCancel->store(true);
+    mCalculator.reset();
+    mCancel.reset();
+    mFinished = {};
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+template <typename Calculator>
+bool AsyncCalculation<Calculator>::isRunning() const {
+  return mCalculator != nullptr;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+template <typename Calculator>
+Calculator* AsyncCalculation<Calculator>::getCalculator() const {
+  return mCalculator.get();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+template <typename Calculator>
+std::shared_ptr<Calculator> AsyncCalculation<Calculator>::poll() {
+  if (!mCalculator ||
+      mFinished.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+    return nullptr;
+  }
+
+  auto calculator = std::move(mCalculator);
+  auto finished   = std::move(mFinished);
+  mCancel.reset();
+
+  return finished.get() ? calculator : nullptr;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+} // namespace csp::measurementtools
+
+#endif // CSP_MEASUREMENT_TOOLS_ASYNC_CALCULATION_HPP
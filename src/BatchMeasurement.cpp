@@ -0,0 +1,105 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//                               This file is part of CosmoScout VR                               //
+//      and may be used under the terms of the MIT license. See the LICENSE file for details.     //
+//                        Copyright: (c) 2019 German Aerospace Center (DLR)                       //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "BatchMeasurement.hpp"
+
+#include "ThreadPool.hpp"
+#include "logger.hpp"
+
+#include <utility>
+
+namespace csp::measurementtools {
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+BatchMeasurement::BatchMeasurement(Input input)
+    : mInput(std::move(input)) {
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool BatchMeasurement::compute(std::atomic_bool const& cancel) {
+  mResult.mPolygons.assign(mInput.mPolygons.size(), {});
+  mResult.mPaths.assign(mInput.mPaths.size(), {});
+  mFinishedCount = 0;
+
+  // Polygons come first, as they are by far the most expensive items. This way the paths fill
+  // the gaps at the end.
+  auto measure = [&](size_t i) {
+    if (cancel.load()) {
+      return;
+    }
+
+    if (i < mInput.mPolygons.size()) {
+      PolygonCalculator::Input polygon = mInput.mPolygons[i];
+      polygon.mThreadPool              = nullptr;
+
+      PolygonCalculator calculator(std::move(polygon));
+
+      if (calculator.compute(cancel)) {
+        mResult.mPolygons[i] = std::move(calculator.getResult());
+        mResult.mPolygons[i].mMesh.clear();
+      }
+
+    } else {
+      auto const& path   = mInput.mPaths[i - mInput.mPolygons.size()];
+      auto&       result = mResult.mPaths[i - mInput.mPolygons.size()];
+
+      PathSampler sampler(path.mRadius, path.mHeightSource, path.mNumSamples, path.mTolerance,
+          path.mBatchHeightSource);
+      result.mProfile = sampler.getProfile(path.mPoints);
+      result.mLength  = result.mProfile.empty() ? 0.0 : result.mProfile.back().x;
+    }
+
+    ++mFinishedCount;
+  };
+
+  if (mInput.mThreadPool) {
+    mInput.mThreadPool->parallelFor(getCount(), measure);
+  } else {
+    for (size_t i = 0; i < getCount(); ++i) {
+      measure(i);
+    }
+  }
+
+  if (cancel.load()) {
+    return false;
+  }
+
+  logger().info("Measured {} polygons and {} paths.", mResult.mPolygons.size(),
+      mResult.mPaths.size());
+
+  Statistics statistics;
+  for (auto const& polygon : mResult.mPolygons) {
+    statistics.merge(polygon.mStatistics);
+  }
+
+  logger().debug("Polygon calculations of the batch: {}", statistics.toString());
+
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+BatchMeasurement::Result const& BatchMeasurement::getResult() const {
+  return mResult;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+size_t BatchMeasurement::getFinishedCount() const {
+  return mFinishedCount.load();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+size_t BatchMeasurement::getCount() const {
+  return mInput.mPolygons.size() + mInput.mPaths.size();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+} // namespace csp::measurementtools
@@ -0,0 +1,87 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//                               This file is part of CosmoScout VR                               //
+//      and may be used under the terms of the MIT license. See the LICENSE file for details.     //
+//                        Copyright: (c) 2019 German Aerospace Center (DLR)                       //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef CSP_MEASUREMENT_TOOLS_BATCH_MEASUREMENT_HPP
+#define CSP_MEASUREMENT_TOOLS_BATCH_MEASUREMENT_HPP
+
+#include "PathSampler.hpp"
+#include "PolygonCalculator.hpp"
+
+#include <glm/glm.hpp>
+
+#include <atomic>
+#include <vector>
+
+namespace csp::measurementtools {
+
+class ThreadPool;
+
+/// Measures many polygons and paths at once, for example to screen candidate landing sites. No
+/// tools, scene graph nodes or GUI items are created. The items are distributed over the threads
+/// of the given pool, each item is computed on a single thread. For thousands of items, this
+/// scales better than refining the triangles of each polygon in parallel.
+class BatchMeasurement {
+ public:
+  struct Path {
+    /// The points of the path in lng/lat (radians).
+    std::vector<glm::dvec2> mPoints;
+
+    double mRadius = 0.0;
+
+    /// Are called from the worker threads. The batch source is optional; if it is set, the
+    /// samples of one subdivision level are requested at once.
+    HeightCache::HeightSource      mHeightSource;
+    HeightCache::BatchHeightSource mBatchHeightSource;
+
+    int   mNumSamples = 256;
+    float mTolerance  = 0.F;
+  };
+
+  struct PathResult {
+    /// The distance along the path and the height of each sample, including the last point.
+    std::vector<glm::dvec2> mProfile;
+
+    double mLength = 0.0;
+  };
+
+  struct Input {
+    /// The thread pools of the inputs are ignored.
+    std::vector<PolygonCalculator::Input> mPolygons;
+    std::vector<Path>                     mPaths;
+
+    /// If this is not set, all items are computed on the calling thread.
+    ThreadPool* mThreadPool = nullptr;
+  };
+
+  struct Result {
+    /// The results are in the same order as the inputs. The meshes are not kept.
+    std::vector<PolygonCalculator::Result> mPolygons;
+    std::vector<PathResult>                mPaths;
+  };
+
+  explicit BatchMeasurement(Input input);
+
+  /// Computes all items. The cancel flag is checked before each item; if it is set, false is
+  /// returned and the result is incomplete.
+  bool compute(std::atomic_bool const& cancel);
+
+  Result const& getResult() const;
+
+  /// The number of items which have been computed so far. This can be called from any thread
+  /// while compute() is running.
+  size_t getFinishedCount() const;
+  size_t getCount() const;
+
+ private:
+  Input  mInput;
+  Result mResult;
+
+  std::atomic_size_t mFinishedCount{0};
+};
+
+} // namespace csp::measurementtools
+
+#endif // CSP_MEASUREMENT_TOOLS_BATCH_MEASUREMENT_HPP
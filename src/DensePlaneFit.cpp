@@ -0,0 +1,267 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//                               This file is part of CosmoScout VR                               //
+//      and may be used under the terms of the MIT license. See the LICENSE file for details.     //
+//                        Copyright: (c) 2019 German Aerospace Center (DLR)                       //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "DensePlaneFit.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+
+namespace csp::measurementtools {
+
+namespace {
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// The area and the middle of the polygon and the largest distance of a corner from the middle.
+void measure(std::vector<glm::dvec2> const& points, double& area, glm::dvec2& middle,
+    double& extent) {
+  area   = 0.0;
+  middle = glm::dvec2(0.0);
+  extent = 0.0;
+
+  for (size_t i = 0; i < points.size(); ++i) {
+    auto const& a = points[i];
+    auto const& b = points[(i + 1) % points.size()];
+
+    area += a.x * b.y - b.x * a.y;
+    middle += a / static_cast<double>(points.size());
+  }
+
+  area = std::abs(area) / 2.0;
+
+  for (auto const& point : points) {
+    extent = std::max(extent, glm::length(point - middle));
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// The smallest power of two which does not result in more than maxSamples cells.
+double getCellSize(double area, size_t maxSamples) {
+  if (area <= 0.0 || maxSamples == 0) {
+    return 0.0;
+  }
+
+  return std::exp2(std::ceil(std::log2(std::sqrt(area / static_cast<double>(maxSamples)))));
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+} // namespace
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+DensePlaneFit::DensePlaneFit(size_t maxSamples)
+    : mMaxSamples(maxSamples) {
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void DensePlaneFit::setMaxSamples(size_t maxSamples) {
+  mMaxSamples = maxSamples;
+  clear();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void DensePlaneFit::clear() {
+  mRadius   = 0.0;
+  mCellSize = 0.0;
+  mSamples.clear();
+  mFit.reset(glm::dvec3(0.0));
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void DensePlaneFit::update(double radius, HeightCache::HeightSource const& source,
+    std::vector<glm::dvec2> const& outline) {
+  if (outline.size() < 3 || radius <= 0.0) {
+    clear();
+    return;
+  }
+
+  // Only the directions of the corners matter for the grid.
+  std::vector<glm::dvec3> corners;
+  projection::toCartesian(radius, outline, std::vector<double>(outline.size(), 0.0), 1.0, corners);
+
+  glm::dvec3 center(0.0);
+  for (auto const& corner : corners) {
+    center += corner;
+  }
+
+  if (glm::length(center) <= 0.0) {
+    clear();
+    return;
+  }
+
+  std::vector<glm::dvec2> points;
+  double                  area   = 0.0;
+  double                  extent = 0.0;
+  glm::dvec2              middle(0.0);
+
+  bool projected = mCellSize > 0.0 && radius == mRadius && toPlane(corners, points);
+
+  if (projected) {
+    measure(points, area, middle, extent);
+  }
+
+  // The grid is placed anew if the cell size changed or if the polygon moved away from the point
+  // where the grid touches the body. Otherwise the grid would be distorted at the polygon.
+  if (!projected || getCellSize(area, mMaxSamples) != mCellSize || glm::length(middle) > extent) {
+    reset(radius, glm::normalize(center));
+
+    if (!toPlane(corners, points)) {
+      return;
+    }
+
+    measure(points, area, middle, extent);
+    mCellSize = getCellSize(area, mMaxSamples);
+  }
+
+  if (mCellSize <= 0.0) {
+    return;
+  }
+
+  double minY = std::numeric_limits<double>::max();
+  double maxY = std::numeric_limits<double>::lowest();
+
+  for (auto const& point : points) {
+    minY = std::min(minY, point.y);
+    maxY = std::max(maxY, point.y);
+  }
+
+  // The samples which are still inside of the polygon are moved from mSamples to samples, the new
+  // cells are collected and their heights queried afterwards.
+  std::unordered_map<uint64_t, glm::dvec3> samples;
+  samples.reserve(mSamples.size());
+
+  std::vector<uint64_t>   newKeys;
+  std::vector<glm::dvec2> newPoints;
+  std::vector<double>     crossings;
+
+  auto firstRow = static_cast<int32_t>(std::ceil(minY / mCellSize - 0.5));
+  auto lastRow  = static_cast<int32_t>(std::floor(maxY / mCellSize - 0.5));
+
+  for (int32_t row = firstRow; row <= lastRow; ++row) {
+    double y = (row + 0.5) * mCellSize;
+
+    crossings.clear();
+
+    for (size_t i = 0; i < points.size(); ++i) {
+      auto const& a = points[i];
+      auto const& b = points[(i + 1) % points.size()];
+
+      if ((a.y <= y) != (b.y <= y)) {
+        crossings.push_back(a.x + (y - a.y) * (b.x - a.x) / (b.y - a.y));
+      }
+    }
+
+    std::sort(crossings.begin(), crossings.end());
+
+    // With the even-odd rule, the cells between each pair of crossings are inside of the polygon.
+    for (size_t c = 0; c + 1 < crossings.size(); c += 2) {
+      auto firstColumn = static_cast<int32_t>(std::ceil(crossings[c] / mCellSize - 0.5));
+      auto lastColumn  = static_cast<int32_t>(std::floor(crossings[c + 1] / mCellSize - 0.5));
+
+      for (int32_t column = firstColumn; column <= lastColumn; ++column) {
+        uint64_t key    = getKey(column, row);
+        auto     sample = mSamples.find(key);
+
+        if (sample != mSamples.end()) {
+          samples.emplace(key, sample->second);
+          mSamples.erase(sample);
+        } else {
+          newKeys.push_back(key);
+          newPoints.emplace_back((column + 0.5) * mCellSize, y);
+        }
+      }
+    }
+  }
+
+  // The remaining samples have left the polygon.
+  for (auto const& sample : mSamples) {
+    mFit.remove(sample.second);
+  }
+
+  std::vector<glm::dvec3> positions;
+  std::vector<glm::dvec2> lngLats;
+  std::vector<double>     heights;
+
+  projection::planeToSurface(mPlane, radius, newPoints, positions);
+  projection::toLngLat(positions, lngLats);
+  projection::queryHeights(source, lngLats, heights);
+  projection::toCartesian(radius, lngLats, heights, 1.0, positions);
+
+  for (size_t i = 0; i < positions.size(); ++i) {
+    mFit.add(positions[i]);
+    samples.emplace(newKeys[i], positions[i]);
+  }
+
+  mSamples = std::move(samples);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+PlaneFit const& DensePlaneFit::getFit() const {
+  return mFit;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void DensePlaneFit::reset(double radius, glm::dvec3 const& direction) {
+  // The y-axis points to the north pole. Close to the poles, any other axis is used.
+  glm::dvec3 up(0.0, 1.0, 0.0);
+  if (std::abs(direction.y) > 0.99) {
+    up = glm::dvec3(1.0, 0.0, 0.0);
+  }
+
+  mPlane.mOrigin = direction * radius;
+  mPlane.mEast   = glm::normalize(glm::cross(up, direction));
+  mPlane.mNorth  = glm::cross(direction, mPlane.mEast);
+  mPlane.mScale  = 1.0;
+  mRadius        = radius;
+  mCellSize      = 0.0;
+
+  mSamples.clear();
+
+  // The sums of the fit are taken relative to the point where the grid touches the body.
+  mFit.reset(mPlane.mOrigin);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool DensePlaneFit::toPlane(
+    std::vector<glm::dvec3> const& positions, std::vector<glm::dvec2>& points) const {
+  glm::dvec3 normal = mPlane.mOrigin / mRadius;
+
+  points.resize(positions.size());
+
+  for (size_t i = 0; i < positions.size(); ++i) {
+    double distance = glm::dot(normal, positions[i]);
+
+    if (distance <= 0.0) {
+      return false;
+    }
+
+    // Along the ray through the center onto the plane.
+    glm::dvec3 position = positions[i] * (mRadius / distance) - mPlane.mOrigin;
+    points[i] = glm::dvec2(glm::dot(position, mPlane.mEast), glm::dot(position, mPlane.mNorth));
+  }
+
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+uint64_t DensePlaneFit::getKey(int32_t x, int32_t y) {
+  return (static_cast<uint64_t>(static_cast<uint32_t>(x)) << 32U) | static_cast<uint32_t>(y);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+} // namespace csp::measurementtools
@@ -0,0 +1,71 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//                               This file is part of CosmoScout VR                               //
+//      and may be used under the terms of the MIT license. See the LICENSE file for details.     //
+//                        Copyright: (c) 2019 German Aerospace Center (DLR)                       //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef CSP_MEASUREMENT_TOOLS_DENSE_PLANE_FIT_HPP
+#define CSP_MEASUREMENT_TOOLS_DENSE_PLANE_FIT_HPP
+
+#include "HeightCache.hpp"
+#include "PlaneFit.hpp"
+#include "SurfaceProjection.hpp"
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace csp::measurementtools {
+
+/// Fits a plane to the terrain inside of a polygon on the surface of a body, instead of only to
+/// the polygon's corners. The interior is sampled on a regular grid in a plane which touches the
+/// body at the polygon. The cell size is a power of two, so that it stays the same while the
+/// polygon is edited. A cell keeps its sample as long as it stays inside of the polygon; if one
+/// corner moves, only the cells which entered or left the polygon are added to or removed from
+/// the PlaneFit, and the heights of the new cells are queried with one batch.
+class DensePlaneFit {
+ public:
+  /// At most maxSamples are taken inside of the polygon, but at least a quarter of it.
+  explicit DensePlaneFit(size_t maxSamples = 4096);
+
+  /// Removes all samples.
+  void setMaxSamples(size_t maxSamples);
+
+  /// Removes all samples. This has to be called when the body changes.
+  void clear();
+
+  /// Samples the terrain inside of the polygon with the given corners in lng/lat (radians). The
+  /// source is only queried for the cells which have been outside of the polygon in the last call.
+  void update(double radius, HeightCache::HeightSource const& source,
+      std::vector<glm::dvec2> const& outline);
+
+  /// The moments of all samples inside of the polygon.
+  PlaneFit const& getFit() const;
+
+ private:
+  /// Places the grid at the given direction and removes all samples. The cell size has to be set
+  /// afterwards.
+  void reset(double radius, glm::dvec3 const& direction);
+
+  /// Projects the points onto the plane of the grid. Returns false if a point is on the other
+  /// side of the body.
+  bool toPlane(std::vector<glm::dvec3> const& positions, std::vector<glm::dvec2>& points) const;
+
+  static uint64_t getKey(int32_t x, int32_t y);
+
+  size_t mMaxSamples;
+
+  projection::TangentPlane mPlane{};
+  double                   mRadius   = 0.0;
+  double                   mCellSize = 0.0;
+
+  // The cartesian positions of all samples, by their cell.
+  std::unordered_map<uint64_t, glm::dvec3> mSamples;
+  PlaneFit                                 mFit;
+};
+
+} // namespace csp::measurementtools
+
+#endif // CSP_MEASUREMENT_TOOLS_DENSE_PLANE_FIT_HPP
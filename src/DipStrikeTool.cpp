@@ -6,7 +6,6 @@
 
 #include "DipStrikeTool.hpp"
 
-#include "../../../src/cs-core/GuiManager.hpp"
 #include "../../../src/cs-core/InputManager.hpp"
 #include "../../../src/cs-core/Settings.hpp"
 #include "../../../src/cs-core/SolarSystem.hpp"
@@ -24,6 +23,9 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
+#include <algorithm>
+#include <utility>
+
 namespace csp::measurementtools {
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -98,9 +100,7 @@ DipStrikeTool::DipStrikeTool(std::shared_ptr<cs::core::InputManager> const& pInp
     std::shared_ptr<cs::core::Settings> const&                              settings,
     std::shared_ptr<cs::core::TimeControl> const& pTimeControl, std::string const& sCenter,
     std::string const& sFrame)
-    : MultiPointTool(pInputManager, pSolarSystem, settings, pTimeControl, sCenter, sFrame)
-    , mGuiArea(std::make_unique<cs::gui::WorldSpaceGuiArea>(420, 225))
-    , mGuiItem(std::make_unique<cs::gui::GuiItem>("file://../share/resources/gui/dipstrike.html")) {
+    : MultiPointTool(pInputManager, pSolarSystem, settings, pTimeControl, sCenter, sFrame) {
 
   // create the shader
   mShader.InitVertexShaderFromString(SHADER_VERT);
@@ -129,47 +129,34 @@ DipStrikeTool::DipStrikeTool(std::shared_ptr<cs::core::InputManager> const& pInp
   mGuiAnchor->setAnchorScale(mSolarSystem->getObserver().getAnchorScale());
   mSolarSystem->registerAnchor(mGuiAnchor);
 
-  // create the user interface
-  mGuiTransform.reset(pSG->NewTransformNode(mGuiAnchor.get()));
-  mGuiTransform->Translate(0.F, 0.9F, 0.F);
-  mGuiTransform->Scale(0.001F * static_cast<float>(mGuiArea->getWidth()),
-      0.001F * static_cast<float>(mGuiArea->getHeight()), 1.F);
-  mGuiTransform->Rotate(VistaAxisAndAngle(VistaVector3D(0.F, 1.F, 0.F), -glm::pi<float>() / 2.F));
-  mGuiArea->addItem(mGuiItem.get());
-  mGuiArea->setUseLinearDepthBuffer(true);
-  mGuiOpenGLNode.reset(pSG->NewOpenGLNode(mGuiTransform.get(), mGuiArea.get()));
-
-  mInputManager->registerSelectable(mGuiOpenGLNode.get());
-
-  mGuiItem->setCanScroll(false);
-  mGuiItem->waitForFinishedLoading();
+  // create the user interface, its web view is only created when the tool is close to the
+  // observer
+  mGui = std::make_unique<ToolGui>(mInputManager, mGuiAnchor,
+      "file://../share/resources/gui/dipstrike.html", 420, 225, glm::vec3(0.F, 0.9F, 0.F));
 
-  mGuiItem->registerCallback("deleteMe", "Call this to delete the tool.",
+  mGui->registerCallback("deleteMe", "Call this to delete the tool.",
       std::function([this]() { pShouldDelete = true; }));
 
-  mGuiItem->registerCallback("setAddPointMode", "Call this to enable creation of new points.",
+  mGui->registerCallback("setAddPointMode", "Call this to enable creation of new points.",
       std::function([this](bool enable) {
         addPoint();
         pAddPointMode = enable;
       }));
 
-  mGuiItem->registerCallback("setSize", "Sets the size of the dip and strike plane.",
+  mGui->registerCallback("setSize", "Sets the size of the dip and strike plane.",
       std::function([this](double val) { pSize = static_cast<float>(val); }));
   pSize.connectAndTouch([this](float value) {
-    mGuiItem->callJavascript("CosmoScout.gui.setSliderValue", "setSize", false, value);
+    mGui->callJavascriptWithKey(
+        "setSize", "CosmoScout.gui.setSliderValue", "setSize", false, value);
   });
 
-  mGuiItem->registerCallback("setOpacity", "Sets the opacity of the dip and strike plane.",
+  mGui->registerCallback("setOpacity", "Sets the opacity of the dip and strike plane.",
       std::function([this](double val) { pOpacity = static_cast<float>(val); }));
   pOpacity.connectAndTouch([this](float value) {
-    mGuiItem->callJavascript("CosmoScout.gui.setSliderValue", "setOpacity", false, value);
+    mGui->callJavascriptWithKey(
+        "setOpacity", "CosmoScout.gui.setSliderValue", "setOpacity", false, value);
   });
 
-  mGuiItem->setCursorChangeCallback([](cs::gui::Cursor c) { cs::core::GuiManager::setCursor(c); });
-
-  VistaOpenSGMaterialTools::SetSortKeyOnSubtree(
-      mGuiOpenGLNode.get(), static_cast<int>(cs::utils::DrawOrder::eTransparentItems));
-
   // update on height scale change
   mScaleConnection = mSettings->mGraphics.pHeightScale.connectAndTouch(
       [this](float /*h*/) { mVerticesDirty = true; });
@@ -192,9 +179,9 @@ DipStrikeTool::DipStrikeTool(std::shared_ptr<cs::core::InputManager> const& pInp
 
   // Update text.
   mTextConnection = pText.connectAndTouch(
-      [this](std::string const& value) { mGuiItem->callJavascript("setText", value); });
+      [this](std::string const& value) { mGui->callJavascript("setText", value); });
 
-  mGuiItem->registerCallback("onSetText",
+  mGui->registerCallback("onSetText",
       "This is called whenever the text input of the tool's name changes.",
       std::function(
           [this](std::string&& value) { pText.setWithEmitForAllButOne(value, mTextConnection); }));
@@ -204,13 +191,6 @@ DipStrikeTool::DipStrikeTool(std::shared_ptr<cs::core::InputManager> const& pInp
 
 DipStrikeTool::~DipStrikeTool() {
   mSettings->mGraphics.pHeightScale.disconnect(mScaleConnection);
-  mGuiItem->unregisterCallback("deleteMe");
-  mGuiItem->unregisterCallback("setAddPointMode");
-  mGuiItem->unregisterCallback("setSize");
-  mGuiItem->unregisterCallback("setOpacity");
-  mGuiItem->unregisterCallback("onSetText");
-
-  mInputManager->unregisterSelectable(mGuiOpenGLNode.get());
 
   mSolarSystem->unregisterAnchor(mGuiAnchor);
   mSolarSystem->unregisterAnchor(mPlaneAnchor);
@@ -222,6 +202,12 @@ void DipStrikeTool::setCenterName(std::string const& name) {
   cs::core::tools::MultiPointTool::setCenterName(name);
   mGuiAnchor->setCenterName(name);
   mPlaneAnchor->setCenterName(name);
+
+  // The samples belong to the terrain of the previous body.
+  mMarkSamples.clear();
+  mMarkFit.reset(glm::dvec3(0.0));
+  mDenseFit.clear();
+  mVerticesDirty = true;
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -260,29 +246,17 @@ void DipStrikeTool::calculateDipAndStrike() {
   auto radii = mSolarSystem->getRadii(mGuiAnchor->getCenterName());
   auto body  = mSolarSystem->getBody(getCenterName());
 
-  glm::dvec3 averagePosition{0};
-  for (auto const& mark : mPoints) {
-    averagePosition += mark->getAnchor()->getAnchorPosition() / static_cast<double>(mPoints.size());
-  }
+  HeightCache::HeightSource heightSource = [body](glm::dvec2 const& lngLat) {
+    return body ? body->getHeight(lngLat) : 0.0;
+  };
 
-  // corrected average position (works for every height scale)
-  // average position of the coordinates without height exaggeration
-  glm::dvec3 averagePositionNorm(0.0);
-  for (auto const& mark : mPoints) {
-    // Cartesian coordinate without height
-    glm::dvec3 pos = glm::normalize(mark->getAnchor()->getAnchorPosition()) * radii[0];
-    // LongLat coordinate
-    glm::dvec3 l = cs::utils::convert::toLngLatHeight(pos, radii[0], radii[0]);
-    // Height of the point
-    double h = body ? body->getHeight(l.xy()) : 0.0;
-    // Cartesian coordinate with height
-    glm::dvec3 posNorm = cs::utils::convert::toCartesian(l, radii[0], radii[0], h);
-
-    averagePositionNorm += posNorm / static_cast<double>(mPoints.size());
-  }
+  updateMarkSamples(radii[0], heightSource);
+
+  // average position of the coordinates without height exaggeration (works for every height
+  // scale)
+  glm::dvec3 averagePositionNorm = mMarkFit.getCenter();
 
   mGuiAnchor->setAnchorPosition(averagePositionNorm);
-  mPlaneAnchor->setAnchorPosition(averagePositionNorm);
 
   // This seems to be the first time the tool is moved, so we have to store the distance to the
   // observer so that we can scale the tool later based on the observer's position.
@@ -292,51 +266,41 @@ void DipStrikeTool::calculateDipAndStrike() {
                          mTimeControl->pSimulationTime.get(), *mGuiAnchor));
   }
 
-  // calculate center of plane and normal
-  // based on http://stackoverflow.com/questions/1400213/3d-least-squares-plane
-  glm::dmat3 mat(0);
-  glm::dvec3 vec(0);
-
-  auto      center      = mPlaneAnchor->getAnchorPosition();
-  glm::vec3 idealNormal = glm::normalize(center);
+  glm::vec3 idealNormal = glm::normalize(averagePositionNorm);
   mNormal               = idealNormal;
   mSize                 = 0;
-  mOffset               = 0.F;
-
-  for (auto const& p : mPoints) {
-    glm::dvec3 pos     = glm::normalize(p->getAnchor()->getAnchorPosition()) * radii[0];
-    glm::dvec3 l       = cs::utils::convert::toLngLatHeight(pos, radii[0], radii[0]);
-    double     h       = body ? body->getHeight(l.xy()) : 0.0;
-    glm::dvec3 posNorm = cs::utils::convert::toCartesian(l, radii[0], radii[0], h);
-
-    glm::dvec3 realtivePosition = posNorm - averagePositionNorm;
-
-    mSize = std::max(mSize, glm::length(realtivePosition));
-
-    mat[0][0] += realtivePosition.x * realtivePosition.x;
-    mat[1][0] += realtivePosition.x * realtivePosition.y;
-    mat[2][0] += realtivePosition.x;
-    mat[0][1] += realtivePosition.x * realtivePosition.y;
-    mat[1][1] += realtivePosition.y * realtivePosition.y;
-    mat[2][1] += realtivePosition.y;
-    mat[0][2] += realtivePosition.x;
-    mat[1][2] += realtivePosition.y;
-    mat[2][2] += 1;
-
-    vec[0] += realtivePosition.x * realtivePosition.z;
-    vec[1] += realtivePosition.y * realtivePosition.z;
-    vec[2] += realtivePosition.z;
+
+  for (auto const& sample : mMarkSamples) {
+    mSize = std::max(mSize, glm::length(sample.mPosition - averagePositionNorm));
   }
 
-  if (mPoints.size() > 2) {
-    glm::vec3 solution = glm::inverse(mat) * vec;
-    mNormal            = glm::normalize(glm::vec3(-solution.x, -solution.y, 1.F));
-    mOffset            = solution.z;
+  // In the dense mode, the terrain enclosed by the points is sampled. Small polygons which
+  // contain less samples than points fall back to the points.
+  PlaneFit const* fit = &mMarkFit;
 
-    if (glm::dot(idealNormal, mNormal) < 0) {
-      mNormal = -mNormal;
+  if (mDenseSamples > 0 && mMarkSamples.size() > 2) {
+    std::vector<glm::dvec2> outline;
+    outline.reserve(mMarkSamples.size());
+
+    for (auto const& sample : mMarkSamples) {
+      outline.push_back(sample.mLngLat);
     }
 
+    mDenseFit.update(radii[0], heightSource, outline);
+
+    if (mDenseFit.getFit().getCount() >= mMarkSamples.size()) {
+      fit = &mDenseFit.getFit();
+    }
+  } else {
+    mDenseFit.clear();
+  }
+
+  PlaneFit::Plane plane;
+
+  if (fit->solve(glm::dvec3(idealNormal), plane)) {
+    mPlaneAnchor->setAnchorPosition(plane.mCenter);
+    mNormal = plane.mNormal;
+
     // calculate dip and strike directions
     glm::vec3 strike       = glm::normalize(glm::cross(mNormal, idealNormal));
     glm::vec3 dipDirection = glm::normalize(glm::cross(idealNormal, strike));
@@ -351,23 +315,94 @@ void DipStrikeTool::calculateDipAndStrike() {
       fStrike = 360 - fStrike;
     }
 
-    mGuiItem->callJavascript("setData", fDip, fStrike);
+    mGui->callJavascript("setData", fDip, fStrike);
   } else {
+    mPlaneAnchor->setAnchorPosition(averagePositionNorm);
     mMip = glm::normalize(glm::cross(mNormal, glm::vec3(0, 1, 0)));
-    mGuiItem->callJavascript("setData", 0, 0);
+    mGui->callJavascript("setData", 0, 0);
   }
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
-void DipStrikeTool::update() {
-  MultiPointTool::update();
+void DipStrikeTool::updateMarkSamples(double radius, HeightCache::HeightSource const& source) {
+  std::vector<MarkSample> samples;
+  std::vector<size_t>     moved;
+  std::vector<glm::dvec2> lngLats;
+
+  samples.reserve(mPoints.size());
+
+  for (auto const& mark : mPoints) {
+    glm::dvec2 lngLat = mark->pLngLat.get();
+
+    auto cached = std::find_if(mMarkSamples.begin(), mMarkSamples.end(),
+        [&](MarkSample const& s) { return s.mMark == mark.get() && s.mLngLat == lngLat; });
+
+    if (cached != mMarkSamples.end()) {
+      samples.push_back(*cached);
+      cached->mMark = nullptr;
+    } else {
+      moved.push_back(samples.size());
+      lngLats.push_back(lngLat);
+      samples.push_back({mark.get(), lngLat, glm::dvec3(0.0)});
+    }
+  }
+
+  // The remaining samples belong to marks which moved or have been removed.
+  for (auto const& sample : mMarkSamples) {
+    if (sample.mMark) {
+      mMarkFit.remove(sample.mPosition);
+    }
+  }
+
+  std::vector<double> heights;
+  projection::queryHeights(source, lngLats, heights);
 
-  if (mVerticesDirty) {
-    calculateDipAndStrike();
-    mVerticesDirty = false;
+  for (size_t i = 0; i < moved.size(); ++i) {
+    auto& sample     = samples[moved[i]];
+    sample.mPosition = cs::utils::convert::toCartesian(sample.mLngLat, radius, radius, heights[i]);
+
+    if (mMarkFit.getCount() == 0) {
+      mMarkFit.reset(sample.mPosition);
+    }
+
+    mMarkFit.add(sample.mPosition);
+  }
+
+  mMarkSamples = std::move(samples);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool DipStrikeTool::hasPendingUpdate() const {
+  return mVerticesDirty;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+double DipStrikeTool::getUpdatePriority() const {
+  if (mPoints.empty()) {
+    return 0.0;
   }
 
+  bool edited = pAddPointMode.get() || UpdateScheduler::isEdited(mPoints);
+
+  return UpdateScheduler::getPriority(mSolarSystem->getObserver(),
+      mTimeControl->pSimulationTime.get(), *mPoints.front()->getAnchor(), edited);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void DipStrikeTool::processPendingUpdate() {
+  calculateDipAndStrike();
+  mVerticesDirty = false;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void DipStrikeTool::update() {
+  MultiPointTool::update();
+
   double simulationTime(mTimeControl->pSimulationTime.get());
 
   cs::core::SolarSystem::scaleRelativeToObserver(*mGuiAnchor, mSolarSystem->getObserver(),
@@ -378,6 +413,22 @@ void DipStrikeTool::update() {
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
+ToolGui& DipStrikeTool::getGui() {
+  return *mGui;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void DipStrikeTool::setDenseSamples(int32_t samples) {
+  if (mDenseSamples != samples) {
+    mDenseSamples = samples;
+    mDenseFit.setMaxSamples(static_cast<size_t>(std::max(samples, 0)));
+    mVerticesDirty = true;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
 bool DipStrikeTool::Do() {
   glPushAttrib(GL_ENABLE_BIT | GL_COLOR_BUFFER_BIT);
 
@@ -395,7 +446,7 @@ bool DipStrikeTool::Do() {
   glm::vec3 z = glm::normalize(glm::cross(x, y));
 
   auto matMV = glm::make_mat4x4(glMatMV.data()) *
-               glm::mat4(x.x, x.y, x.z, 0, y.x, y.y, y.z, 0, z.x, z.y, z.z, 0, 0, 0, mOffset, 1);
+               glm::mat4(x.x, x.y, x.z, 0, y.x, y.y, y.z, 0, z.x, z.y, z.z, 0, 0, 0, 0, 1);
 
   matMV = glm::scale(matMV, glm::vec3(static_cast<float>(mSize) * pSize.get()));
 
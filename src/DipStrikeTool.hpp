@@ -8,6 +8,10 @@
 #define CSP_MEASUREMENT_TOOLS_DIP_STRIKE_HPP
 
 #include "../../../src/cs-core/tools/MultiPointTool.hpp"
+#include "DensePlaneFit.hpp"
+#include "PlaneFit.hpp"
+#include "ToolGui.hpp"
+#include "UpdateScheduler.hpp"
 
 #include <VistaKernel/GraphicsManager/VistaOpenGLDraw.h>
 
@@ -18,25 +22,22 @@ namespace cs::scene {
 class CelestialAnchorNode;
 }
 
-namespace cs::gui {
-class GuiItem;
-class WorldSpaceGuiArea;
-} // namespace cs::gui
-
 class VistaBufferObject;
 class VistaGLSLShader;
 class VistaOpenGLNode;
 class VistaVertexArrayObject;
-class VistaTransformNode;
 
 namespace csp::measurementtools {
 
 /// The dip and strike tool is used to measure the steepness and orientation of slopes. It uses a
 /// set of points on the surface to generate a plane that has the lowest sum of squared distances to
-/// all points.
+/// all points. In the dense mode, the plane is fitted to samples of the terrain inside of the
+/// polygon formed by the points instead.
 /// The dip (steepness) is given in degrees from 0° to 90° and the strike (orientation) is also
 /// given in degrees, where at 0° the peak is in the east and at 90° the peak is in the north.
-class DipStrikeTool : public IVistaOpenGLDraw, public cs::core::tools::MultiPointTool {
+class DipStrikeTool : public IVistaOpenGLDraw,
+                      public cs::core::tools::MultiPointTool,
+                      public UpdateScheduler::Client {
  public:
   /// This text is shown on the ui and can be edited by the user.
   cs::utils::Property<std::string> pText    = std::string("Dip & Strike");
@@ -66,6 +67,20 @@ class DipStrikeTool : public IVistaOpenGLDraw, public cs::core::tools::MultiPoin
   /// Called from Tools class.
   void update() override;
 
+  /// These are called by the UpdateScheduler. The terrain is only sampled in
+  /// processPendingUpdate().
+  bool   hasPendingUpdate() const override;
+  double getUpdatePriority() const override;
+  void   processPendingUpdate() override;
+
+  /// The web view of the tool is only created when the tool is close to the observer.
+  ToolGui& getGui();
+
+  /// If larger than zero, the plane is fitted to up to this many samples of the terrain inside of
+  /// the points. Otherwise, or if the points enclose less samples than there are points, only the
+  /// points are used.
+  void setDenseSamples(int32_t samples);
+
   /// Inherited from IVistaOpenGLDraw.
   bool Do() override;
   bool GetBoundingBox(VistaBoundingBox& bb) override;
@@ -73,6 +88,10 @@ class DipStrikeTool : public IVistaOpenGLDraw, public cs::core::tools::MultiPoin
  private:
   void calculateDipAndStrike();
 
+  /// Samples the terrain at the points which have been moved or added since the last call and
+  /// updates mMarkFit by removing the old and adding the new samples.
+  void updateMarkSamples(double radius, HeightCache::HeightSource const& source);
+
   /// Returns the interpolated position in cartesian coordinates the fourth component is height
   /// above the surface.
   glm::dvec4 getInterpolatedPosBetweenTwoMarks(cs::core::tools::DeletableMark const& pMark1,
@@ -86,11 +105,8 @@ class DipStrikeTool : public IVistaOpenGLDraw, public cs::core::tools::MultiPoin
   std::shared_ptr<cs::scene::CelestialAnchorNode> mGuiAnchor;
   std::shared_ptr<cs::scene::CelestialAnchorNode> mPlaneAnchor;
 
-  std::unique_ptr<cs::gui::WorldSpaceGuiArea> mGuiArea;
-  std::unique_ptr<cs::gui::GuiItem>           mGuiItem;
-  std::unique_ptr<VistaTransformNode>         mGuiTransform;
-  std::unique_ptr<VistaOpenGLNode>            mGuiOpenGLNode;
-  std::unique_ptr<VistaOpenGLNode>            mPlaneOpenGLNode;
+  std::unique_ptr<ToolGui>         mGui;
+  std::unique_ptr<VistaOpenGLNode> mPlaneOpenGLNode;
 
   VistaVertexArrayObject mVAO;
   VistaBufferObject      mVBO;
@@ -99,7 +115,19 @@ class DipStrikeTool : public IVistaOpenGLDraw, public cs::core::tools::MultiPoin
   bool      mVerticesDirty = false;
   double    mSize{};
   glm::vec3 mNormal = glm::vec3(0.0), mMip = glm::vec3(0.0);
-  float     mOffset{};
+
+  // The positions of the points on the terrain, without the height scale. The mark's address is
+  // only used to recognize marks which kept their position.
+  struct MarkSample {
+    cs::core::tools::DeletableMark const* mMark;
+    glm::dvec2                            mLngLat;
+    glm::dvec3                            mPosition;
+  };
+
+  std::vector<MarkSample> mMarkSamples;
+  PlaneFit                mMarkFit;
+  DensePlaneFit           mDenseFit;
+  int32_t                 mDenseSamples = 0;
 
   int mTextConnection  = -1;
   int mScaleConnection = -1;
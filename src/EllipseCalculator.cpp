@@ -0,0 +1,233 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//                               This file is part of CosmoScout VR                               //
+//      and may be used under the terms of the MIT license. See the LICENSE file for details.     //
+//                        Copyright: (c) 2019 German Aerospace Center (DLR)                       //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "EllipseCalculator.hpp"
+
+#include "PlaneFit.hpp"
+#include "SurfaceProjection.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+namespace csp::measurementtools {
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+const size_t   EllipseCalculator::CHUNK_SIZE = 256;
+const uint32_t EllipseCalculator::MAX_LEVEL  = 12;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+EllipseCalculator::EllipseCalculator(Input input)
+    : mInput(std::move(input)) {
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+EllipseCalculator::Totals const& EllipseCalculator::getResult() const {
+  return mResult;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool EllipseCalculator::getProgress(Totals& progress) {
+  std::lock_guard<std::mutex> lock(mProgressMutex);
+
+  if (!mProgressUpdated) {
+    return false;
+  }
+
+  progress         = mProgress;
+  mProgressUpdated = false;
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void EllipseCalculator::getLevelPoints(uint32_t level, std::vector<glm::dvec2>& points) {
+  auto   n       = static_cast<int64_t>(1) << level;
+  double spacing = 1.0 / static_cast<double>(n);
+
+  points.clear();
+
+  for (int64_t i = -n; i <= n; ++i) {
+    for (int64_t j = -n; j <= n; ++j) {
+      // The points with even indices have been sampled by the previous levels already.
+      bool isNew = level == 0 || (i % 2 != 0) || (j % 2 != 0);
+
+      if (isNew && i * i + j * j <= n * n) {
+        points.emplace_back(static_cast<double>(i) * spacing, static_cast<double>(j) * spacing);
+      }
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+uint32_t EllipseCalculator::getSampleCount(uint32_t level) {
+  auto     n     = static_cast<int64_t>(1) << level;
+  uint32_t count = 0;
+
+  for (int64_t i = -n; i <= n; ++i) {
+    auto rows = static_cast<int64_t>(std::sqrt(static_cast<double>(n * n - i * i)));
+    count += static_cast<uint32_t>(2 * rows + 1);
+  }
+
+  return count;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void EllipseCalculator::samplePoints(std::vector<glm::dvec2> const& points, size_t begin,
+    size_t end, double spacing, std::vector<Sample>& samples) {
+
+  // Each sample is taken together with its neighbors in the direction of both axes, which
+  // span the triangle the slope is measured with.
+  std::vector<glm::dvec3> positions;
+  positions.reserve(3 * (end - begin));
+
+  auto const& axes = mInput.mAxes;
+
+  for (size_t i = begin; i < end; ++i) {
+    glm::dvec2 const& p = points[i];
+    positions.push_back(mInput.mCenter + p.x * axes[0] + p.y * axes[1]);
+    positions.push_back(mInput.mCenter + (p.x + spacing) * axes[0] + p.y * axes[1]);
+    positions.push_back(mInput.mCenter + p.x * axes[0] + (p.y + spacing) * axes[1]);
+  }
+
+  std::vector<glm::dvec2> lngLats;
+  std::vector<double>     heights;
+
+  projection::toLngLat(positions, lngLats);
+  mHeightCache.getHeights(lngLats, heights);
+  projection::toCartesian(mInput.mRadius, lngLats, heights, 1.0, positions);
+
+  // An orthonormal base of the plane spanned by the axes, for the least squares plane.
+  glm::dvec3 first  = glm::normalize(axes[0]);
+  glm::dvec3 second = glm::normalize(axes[1] - glm::dot(axes[1], first) * first);
+
+  samples.resize(end - begin);
+
+  for (size_t i = 0; i < samples.size(); ++i) {
+    glm::dvec3 const& p0 = positions[3 * i];
+    glm::dvec3 const& p1 = positions[3 * i + 1];
+    glm::dvec3 const& p2 = positions[3 * i + 2];
+
+    glm::dvec3 normal = glm::cross(p1 - p0, p2 - p0);
+    double     slope  = 0.0;
+
+    if (glm::length(normal) > 0.0) {
+      double cosine = std::abs(glm::dot(glm::normalize(normal), glm::normalize(p0)));
+      slope         = glm::degrees(std::acos(std::min(cosine, 1.0)));
+    }
+
+    glm::dvec2 const& p = points[begin + i];
+    glm::dvec3        q = p.x * axes[0] + p.y * axes[1];
+
+    samples[i].mHeight = heights[3 * i];
+    samples[i].mSlope  = slope;
+    samples[i].mLocal  = glm::dvec3(glm::dot(q, first), glm::dot(q, second), heights[3 * i]);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool EllipseCalculator::compute(std::atomic_bool const& cancel) {
+  mResult = Totals();
+
+  // The axes must span a plane.
+  if (mInput.mRadius <= 0.0 || glm::length(glm::cross(mInput.mAxes[0], mInput.mAxes[1])) <= 0.0) {
+    return true;
+  }
+
+  mHeightCache.reset(mInput.mHeightSource, mInput.mBatchHeightSource);
+
+  // The finest level which does not exceed the maximum number of samples. Its spacing is used
+  // for measuring the slope on all levels, so that the slopes of all samples are comparable.
+  uint32_t maxLevel = 0;
+  while (maxLevel < MAX_LEVEL && getSampleCount(maxLevel + 1) <= mInput.mMaxSamples) {
+    ++maxLevel;
+  }
+
+  double spacing = std::exp2(-static_cast<double>(maxLevel));
+
+  PlaneFit                         fit;
+  double                           heightSum = 0.0;
+  double                           slopeSum  = 0.0;
+  std::vector<glm::dvec2>          points;
+  std::vector<std::vector<Sample>> chunks;
+
+  for (uint32_t level = 0; level <= maxLevel; ++level) {
+    getLevelPoints(level, points);
+
+    chunks.clear();
+    chunks.resize((points.size() + CHUNK_SIZE - 1) / CHUNK_SIZE);
+
+    auto sampleChunk = [&](size_t chunk) {
+      if (cancel.load()) {
+        return;
+      }
+
+      size_t begin = chunk * CHUNK_SIZE;
+      size_t end   = std::min(begin + CHUNK_SIZE, points.size());
+      samplePoints(points, begin, end, spacing, chunks[chunk]);
+    };
+
+    if (mInput.mThreadPool) {
+      mInput.mThreadPool->parallelFor(chunks.size(), sampleChunk);
+    } else {
+      for (size_t chunk(0); chunk < chunks.size(); ++chunk) {
+        sampleChunk(chunk);
+      }
+    }
+
+    if (cancel.load()) {
+      return false;
+    }
+
+    // The chunks are accumulated in a fixed order, so that the totals do not depend on the
+    // scheduling of the threads.
+    for (auto const& samples : chunks) {
+      for (auto const& sample : samples) {
+        if (mResult.mSamples == 0) {
+          mResult.mMinHeight = sample.mHeight;
+          mResult.mMaxHeight = sample.mHeight;
+          fit.reset(sample.mLocal);
+        }
+
+        ++mResult.mSamples;
+        heightSum += sample.mHeight;
+        slopeSum += sample.mSlope;
+
+        mResult.mMinHeight = std::min(mResult.mMinHeight, sample.mHeight);
+        mResult.mMaxHeight = std::max(mResult.mMaxHeight, sample.mHeight);
+        mResult.mMaxSlope  = std::max(mResult.mMaxSlope, sample.mSlope);
+
+        fit.add(sample.mLocal);
+      }
+    }
+
+    mResult.mLevel      = level;
+    mResult.mMeanHeight = heightSum / std::max(mResult.mSamples, 1U);
+    mResult.mMeanSlope  = slopeSum / std::max(mResult.mSamples, 1U);
+
+    PlaneFit::Plane plane;
+    if (fit.solve(glm::dvec3(0.0, 0.0, 1.0), plane)) {
+      mResult.mRoughness = std::sqrt(plane.mVariance);
+    }
+
+    std::lock_guard<std::mutex> lock(mProgressMutex);
+    mProgress        = mResult;
+    mProgressUpdated = true;
+  }
+
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+} // namespace csp::measurementtools
@@ -0,0 +1,126 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//                               This file is part of CosmoScout VR                               //
+//      and may be used under the terms of the MIT license. See the LICENSE file for details.     //
+//                        Copyright: (c) 2019 German Aerospace Center (DLR)                       //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef CSP_MEASUREMENT_TOOLS_ELLIPSE_CALCULATOR_HPP
+#define CSP_MEASUREMENT_TOOLS_ELLIPSE_CALCULATOR_HPP
+
+#include "HeightCache.hpp"
+#include "ThreadPool.hpp"
+
+#include <glm/glm.hpp>
+
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+namespace csp::measurementtools {
+
+/// Calculates statistics of the terrain inside of an ellipse on the surface of a body, such as
+/// the range of the elevation, the slope and the roughness. The EllipseTool runs it with an
+/// AsyncCalculation.
+///
+/// The interior is sampled on a grid in the coordinate system spanned by the two axes, which is
+/// refined progressively: Each level halves the spacing of the previous one and only samples the
+/// new grid points. The totals are published after each level, so that a rough estimate is
+/// available quickly while the axes are dragged.
+class EllipseCalculator {
+ public:
+  struct Input {
+    /// Cartesian position of the center and the two axes, relative to the body's center. These
+    /// are the same as the ones used for drawing the ellipse.
+    glm::dvec3                mCenter = glm::dvec3(0.0);
+    std::array<glm::dvec3, 2> mAxes   = {glm::dvec3(0.0), glm::dvec3(0.0)};
+
+    double mRadius = 0.0;
+
+    /// The terrain heights are queried from the sources of a HeightProvider, the samples of one
+    /// level are requested with a single call of the batch source if it is set.
+    HeightCache::HeightSource      mHeightSource;
+    HeightCache::BatchHeightSource mBatchHeightSource;
+
+    /// The samples of each level are processed in parallel on this pool. If it is not set, they
+    /// are processed one after another on the calling thread.
+    ThreadPool* mThreadPool = nullptr;
+
+    /// The refinement stops before the number of samples would exceed this value.
+    uint32_t mMaxSamples = 4096;
+  };
+
+  /// The running totals over all samples taken so far. Heights are given in meters without the
+  /// height scale, slopes in degrees.
+  struct Totals {
+    uint32_t mLevel   = 0;
+    uint32_t mSamples = 0;
+
+    double mMinHeight  = 0.0;
+    double mMaxHeight  = 0.0;
+    double mMeanHeight = 0.0;
+
+    /// The slope at each sample is measured over the spacing of the finest level.
+    double mMeanSlope = 0.0;
+    double mMaxSlope  = 0.0;
+
+    /// The root mean square distance of the samples to their least squares plane.
+    double mRoughness = 0.0;
+  };
+
+  explicit EllipseCalculator(Input input);
+
+  /// Runs the whole calculation. The cancel flag is checked regularly; if it is set, the
+  /// calculation is aborted and false is returned. In this case, the result is incomplete.
+  bool compute(std::atomic_bool const& cancel);
+
+  Totals const& getResult() const;
+
+  /// Returns true and stores the latest totals in progress, if another level has been finished
+  /// since the last call. This can be called from any thread while compute() is running.
+  bool getProgress(Totals& progress);
+
+ private:
+  /// A sample at (u, v) in units of the axes.
+  struct Sample {
+    double mHeight;
+    double mSlope;
+
+    /// The position in the plane spanned by the axes and the height, in meters.
+    glm::dvec3 mLocal;
+  };
+
+  /// Collects the new grid points of the given level which are inside of the ellipse, in units
+  /// of the axes.
+  static void getLevelPoints(uint32_t level, std::vector<glm::dvec2>& points);
+
+  /// The number of grid points inside of the ellipse up to the given level.
+  static uint32_t getSampleCount(uint32_t level);
+
+  /// Samples the terrain at the given points and their neighbors at the given spacing with one
+  /// batch.
+  void samplePoints(std::vector<glm::dvec2> const& points, size_t begin, size_t end,
+      double spacing, std::vector<Sample>& samples);
+
+  Input  mInput;
+  Totals mResult;
+
+  // Terrain heights of this calculation. The neighbors of the samples are grid points of the
+  // finest level, so they are shared with other samples.
+  HeightCache mHeightCache;
+
+  // The totals of the last level, they are read by the main thread
+  std::mutex mProgressMutex;
+  Totals     mProgress;
+  bool       mProgressUpdated = false;
+
+  // The number of samples which are queried with one batch.
+  static const size_t CHUNK_SIZE;
+
+  // Limits the number of grid points, the level 12 has about 50 million.
+  static const uint32_t MAX_LEVEL;
+};
+
+} // namespace csp::measurementtools
+
+#endif // CSP_MEASUREMENT_TOOLS_ELLIPSE_CALCULATOR_HPP
@@ -12,92 +12,39 @@
 #include "../../../src/cs-scene/CelestialAnchorNode.hpp"
 #include "../../../src/cs-utils/convert.hpp"
 #include "../../../src/cs-utils/utils.hpp"
-
-#include <VistaKernel/GraphicsManager/VistaOpenGLNode.h>
-#include <VistaKernel/GraphicsManager/VistaSceneGraph.h>
-#include <VistaKernel/VistaSystem.h>
-#include <VistaKernelOpenSGExt/VistaOpenSGMaterialTools.h>
+#include "HeightProvider.hpp"
+#include "logger.hpp"
 
 namespace csp::measurementtools {
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
-const char* EllipseTool::SHADER_VERT = R"(
-#version 330
-
-layout(location=0) in vec3 iPosition;
-
-out vec4 vPosition;
-
-uniform mat4 uMatModelView;
-uniform mat4 uMatProjection;
-
-void main()
-{
-    vPosition   = uMatModelView * vec4(iPosition, 1.0);
-    gl_Position = uMatProjection * vPosition;
-}
-)";
-
-////////////////////////////////////////////////////////////////////////////////////////////////////
-
-const char* EllipseTool::SHADER_FRAG = R"(
-#version 330
-
-in vec4 vPosition;
-
-uniform float uFarClip;
-uniform vec3 uColor;
-
-layout(location = 0) out vec4 oColor;
-
-void main()
-{
-    oColor = vec4(uColor, 1.0);
-   
-    // linearize depth value
-    gl_FragDepth = length(vPosition.xyz) / uFarClip;
-}
-)";
-
-////////////////////////////////////////////////////////////////////////////////////////////////////
-
 EllipseTool::EllipseTool(std::shared_ptr<cs::core::InputManager> const& pInputManager,
     std::shared_ptr<cs::core::SolarSystem> const&                       pSolarSystem,
     std::shared_ptr<cs::core::Settings> const&                          settings,
-    std::shared_ptr<cs::core::TimeControl> const& pTimeControl, std::string const& sCenter,
+    std::shared_ptr<cs::core::TimeControl> const&                       pTimeControl,
+    std::shared_ptr<LineRenderer> const& pLineRenderer,
+    std::shared_ptr<ThreadPool> const& pThreadPool,
+    std::shared_ptr<HeightProvider> const& pHeightProvider, std::string const& sCenter,
     std::string const& sFrame)
     : mSolarSystem(pSolarSystem)
     , mSettings(settings)
+    , mTimeControl(pTimeControl)
     , mCenterHandle(pInputManager, pSolarSystem, settings, pTimeControl, sCenter, sFrame)
     , mAxes({glm::dvec3(pSolarSystem->getObserver().getAnchorScale(), 0.0, 0.0),
           glm::dvec3(0.0, pSolarSystem->getObserver().getAnchorScale(), 0.0)})
     , mHandles({std::make_unique<cs::core::tools::Mark>(
                     pInputManager, pSolarSystem, settings, pTimeControl, sCenter, sFrame),
           std::make_unique<cs::core::tools::Mark>(
-              pInputManager, pSolarSystem, settings, pTimeControl, sCenter, sFrame)}) {
-
-  mShader.InitVertexShaderFromString(SHADER_VERT);
-  mShader.InitFragmentShaderFromString(SHADER_FRAG);
-  mShader.Link();
-
-  mVBO.Bind(GL_ARRAY_BUFFER);
-  mVBO.BufferData(mNumSamples * sizeof(glm::vec3), nullptr, GL_DYNAMIC_DRAW);
-  mVBO.Release();
-
-  mVAO.EnableAttributeArray(0);
-  mVAO.SpecifyAttributeArrayFloat(0, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), 0, &mVBO);
+              pInputManager, pSolarSystem, settings, pTimeControl, sCenter, sFrame)})
+    , mLines(pLineRenderer->createGeometry(GL_LINE_STRIP, 5.F))
+    , mThreadPool(pThreadPool)
+    , mHeightProvider(pHeightProvider) {
 
-  auto* pSG = GetVistaSystem()->GetGraphicsManager()->GetSceneGraph();
-
-  mAnchor = std::make_shared<cs::scene::CelestialAnchorNode>(
-      pSG->GetRoot(), pSG->GetNodeBridge(), "", sCenter, sFrame);
-  mSolarSystem->registerAnchor(mAnchor);
-
-  mOpenGLNode.reset(pSG->NewOpenGLNode(mAnchor.get(), this));
-
-  VistaOpenSGMaterialTools::SetSortKeyOnSubtree(
-      mOpenGLNode.get(), static_cast<int>(cs::utils::DrawOrder::eOpaqueNonHDR));
+  // the ellipse is drawn by the plugin's line renderer together with all other tools
+  mLines->setFrame(sCenter, sFrame);
+  pColor.connectAndTouch(
+      [this](glm::vec3 const& color) { mLines->setColor(glm::vec4(color, 1.F)); });
 
   mCenterHandle.pLngLat.connect([this](glm::dvec2 const& /*lngLat*/) {
     auto center = mCenterHandle.getAnchor()->getAnchorPosition();
@@ -127,9 +74,10 @@ EllipseTool::EllipseTool(std::shared_ptr<cs::core::InputManager> const& pInputMa
     });
   }
 
-  // Whenever the height scale changes our vertex positions need to be updated.
+  // Whenever the height scale changes our vertex positions need to be updated. The samples are
+  // stored without the height scale, so the terrain does not have to be sampled again.
   mScaleConnection =
-      mSettings->mGraphics.pHeightScale.connect([this](float /*h*/) { mVerticesDirty = true; });
+      mSettings->mGraphics.pHeightScale.connect([this](float /*h*/) { mPositionsDirty = true; });
 
   // Delete the tool when the center handle is deleted.
   pShouldDelete.connectFrom(mCenterHandle.pShouldDelete);
@@ -150,12 +98,8 @@ EllipseTool::~EllipseTool() {
   // disconnect slots
   mSettings->mGraphics.pHeightScale.disconnect(mScaleConnection);
 
-  mSolarSystem->unregisterAnchor(mAnchor);
   pShouldDelete.disconnect();
   pColor.disconnectAll();
-
-  auto* pSG = GetVistaSystem()->GetGraphicsManager()->GetSceneGraph();
-  pSG->GetRoot()->DisconnectChild(mOpenGLNode.get());
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -164,13 +108,13 @@ void EllipseTool::setCenterName(std::string const& name) {
   mCenterHandle.getAnchor()->setCenterName(name);
   mHandles.at(0)->getAnchor()->setCenterName(name);
   mHandles.at(1)->getAnchor()->setCenterName(name);
-  mAnchor->setCenterName(name);
+  mLines->setFrame(getCenterName(), getFrameName());
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 std::string const& EllipseTool::getCenterName() const {
-  return mAnchor->getCenterName();
+  return mCenterHandle.getAnchor()->getCenterName();
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -179,13 +123,13 @@ void EllipseTool::setFrameName(std::string const& name) {
   mCenterHandle.getAnchor()->setFrameName(name);
   mHandles.at(0)->getAnchor()->setFrameName(name);
   mHandles.at(1)->getAnchor()->setFrameName(name);
-  mAnchor->setFrameName(name);
+  mLines->setFrame(getCenterName(), getFrameName());
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 std::string const& EllipseTool::getFrameName() const {
-  return mAnchor->getFrameName();
+  return mCenterHandle.getAnchor()->getFrameName();
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -214,6 +158,12 @@ FlagTool& EllipseTool::getCenterHandle() {
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
+ToolGui& EllipseTool::getGui() {
+  return mCenterHandle.getGui();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
 cs::core::tools::Mark& EllipseTool::getFirstHandle() {
   return *mHandles.at(0);
 }
@@ -233,98 +183,141 @@ void EllipseTool::setNumSamples(int const& numSamples) {
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
+void EllipseTool::setInteriorSamples(int32_t samples) {
+  if (mInteriorSamples != samples) {
+    mInteriorSamples = samples;
+    mVerticesDirty   = true;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
 void EllipseTool::calculateVertices() {
   auto radii  = cs::core::SolarSystem::getRadii(mCenterHandle.getAnchor()->getCenterName());
   auto center = mCenterHandle.getAnchor()->getAnchorPosition();
   auto normal = cs::utils::convert::lngLatToNormal(mCenterHandle.pLngLat.get(), radii[0], radii[0]);
 
-  mAnchor->setAnchorPosition(center);
-
   glm::dvec3 north(0, 1, 0);
   glm::dvec3 east = glm::normalize(glm::cross(north, normal));
   north           = glm::normalize(glm::cross(normal, east));
 
-  std::vector<glm::vec3> vRelativePositions(mNumSamples);
+  std::vector<glm::dvec3> absPositions(mNumSamples);
   for (int i = 0; i < mNumSamples; ++i) {
     double phi = glm::mix(0.0, 2.0 * glm::pi<double>(), 1.0 * i / (mNumSamples - 1));
     double x   = std::sin(phi);
     double y   = std::cos(phi);
 
-    glm::dvec3 absPosition  = center + x * mAxes[0] + y * mAxes[1];
-    glm::dvec3 lngLatHeight = cs::utils::convert::toLngLatHeight(absPosition, radii[0], radii[0]);
+    absPositions[i] = center + x * mAxes[0] + y * mAxes[1];
+  }
 
-    double height = mSolarSystem->getBody(mCenterHandle.getAnchor()->getCenterName())
-                        ->getHeight(lngLatHeight.xy());
-    height *= mSettings->mGraphics.pHeightScale.get();
-    absPosition = cs::utils::convert::toCartesian(lngLatHeight.xy(), radii[0], radii[0], height);
+  // Projects all samples to the surface in one batch
+  std::vector<glm::dvec2> lngLats;
+  std::vector<double>     heights;
 
-    vRelativePositions[i] = absPosition - center;
-  }
+  auto body = mSolarSystem->getBody(mCenterHandle.getAnchor()->getCenterName());
 
-  mVBO.Bind(GL_ARRAY_BUFFER);
-  mVBO.BufferSubData(0, vRelativePositions.size() * sizeof(glm::vec3), vRelativePositions.data());
-  mVBO.Release();
+  projection::toLngLat(absPositions, lngLats);
+  projection::queryHeights(
+      [&body](glm::dvec2 const& lngLat) { return body->getHeight(lngLat); }, lngLats, heights);
+  projection::toSurfaceSamples(lngLats, heights, mSamples);
+
+  calculatePositions();
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
-void EllipseTool::update() {
-  mCenterHandle.update();
-  mHandles.at(0)->update();
-  mHandles.at(1)->update();
+void EllipseTool::calculatePositions() {
+  auto radii = cs::core::SolarSystem::getRadii(mCenterHandle.getAnchor()->getCenterName());
 
-  if (mVerticesDirty) {
-    calculateVertices();
-    mVerticesDirty = false;
-  }
+  std::vector<glm::dvec3> positions;
+  projection::toCartesian(radii[0], mSamples, mSettings->mGraphics.pHeightScale.get(), positions);
+
+  mLines->setPositions(positions);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool EllipseTool::hasPendingUpdate() const {
+  return mVerticesDirty;
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
-bool EllipseTool::Do() {
-  glPushAttrib(GL_ENABLE_BIT | GL_COLOR_BUFFER_BIT | GL_LINE_BIT);
+double EllipseTool::getUpdatePriority() const {
+  bool edited = mCenterHandle.pActive.get() || mCenterHandle.pSelected.get() ||
+                UpdateScheduler::isEdited(mHandles);
 
-  // enable alpha blending
-  glEnable(GL_BLEND);
-  glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+  return UpdateScheduler::getPriority(mSolarSystem->getObserver(),
+      mTimeControl->pSimulationTime.get(), *mCenterHandle.getAnchor(), edited);
+}
 
-  // enable and configure line rendering
-  glEnable(GL_LINE_SMOOTH);
-  glHint(GL_LINE_SMOOTH_HINT, GL_NICEST);
-  glLineWidth(5);
+////////////////////////////////////////////////////////////////////////////////////////////////////
 
-  std::array<GLfloat, 16> glMatMV{};
-  std::array<GLfloat, 16> glMatP{};
-  glGetFloatv(GL_MODELVIEW_MATRIX, glMatMV.data());
-  glGetFloatv(GL_PROJECTION_MATRIX, glMatP.data());
+void EllipseTool::updateCalculation() {
+  auto body = mSolarSystem->getBody(mCenterHandle.getAnchor()->getCenterName());
 
-  mShader.Bind();
-  mVAO.Bind();
-  glUniformMatrix4fv(mShader.GetUniformLocation("uMatModelView"), 1, GL_FALSE, glMatMV.data());
-  glUniformMatrix4fv(mShader.GetUniformLocation("uMatProjection"), 1, GL_FALSE, glMatP.data());
+  if (mInteriorSamples <= 0 || !body) {
+    mCalculation.cancel();
+    getGui().callJavascript("setInteriorStatistics", false);
+    return;
+  }
 
-  mShader.SetUniform(
-      mShader.GetUniformLocation("uColor"), pColor.get().r, pColor.get().g, pColor.get().b);
-  mShader.SetUniform(
-      mShader.GetUniformLocation("uFarClip"), cs::utils::getCurrentFarClipDistance());
+  // The axes and the center are copied, as the handles may be moved during the calculation
+  EllipseCalculator::Input input;
+  input.mCenter            = mCenterHandle.getAnchor()->getAnchorPosition();
+  input.mAxes              = mAxes;
+  input.mRadius            = cs::core::SolarSystem::getRadii(getCenterName())[0];
+  input.mHeightSource      = HeightProvider::getSource(mHeightProvider, body);
+  input.mBatchHeightSource = HeightProvider::getBatchSource(mHeightProvider, body);
+  input.mThreadPool        = mThreadPool.get();
+  input.mMaxSamples        = static_cast<uint32_t>(mInteriorSamples);
+
+  mCalculation.start(*mThreadPool, std::move(input));
+}
 
-  // draw the linestrip
-  glDrawArrays(GL_LINE_STRIP, 0, mNumSamples);
-  mVAO.Release();
-  mShader.Release();
+////////////////////////////////////////////////////////////////////////////////////////////////////
 
-  glPopAttrib();
-  return true;
+void EllipseTool::processPendingUpdate() {
+  calculateVertices();
+  updateCalculation();
+  mVerticesDirty  = false;
+  mPositionsDirty = false;
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
-bool EllipseTool::GetBoundingBox(VistaBoundingBox& bb) {
-  std::array fMin{-0.1F, -0.1F, -0.1F};
-  std::array fMax{0.1F, 0.1F, 0.1F};
+void EllipseTool::update() {
+  mCenterHandle.update();
+  mHandles.at(0)->update();
+  mHandles.at(1)->update();
+
+  // If the ellipse has to be sampled again, the positions are rebuilt by processPendingUpdate()
+  if (mPositionsDirty && !mVerticesDirty) {
+    calculatePositions();
+    mPositionsDirty = false;
+  }
+
+  // Shows the totals after each level of the calculation, the last one is the final result
+  auto showTotals = [this](EllipseCalculator::Totals const& totals, bool computing) {
+    getGui().callJavascript("setInteriorStatistics", true, totals.mSamples, totals.mMinHeight,
+        totals.mMaxHeight, totals.mMeanHeight, totals.mMeanSlope, totals.mMaxSlope,
+        totals.mRoughness, computing);
+  };
+
+  EllipseCalculator::Totals progress;
+  if (mCalculation.isRunning() && mCalculation.getCalculator()->getProgress(progress)) {
+    showTotals(progress, true);
+  }
+
+  try {
+    auto calculator = mCalculation.poll();
 
-  bb.SetBounds(fMin.data(), fMax.data());
-  return true;
+    if (calculator) {
+      showTotals(calculator->getResult(), false);
+    }
+  } catch (std::exception const& e) {
+    logger().warn("Failed to calculate the terrain statistics of ellipse: {}", e.what());
+  }
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
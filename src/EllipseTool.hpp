@@ -7,15 +7,24 @@
 #ifndef CSP_MEASUREMENT_TOOLS_ELLIPSE_HPP
 #define CSP_MEASUREMENT_TOOLS_ELLIPSE_HPP
 
+#include "AsyncCalculation.hpp"
+#include "EllipseCalculator.hpp"
 #include "FlagTool.hpp"
+#include "LineRenderer.hpp"
+#include "SurfaceProjection.hpp"
+#include "UpdateScheduler.hpp"
 
 #include <array>
 
 namespace csp::measurementtools {
 
+class HeightProvider;
+
 /// The ellipse tool uses three points on the surface to draw an ellipse. A center point and two
-/// points through which the edge has to go through.
-class EllipseTool : public IVistaOpenGLDraw, public cs::core::tools::Tool {
+/// points through which the edge has to go through. If enabled, statistics of the terrain inside
+/// of the ellipse are calculated by an EllipseCalculator on the given thread pool and shown in the
+/// user interface of the center handle.
+class EllipseTool : public cs::core::tools::Tool, public UpdateScheduler::Client {
  public:
   /// The ellipse and all handels are drawn with this color.
   cs::utils::Property<glm::vec3> pColor = glm::vec3(0.75, 0.75, 1.0);
@@ -23,7 +32,10 @@ class EllipseTool : public IVistaOpenGLDraw, public cs::core::tools::Tool {
   EllipseTool(std::shared_ptr<cs::core::InputManager> const& pInputManager,
       std::shared_ptr<cs::core::SolarSystem> const&          pSolarSystem,
       std::shared_ptr<cs::core::Settings> const&             settings,
-      std::shared_ptr<cs::core::TimeControl> const& pTimeControl, std::string const& sCenter,
+      std::shared_ptr<cs::core::TimeControl> const&          pTimeControl,
+      std::shared_ptr<LineRenderer> const& pLineRenderer,
+      std::shared_ptr<ThreadPool> const& pThreadPool,
+      std::shared_ptr<HeightProvider> const& pHeightProvider, std::string const& sCenter,
       std::string const& sFrame);
 
   EllipseTool(EllipseTool const& other) = delete;
@@ -52,40 +64,55 @@ class EllipseTool : public IVistaOpenGLDraw, public cs::core::tools::Tool {
   /// Called from Tools class.
   void update() override;
 
-  /// Inherited from IVistaOpenGLDraw.
-  bool Do() override;
-  bool GetBoundingBox(VistaBoundingBox& bb) override;
+  /// These are called by the UpdateScheduler. The terrain is only sampled in
+  /// processPendingUpdate().
+  bool   hasPendingUpdate() const override;
+  double getUpdatePriority() const override;
+  void   processPendingUpdate() override;
+
+  /// The user interface of the ellipse is the one of its center handle.
+  ToolGui& getGui();
 
   void setNumSamples(int const& numSamples);
 
+  /// If larger than zero, the terrain inside of the ellipse is sampled at up to this many points.
+  void setInteriorSamples(int32_t samples);
+
  private:
+  /// Samples the ellipse and projects it to the terrain.
   void calculateVertices();
 
+  /// Rebuilds the positions from the samples with the current height scale.
+  void calculatePositions();
+
+  /// Starts a new calculation of the interior statistics on the thread pool, if these are
+  /// enabled. A calculation which is still running is cancelled.
+  void updateCalculation();
+
   std::shared_ptr<cs::core::SolarSystem> mSolarSystem;
   std::shared_ptr<cs::core::Settings>    mSettings;
   std::shared_ptr<cs::core::TimeControl> mTimeControl;
 
-  std::shared_ptr<cs::scene::CelestialAnchorNode> mAnchor;
-
-  bool mVerticesDirty = false;
-  bool mFirstUpdate   = true;
+  bool mVerticesDirty  = false;
+  bool mPositionsDirty = false;
+  bool mFirstUpdate    = true;
 
   FlagTool                                              mCenterHandle;
   std::array<glm::dvec3, 2>                             mAxes;
   std::array<std::unique_ptr<cs::core::tools::Mark>, 2> mHandles;
   std::array<int, 2>                                    mHandleConnections{};
 
-  std::unique_ptr<VistaOpenGLNode> mOpenGLNode;
-
-  VistaVertexArrayObject mVAO;
-  VistaBufferObject      mVBO;
-  VistaGLSLShader        mShader;
+  std::shared_ptr<LineRenderer::Geometry> mLines;
+  projection::SurfaceSamples              mSamples;
 
-  int mScaleConnection = -1;
-  int mNumSamples      = 360;
+  int     mScaleConnection = -1;
+  int     mNumSamples      = 360;
+  int32_t mInteriorSamples = 0;
 
-  static const char* SHADER_VERT;
-  static const char* SHADER_FRAG;
+  // The statistics of the interior are shown by update() once they are calculated.
+  std::shared_ptr<ThreadPool>         mThreadPool;
+  std::shared_ptr<HeightProvider>     mHeightProvider;
+  AsyncCalculation<EllipseCalculator> mCalculation;
 };
 } // namespace csp::measurementtools
 #endif // CSP_MEASUREMENT_TOOLS_ELLIPSE_HPP
@@ -6,7 +6,6 @@
 
 #include "FlagTool.hpp"
 
-#include "../../../src/cs-core/GuiManager.hpp"
 #include "../../../src/cs-core/InputManager.hpp"
 #include "../../../src/cs-core/Settings.hpp"
 #include "../../../src/cs-core/SolarSystem.hpp"
@@ -14,11 +13,6 @@
 #include "../../../src/cs-scene/CelestialAnchorNode.hpp"
 #include "../../../src/cs-utils/convert.hpp"
 
-#include <VistaKernel/GraphicsManager/VistaOpenGLNode.h>
-#include <VistaKernel/GraphicsManager/VistaSceneGraph.h>
-#include <VistaKernel/VistaSystem.h>
-#include <VistaKernelOpenSGExt/VistaOpenSGMaterialTools.h>
-
 namespace csp::measurementtools {
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -29,35 +23,17 @@ FlagTool::FlagTool(std::shared_ptr<cs::core::InputManager> const& pInputManager,
     std::shared_ptr<cs::core::TimeControl> const& pTimeControl, std::string const& sCenter,
     std::string const& sFrame)
     : Mark(pInputManager, pSolarSystem, settings, pTimeControl, sCenter, sFrame)
-    , mGuiArea(std::make_unique<cs::gui::WorldSpaceGuiArea>(420, 400))
-    , mGuiItem(std::make_unique<cs::gui::GuiItem>("file://../share/resources/gui/flag.html")) {
-  auto* pSG = GetVistaSystem()->GetGraphicsManager()->GetSceneGraph();
-
-  mGuiTransform.reset(pSG->NewTransformNode(mAnchor.get()));
-  mGuiTransform->Translate(0.5F - 7.5F / 500.F, 0.5F, 0.F);
-  mGuiTransform->Scale(0.001F * static_cast<float>(mGuiArea->getWidth()),
-      0.001F * static_cast<float>(mGuiArea->getHeight()), 1.F);
-  mGuiTransform->Rotate(VistaAxisAndAngle(VistaVector3D(0.0, 1.0, 0.0), -glm::pi<float>() / 2.F));
-  mGuiArea->addItem(mGuiItem.get());
-  mGuiArea->setUseLinearDepthBuffer(true);
-
-  mGuiNode.reset(pSG->NewOpenGLNode(mGuiTransform.get(), mGuiArea.get()));
-  mInputManager->registerSelectable(mGuiNode.get());
-
-  VistaOpenSGMaterialTools::SetSortKeyOnSubtree(
-      mGuiNode.get(), static_cast<int>(cs::utils::DrawOrder::eTransparentItems));
-
-  mGuiItem->setCanScroll(false);
-  mGuiItem->waitForFinishedLoading();
-  mGuiItem->registerCallback("deleteMe", "Call this to delete the tool.",
+    , mGui(std::make_unique<ToolGui>(mInputManager, mAnchor,
+          "file://../share/resources/gui/flag.html", 420, 400,
+          glm::vec3(0.5F - 7.5F / 500.F, 0.5F, 0.F))) {
+  mGui->registerCallback("deleteMe", "Call this to delete the tool.",
       std::function([this]() { pShouldDelete = true; }));
-  mGuiItem->setCursorChangeCallback([](cs::gui::Cursor c) { cs::core::GuiManager::setCursor(c); });
 
   // Update text.
   mTextConnection = pText.connectAndTouch(
-      [this](std::string const& value) { mGuiItem->callJavascript("setText", value); });
+      [this](std::string const& value) { mGui->callJavascript("setText", value); });
 
-  mGuiItem->registerCallback("onSetText",
+  mGui->registerCallback("onSetText",
       "This is called whenever the text input of the tool's name changes.",
       std::function(
           [this](std::string&& value) { pText.setWithEmitForAllButOne(value, mTextConnection); }));
@@ -67,7 +43,7 @@ FlagTool::FlagTool(std::shared_ptr<cs::core::InputManager> const& pInputManager,
     auto body = mSolarSystem->getBody(mAnchor->getCenterName());
     if (body) {
       double h = body->getHeight(lngLat);
-      mGuiItem->callJavascript("setPosition", cs::utils::convert::toDegrees(lngLat.x),
+      mGui->callJavascript("setPosition", cs::utils::convert::toDegrees(lngLat.x),
           cs::utils::convert::toDegrees(lngLat.y), h);
     }
   });
@@ -79,24 +55,17 @@ FlagTool::FlagTool(std::shared_ptr<cs::core::InputManager> const& pInputManager,
     }
   });
 
-  pMinimized.connect([this](bool val) { mGuiItem->callJavascript("setMinimized", val); });
+  pMinimized.connect([this](bool val) { mGui->callJavascript("setMinimized", val); });
 
-  mGuiItem->registerCallback("minimizeMe", "Call this to minimize the flag.",
+  mGui->registerCallback("minimizeMe", "Call this to minimize the flag.",
       std::function([this]() { pMinimized = true; }));
-  mGuiItem->callJavascript("setActivePlanet", sCenter, sFrame);
+  mGui->callJavascript("setActivePlanet", sCenter, sFrame);
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 FlagTool::~FlagTool() {
-  auto* pSG = GetVistaSystem()->GetGraphicsManager()->GetSceneGraph();
-  pSG->GetRoot()->DisconnectChild(mGuiTransform.get());
-
   mInputManager->sOnDoubleClick.disconnect(mDoubleClickConnection);
-  mInputManager->unregisterSelectable(mGuiNode.get());
-  mGuiItem->unregisterCallback("minimizeMe");
-  mGuiItem->unregisterCallback("deleteMe");
-  mGuiItem->unregisterCallback("onSetText");
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -120,4 +89,10 @@ void FlagTool::update() {
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
+ToolGui& FlagTool::getGui() {
+  return *mGui;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
 } // namespace csp::measurementtools
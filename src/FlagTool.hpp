@@ -8,13 +8,7 @@
 #define CSP_MEASUREMENT_TOOLS_FLAG_HPP
 
 #include "../../../src/cs-core/tools/Mark.hpp"
-
-namespace cs::gui {
-class GuiItem;
-class WorldSpaceGuiArea;
-} // namespace cs::gui
-
-class VistaTransformNode;
+#include "ToolGui.hpp"
 
 namespace csp::measurementtools {
 
@@ -45,11 +39,11 @@ class FlagTool : public cs::core::tools::Mark {
   /// than facing always the observer.
   void update() override;
 
+  /// The web view of the flag is only created when the flag is close to the observer.
+  ToolGui& getGui();
+
  private:
-  std::unique_ptr<VistaTransformNode>         mGuiTransform;
-  std::unique_ptr<VistaOpenGLNode>            mGuiNode;
-  std::unique_ptr<cs::gui::WorldSpaceGuiArea> mGuiArea;
-  std::unique_ptr<cs::gui::GuiItem>           mGuiItem;
+  std::unique_ptr<ToolGui> mGui;
 
   int mTextConnection        = -1;
   int mDoubleClickConnection = -1;
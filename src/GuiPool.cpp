@@ -0,0 +1,134 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//                               This file is part of CosmoScout VR                               //
+//      and may be used under the terms of the MIT license. See the LICENSE file for details.     //
+//                        Copyright: (c) 2019 German Aerospace Center (DLR)                       //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "GuiPool.hpp"
+
+#include "../../../src/cs-gui/GuiItem.hpp"
+#include "../../../src/cs-gui/WorldSpaceGuiArea.hpp"
+#include "ToolGui.hpp"
+
+#include <algorithm>
+#include <utility>
+
+namespace csp::measurementtools {
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+const double GuiPool::HYSTERESIS = 1.2;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+GuiPool::~GuiPool() = default;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void GuiPool::setCapacity(size_t capacity) {
+  mCapacity = capacity;
+
+  // Web views which are in use are released once the tools are updated next time.
+  while (!mUnused.empty() && mUsedCount + mUnused.size() > mCapacity) {
+    mUnused.erase(mUnused.begin());
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void GuiPool::update(std::vector<ToolGui*> const& guis,
+    cs::scene::CelestialObserver const& observer, double simulationTime, double maxDistance) {
+
+  // User interfaces which already have a web view appear closer, so that they keep it while they
+  // are only slightly further away than a user interface without one.
+  std::vector<std::pair<double, ToolGui*>> candidates;
+
+  for (auto* gui : guis) {
+    gui->update(*this, observer, simulationTime);
+
+    double distance = gui->getDistance();
+
+    if (gui->getIsCreated()) {
+      distance /= HYSTERESIS;
+    }
+
+    if (distance < maxDistance) {
+      candidates.emplace_back(distance, gui);
+    } else {
+      gui->setShouldBeCreated(false);
+    }
+  }
+
+  std::sort(candidates.begin(), candidates.end(),
+      [](auto const& a, auto const& b) { return a.first < b.first; });
+
+  for (size_t i(0); i < candidates.size(); ++i) {
+    candidates[i].second->setShouldBeCreated(i < mCapacity);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+std::unique_ptr<GuiPool::Item> GuiPool::acquire(std::string const& url, int width, int height) {
+  auto unused = std::find_if(mUnused.begin(), mUnused.end(),
+      [&url](std::unique_ptr<Item> const& item) { return item->mUrl == url; });
+
+  if (unused != mUnused.end()) {
+    auto item = std::move(*unused);
+    mUnused.erase(unused);
+    ++mUsedCount;
+    return item;
+  }
+
+  if (mUsedCount >= mCapacity) {
+    return nullptr;
+  }
+
+  // Make room by removing an unused web view with another page.
+  if (mUsedCount + mUnused.size() >= mCapacity) {
+    mUnused.erase(mUnused.begin());
+  }
+
+  auto item      = std::make_unique<Item>();
+  item->mUrl     = url;
+  item->mGuiArea = std::make_unique<cs::gui::WorldSpaceGuiArea>(width, height);
+  item->mGuiItem = std::make_unique<cs::gui::GuiItem>(url);
+  item->mGuiArea->addItem(item->mGuiItem.get());
+  item->mGuiArea->setUseLinearDepthBuffer(true);
+  item->mGuiItem->setCanScroll(false);
+  item->mGuiItem->waitForFinishedLoading();
+
+  ++mUsedCount;
+
+  return item;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void GuiPool::release(std::unique_ptr<Item> item) {
+  --mUsedCount;
+
+  if (mUsedCount + mUnused.size() >= mCapacity) {
+    return;
+  }
+
+  // Each page implements reset(), which removes everything the previous tool has shown.
+  item->mGuiItem->callJavascript("reset");
+  mUnused.push_back(std::move(item));
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+size_t GuiPool::getUsedCount() const {
+  return mUsedCount;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+size_t GuiPool::getUnusedCount() const {
+  return mUnused.size();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+} // namespace csp::measurementtools
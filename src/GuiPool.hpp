@@ -0,0 +1,84 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//                               This file is part of CosmoScout VR                               //
+//      and may be used under the terms of the MIT license. See the LICENSE file for details.     //
+//                        Copyright: (c) 2019 German Aerospace Center (DLR)                       //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef CSP_MEASUREMENT_TOOLS_GUI_POOL_HPP
+#define CSP_MEASUREMENT_TOOLS_GUI_POOL_HPP
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace cs::gui {
+class GuiItem;
+class WorldSpaceGuiArea;
+} // namespace cs::gui
+
+namespace cs::scene {
+class CelestialObserver;
+} // namespace cs::scene
+
+namespace csp::measurementtools {
+
+class ToolGui;
+
+/// A limited number of web views which are shared by the user interfaces of all tools. Each frame,
+/// the Plugin passes all user interfaces to update(). The ones closest to the observer get a web
+/// view, all others give theirs back. A returned web view is kept and handed to the next tool with
+/// the same page, so it neither has to be allocated nor loaded again. Therefore, the number of
+/// browser surfaces and textures does not depend on the number of tools.
+class GuiPool {
+ public:
+  /// A web view with its page loaded.
+  struct Item {
+    std::string                                 mUrl;
+    std::unique_ptr<cs::gui::WorldSpaceGuiArea> mGuiArea;
+    std::unique_ptr<cs::gui::GuiItem>           mGuiItem;
+  };
+
+  GuiPool() = default;
+
+  GuiPool(GuiPool const& other) = delete;
+  GuiPool(GuiPool&& other)      = delete;
+
+  GuiPool& operator=(GuiPool const& other) = delete;
+  GuiPool& operator=(GuiPool&& other) = delete;
+
+  ~GuiPool();
+
+  /// The maximum number of web views, including the unused ones.
+  void setCapacity(size_t capacity);
+
+  /// Decides which of the given user interfaces should have a web view. These are the ones closest
+  /// to the observer, as long as they are closer than maxDistance meters. The web views are
+  /// acquired and released by the user interfaces when the UpdateScheduler processes them.
+  void update(std::vector<ToolGui*> const& guis, cs::scene::CelestialObserver const& observer,
+      double simulationTime, double maxDistance);
+
+  /// Returns a web view showing the given page. An unused one is reused if possible, otherwise a
+  /// new one is created. This returns nullptr if all web views are in use.
+  std::unique_ptr<Item> acquire(std::string const& url, int width, int height);
+
+  /// Returns a web view to the pool. All its callbacks must have been unregistered.
+  void release(std::unique_ptr<Item> item);
+
+  /// The number of web views which are currently used by tools or unused.
+  size_t getUsedCount() const;
+  size_t getUnusedCount() const;
+
+ private:
+  size_t                             mCapacity  = 16;
+  size_t                             mUsedCount = 0;
+  std::vector<std::unique_ptr<Item>> mUnused;
+
+  // A tool which already has a web view keeps it until it is this many times further away than
+  // the distance at which it would get one. This prevents acquiring and releasing web views in
+  // each frame.
+  static const double HYSTERESIS;
+};
+
+} // namespace csp::measurementtools
+
+#endif // CSP_MEASUREMENT_TOOLS_GUI_POOL_HPP
@@ -0,0 +1,171 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//                               This file is part of CosmoScout VR                               //
+//      and may be used under the terms of the MIT license. See the LICENSE file for details.     //
+//                        Copyright: (c) 2019 German Aerospace Center (DLR)                       //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "HeightCache.hpp"
+
+#include <cmath>
+#include <utility>
+
+namespace csp::measurementtools {
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool HeightCache::Key::operator==(Key const& other) const {
+  return mLng == other.mLng && mLat == other.mLat;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+size_t HeightCache::KeyHash::operator()(Key const& key) const {
+  // Combines both quantized coordinates, based on boost::hash_combine
+  size_t seed = std::hash<int64_t>()(key.mLng);
+  seed ^= std::hash<int64_t>()(key.mLat) + 0x9e3779b9 + (seed << 6U) + (seed >> 2U);
+  return seed;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+HeightCache::HeightCache(double precision)
+    : mPrecision(precision) {
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void HeightCache::reset(HeightSource source, BatchHeightSource batchSource) {
+  mSource      = std::move(source);
+  mBatchSource = std::move(batchSource);
+
+  for (auto& shard : mShards) {
+    shard.mHeights.clear();
+  }
+
+  mHits   = 0;
+  mMisses = 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+double HeightCache::getHeight(glm::dvec2 const& lngLat) {
+  Key   key   = getKey(lngLat);
+  auto& shard = mShards[KeyHash()(key) % SHARD_COUNT];
+
+  {
+    std::unique_lock<std::mutex> lock(shard.mMutex);
+
+    auto it = shard.mHeights.find(key);
+    if (it != shard.mHeights.end()) {
+      ++mHits;
+      return it->second;
+    }
+  }
+
+  ++mMisses;
+  double height = mSource(lngLat);
+
+  std::unique_lock<std::mutex> lock(shard.mMutex);
+  shard.mHeights.emplace(key, height);
+  return height;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void HeightCache::getHeights(std::vector<glm::dvec2> const& lngLats, std::vector<double>& heights) {
+  heights.resize(lngLats.size());
+
+  // Pairs of the indices of all coordinates which are not cached yet and the indices of their
+  // locations in missingLngLats
+  std::vector<std::pair<size_t, size_t>>   missing;
+  std::vector<glm::dvec2>                  missingLngLats;
+  std::unordered_map<Key, size_t, KeyHash> missingIndices;
+
+  for (size_t i = 0; i < lngLats.size(); ++i) {
+    Key   key   = getKey(lngLats[i]);
+    auto& shard = mShards[KeyHash()(key) % SHARD_COUNT];
+
+    {
+      std::unique_lock<std::mutex> lock(shard.mMutex);
+
+      auto it = shard.mHeights.find(key);
+      if (it != shard.mHeights.end()) {
+        ++mHits;
+        heights[i] = it->second;
+        continue;
+      }
+    }
+
+    auto [it, inserted] = missingIndices.emplace(key, missingLngLats.size());
+    if (inserted) {
+      ++mMisses;
+      missingLngLats.push_back(lngLats[i]);
+    } else {
+      ++mHits;
+    }
+
+    missing.emplace_back(i, it->second);
+  }
+
+  if (missing.empty()) {
+    return;
+  }
+
+  std::vector<double> missingHeights(missingLngLats.size());
+
+  if (mBatchSource) {
+    mBatchSource(missingLngLats, missingHeights);
+  } else {
+    for (size_t i = 0; i < missingLngLats.size(); ++i) {
+      missingHeights[i] = mSource(missingLngLats[i]);
+    }
+  }
+
+  for (size_t i = 0; i < missingLngLats.size(); ++i) {
+    Key   key   = getKey(missingLngLats[i]);
+    auto& shard = mShards[KeyHash()(key) % SHARD_COUNT];
+
+    std::unique_lock<std::mutex> lock(shard.mMutex);
+    shard.mHeights.emplace(key, missingHeights[i]);
+  }
+
+  for (auto const& [index, location] : missing) {
+    heights[index] = missingHeights[location];
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+uint64_t HeightCache::getHits() const {
+  return mHits;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+uint64_t HeightCache::getMisses() const {
+  return mMisses;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+size_t HeightCache::getSize() const {
+  size_t size = 0;
+
+  for (auto const& shard : mShards) {
+    std::unique_lock<std::mutex> lock(shard.mMutex);
+    size += shard.mHeights.size();
+  }
+
+  return size;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+HeightCache::Key HeightCache::getKey(glm::dvec2 const& lngLat) const {
+  return Key{static_cast<int64_t>(std::llround(lngLat.x / mPrecision)),
+      static_cast<int64_t>(std::llround(lngLat.y / mPrecision))};
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+} // namespace csp::measurementtools
@@ -0,0 +1,94 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//                               This file is part of CosmoScout VR                               //
+//      and may be used under the terms of the MIT license. See the LICENSE file for details.     //
+//                        Copyright: (c) 2019 German Aerospace Center (DLR)                       //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef CSP_MEASUREMENT_TOOLS_HEIGHT_CACHE_HPP
+#define CSP_MEASUREMENT_TOOLS_HEIGHT_CACHE_HPP
+
+#include <glm/glm.hpp>
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace csp::measurementtools {
+
+/// Memoizes terrain height queries for the duration of one calculation. The lng/lat coordinates
+/// are quantized, so that points which are computed along different code paths but describe the
+/// same location on the surface share one entry. The cache has to be cleared whenever the
+/// underlying terrain or the queried body changes. getHeight() may be called from several threads
+/// at once; reset() must not be called concurrently with it.
+class HeightCache {
+ public:
+  /// The function which is called for every cache miss. It receives lng/lat in radians.
+  using HeightSource = std::function<double(glm::dvec2 const&)>;
+
+  /// Resolves the heights of several lng/lat coordinates with one request, so that the terrain
+  /// backend can group its tile lookups. The heights have to be written to the second argument,
+  /// which has the same size as the first one.
+  using BatchHeightSource =
+      std::function<void(std::vector<glm::dvec2> const&, std::vector<double>&)>;
+
+  /// The precision is given in radians. The default corresponds to a few millimeters on an
+  /// Earth-sized body, which is well below the resolution of any DEM.
+  explicit HeightCache(double precision = 1e-9);
+
+  /// Removes all entries and resets the statistics. The given sources are used for all subsequent
+  /// queries. If no batch source is given, getHeights() queries the single-point source for each
+  /// missing height.
+  void reset(HeightSource source, BatchHeightSource batchSource = {});
+
+  /// Returns the height at the given lng/lat. The source is only queried if no height for this
+  /// location has been cached yet. The source is called without holding a lock, so two threads
+  /// may occasionally query the same location.
+  double getHeight(glm::dvec2 const& lngLat);
+
+  /// Writes the heights at all given lng/lat coordinates to heights. All heights which are not
+  /// cached yet are resolved with one request to the batch source. Identical locations within the
+  /// batch are only requested once.
+  void getHeights(std::vector<glm::dvec2> const& lngLats, std::vector<double>& heights);
+
+  uint64_t getHits() const;
+  uint64_t getMisses() const;
+  size_t   getSize() const;
+
+ private:
+  struct Key {
+    int64_t mLng;
+    int64_t mLat;
+
+    bool operator==(Key const& other) const;
+  };
+
+  struct KeyHash {
+    size_t operator()(Key const& key) const;
+  };
+
+  Key getKey(glm::dvec2 const& lngLat) const;
+
+  // The entries are split into shards with separate locks, so that concurrent queries rarely
+  // block each other.
+  struct Shard {
+    mutable std::mutex                       mMutex;
+    std::unordered_map<Key, double, KeyHash> mHeights;
+  };
+
+  static const size_t SHARD_COUNT = 16;
+
+  double                         mPrecision;
+  HeightSource                   mSource;
+  BatchHeightSource              mBatchSource;
+  std::array<Shard, SHARD_COUNT> mShards;
+  std::atomic<uint64_t>          mHits{0};
+  std::atomic<uint64_t>          mMisses{0};
+};
+
+} // namespace csp::measurementtools
+
+#endif // CSP_MEASUREMENT_TOOLS_HEIGHT_CACHE_HPP
@@ -0,0 +1,144 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//                               This file is part of CosmoScout VR                               //
+//      and may be used under the terms of the MIT license. See the LICENSE file for details.     //
+//                        Copyright: (c) 2019 German Aerospace Center (DLR)                       //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "HeightProvider.hpp"
+
+#include "../../../src/cs-scene/CelestialBody.hpp"
+
+#include <chrono>
+#include <stdexcept>
+
+namespace csp::measurementtools {
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+HeightProvider::HeightProvider()
+    : mMainThread(std::this_thread::get_id()) {
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+HeightCache::HeightSource HeightProvider::getSource(
+    std::shared_ptr<HeightProvider> const&           provider,
+    std::shared_ptr<cs::scene::CelestialBody> const& body) {
+  return [provider, body](glm::dvec2 const& lngLat) {
+    std::vector<glm::dvec2> lngLats{lngLat};
+    std::vector<double>     heights;
+    provider->query(*body, lngLats, heights);
+    return heights[0];
+  };
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+HeightCache::BatchHeightSource HeightProvider::getBatchSource(
+    std::shared_ptr<HeightProvider> const&           provider,
+    std::shared_ptr<cs::scene::CelestialBody> const& body) {
+  return [provider, body](std::vector<glm::dvec2> const& lngLats, std::vector<double>& heights) {
+    provider->query(*body, lngLats, heights);
+  };
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void HeightProvider::processQueries(double budget) {
+  auto deadline = std::chrono::steady_clock::now() +
+                  std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                      std::chrono::duration<double, std::milli>(budget));
+  bool active = false;
+
+  std::unique_lock<std::mutex> lock(mMutex);
+
+  while (!mStopped) {
+    // Queued queries are left for the next frame once the budget is used up, as a steady stream
+    // of queries from several workers would block the main thread otherwise.
+    if (active && std::chrono::steady_clock::now() >= deadline) {
+      break;
+    }
+
+    if (mQueries.empty()) {
+      if (!active ||
+          !mCondition.wait_until(lock, deadline, [this]() { return !mQueries.empty(); })) {
+        break;
+      }
+    }
+
+    auto query = mQueries.front();
+    mQueries.pop_front();
+    active = true;
+
+    // The body is queried without holding the lock, so that other threads can queue their
+    // queries in the meantime.
+    lock.unlock();
+
+    try {
+      resolve(*query->mBody, *query->mLngLats, *query->mHeights);
+      query->mDone.set_value();
+    } catch (...) {
+      query->mDone.set_exception(std::current_exception());
+    }
+
+    lock.lock();
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void HeightProvider::shutdown() {
+  std::unique_lock<std::mutex> lock(mMutex);
+  mStopped = true;
+
+  for (auto const& query : mQueries) {
+    query->mDone.set_exception(
+        std::make_exception_ptr(std::runtime_error("The terrain is not available anymore!")));
+  }
+
+  mQueries.clear();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void HeightProvider::query(cs::scene::CelestialBody& body, std::vector<glm::dvec2> const& lngLats,
+    std::vector<double>& heights) {
+  if (std::this_thread::get_id() == mMainThread) {
+    resolve(body, lngLats, heights);
+    return;
+  }
+
+  auto query      = std::make_shared<Query>();
+  query->mBody    = &body;
+  query->mLngLats = &lngLats;
+  query->mHeights = &heights;
+  auto done       = query->mDone.get_future();
+
+  {
+    std::unique_lock<std::mutex> lock(mMutex);
+
+    if (mStopped) {
+      throw std::runtime_error("The terrain is not available anymore!");
+    }
+
+    mQueries.push_back(query);
+  }
+
+  mCondition.notify_one();
+  done.get();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void HeightProvider::resolve(cs::scene::CelestialBody& body,
+    std::vector<glm::dvec2> const& lngLats, std::vector<double>& heights) {
+  heights.resize(lngLats.size());
+
+  for (size_t i = 0; i < lngLats.size(); ++i) {
+    heights[i] = body.getHeight(lngLats[i]);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+} // namespace csp::measurementtools
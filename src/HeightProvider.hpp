@@ -0,0 +1,95 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//                               This file is part of CosmoScout VR                               //
+//      and may be used under the terms of the MIT license. See the LICENSE file for details.     //
+//                        Copyright: (c) 2019 German Aerospace Center (DLR)                       //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef CSP_MEASUREMENT_TOOLS_HEIGHT_PROVIDER_HPP
+#define CSP_MEASUREMENT_TOOLS_HEIGHT_PROVIDER_HPP
+
+#include "HeightCache.hpp"
+
+#include <glm/glm.hpp>
+
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace cs::scene {
+class CelestialBody;
+}
+
+namespace csp::measurementtools {
+
+/// Makes the terrain heights of the bodies available to the calculations on the thread pool.
+/// CelestialBody::getHeight() reads terrain tiles which are updated by the main thread every
+/// frame, so it must not be called from any other thread. The height sources returned by this
+/// class can be called from any thread: On the main thread they query the body directly, on all
+/// other threads they queue their query and block until it has been answered on the main thread
+/// by processQueries(). The Plugin calls this once per frame.
+class HeightProvider {
+ public:
+  /// Has to be constructed on the main thread.
+  HeightProvider();
+
+  HeightProvider(HeightProvider const& other) = delete;
+  HeightProvider(HeightProvider&& other)      = delete;
+
+  HeightProvider& operator=(HeightProvider const& other) = delete;
+  HeightProvider& operator=(HeightProvider&& other) = delete;
+
+  ~HeightProvider() = default;
+
+  /// The sources keep a reference to this provider and to the body. They can be called from any
+  /// thread. After shutdown(), calls from other threads than the main thread throw a
+  /// std::runtime_error.
+  static HeightCache::HeightSource getSource(std::shared_ptr<HeightProvider> const& provider,
+      std::shared_ptr<cs::scene::CelestialBody> const&                               body);
+  static HeightCache::BatchHeightSource getBatchSource(
+      std::shared_ptr<HeightProvider> const&           provider,
+      std::shared_ptr<cs::scene::CelestialBody> const& body);
+
+  /// Answers the queued queries until the given time in milliseconds has passed; at least one
+  /// query is answered per call. As the calculations usually post their next query right after
+  /// receiving an answer, further queries are waited for until then. Must be called on the main
+  /// thread. The calculations should request all heights they need at once with the batch source,
+  /// as each query costs them at least one round trip to the main thread.
+  void processQueries(double budget);
+
+  /// Lets all queued and all future queries from other threads fail, so that the calculations
+  /// abort and the thread pool can be joined. Must be called on the main thread before the pool
+  /// is destroyed.
+  void shutdown();
+
+ private:
+  // The queries are shared with the waiting thread, as it may return from waiting while the
+  // main thread is still fulfilling the promise.
+  struct Query {
+    cs::scene::CelestialBody*      mBody    = nullptr;
+    std::vector<glm::dvec2> const* mLngLats = nullptr;
+    std::vector<double>*           mHeights = nullptr;
+    std::promise<void>             mDone;
+  };
+
+  /// Writes the heights at the given lng/lat coordinates of the body to heights. Blocks until
+  /// they have been resolved on the main thread.
+  void query(cs::scene::CelestialBody& body, std::vector<glm::dvec2> const& lngLats,
+      std::vector<double>& heights);
+
+  static void resolve(cs::scene::CelestialBody& body, std::vector<glm::dvec2> const& lngLats,
+      std::vector<double>& heights);
+
+  std::thread::id                    mMainThread;
+  std::mutex                         mMutex;
+  std::condition_variable            mCondition;
+  std::deque<std::shared_ptr<Query>> mQueries;
+  bool                               mStopped = false;
+};
+
+} // namespace csp::measurementtools
+
+#endif // CSP_MEASUREMENT_TOOLS_HEIGHT_PROVIDER_HPP
@@ -0,0 +1,601 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//                               This file is part of CosmoScout VR                               //
+//      and may be used under the terms of the MIT license. See the LICENSE file for details.     //
+//                        Copyright: (c) 2019 German Aerospace Center (DLR)                       //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "LineRenderer.hpp"
+
+#include "../../../src/cs-core/SolarSystem.hpp"
+#include "../../../src/cs-core/TimeControl.hpp"
+#include "../../../src/cs-scene/CelestialAnchor.hpp"
+#include "../../../src/cs-utils/utils.hpp"
+
+#include <VistaKernel/GraphicsManager/VistaOpenGLNode.h>
+#include <VistaKernel/GraphicsManager/VistaSceneGraph.h>
+#include <VistaKernel/VistaSystem.h>
+#include <VistaKernelOpenSGExt/VistaOpenSGMaterialTools.h>
+
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <tuple>
+#include <utility>
+
+namespace csp::measurementtools {
+
+namespace {
+
+// Each geometry occupies this many texels in the texture buffer: four for the columns of the model
+// view matrix and one for the color.
+const int TEXELS_PER_GEOMETRY = 5;
+
+// The coarsest level of detail is drawn whose lines are at most this many pixels long on screen on
+// average.
+const double LOD_LINE_PIXELS = 16.0;
+
+} // namespace
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+const char* LineRenderer::SHADER_VERT = R"(
+#version 330
+
+layout(location=0) in vec3 iPositionHigh;
+layout(location=1) in vec3 iPositionLow;
+layout(location=2) in int  iGeometry;
+
+out vec4 vPosition;
+flat out vec4 vColor;
+
+uniform samplerBuffer uGeometries;
+uniform mat4 uMatProjection;
+
+void main()
+{
+    int  i     = iGeometry * 5;
+    mat4 matMV = mat4(texelFetch(uGeometries, i), texelFetch(uGeometries, i + 1),
+                      texelFetch(uGeometries, i + 2), texelFetch(uGeometries, i + 3));
+
+    vPosition   = matMV * vec4(iPositionHigh, 1.0);
+    vPosition  += matMV * vec4(iPositionLow, 0.0);
+    vColor      = texelFetch(uGeometries, i + 4);
+    gl_Position = uMatProjection * vPosition;
+}
+)";
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+const char* LineRenderer::SHADER_FRAG = R"(
+#version 330
+
+in vec4 vPosition;
+flat in vec4 vColor;
+
+uniform float uFarClip;
+
+layout(location = 0) out vec4 oColor;
+
+void main()
+{
+    oColor = vColor;
+    gl_FragDepth = length(vPosition.xyz) / uFarClip;
+}
+)";
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+LineRenderer::Geometry::Geometry(GLenum mode, float lineWidth, bool depthTest)
+    : mMode(mode)
+    , mLineWidth(lineWidth)
+    , mDepthTest(depthTest) {
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void LineRenderer::Geometry::setPositions(std::vector<glm::dvec3> const& positions) {
+  if (!mLevels.empty()) {
+    mIndices.clear();
+    mLevels.clear();
+    mIndicesDirty = true;
+  }
+
+  assignVertices(positions);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void LineRenderer::Geometry::setLevels(std::vector<Level> const& levels) {
+  std::vector<glm::dvec3> positions;
+  std::vector<uint32_t>   indices;
+  std::vector<LevelRange> ranges;
+
+  // All levels are stored one after another, the indices are offset accordingly.
+  for (auto const& level : levels) {
+    auto   offset = static_cast<uint32_t>(positions.size());
+    double length = 0.0;
+
+    for (size_t i = 0; i + 1 < level.mIndices.size(); i += 2) {
+      length += glm::length(
+          level.mPositions[level.mIndices[i + 1]] - level.mPositions[level.mIndices[i]]);
+    }
+
+    ranges.push_back({static_cast<GLsizei>(indices.size()),
+        static_cast<GLsizei>(level.mIndices.size()),
+        level.mIndices.empty() ? 0.0 : 2.0 * length / level.mIndices.size()});
+
+    positions.insert(positions.end(), level.mPositions.begin(), level.mPositions.end());
+
+    for (auto index : level.mIndices) {
+      indices.push_back(offset + index);
+    }
+  }
+
+  // If only the positions changed, for example because of a new height scale, the vertices are
+  // updated in place.
+  if (indices != mIndices) {
+    mIndices.swap(indices);
+    mIndicesDirty = true;
+  }
+
+  mLevels.swap(ranges);
+  assignVertices(positions);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void LineRenderer::Geometry::setMinScreenSize(float pixels) {
+  mMinScreenSize = pixels;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void LineRenderer::Geometry::assignVertices(std::vector<glm::dvec3> const& positions) {
+  mAnchor = glm::dvec3(0.0);
+
+  for (auto const& p : positions) {
+    mAnchor += p;
+  }
+
+  if (!positions.empty()) {
+    mAnchor /= static_cast<double>(positions.size());
+  }
+
+  mVertices.resize(positions.size());
+  mRadius = 0.0;
+
+  for (size_t i = 0; i < positions.size(); ++i) {
+    glm::dvec3 relative = positions[i] - mAnchor;
+    mVertices[i].mHigh  = relative;
+    mVertices[i].mLow   = relative - glm::dvec3(mVertices[i].mHigh);
+    mRadius             = std::max(mRadius, glm::length(relative));
+  }
+
+  mDirty      = true;
+  mDirtyBegin = 0;
+  mDirtyEnd   = mVertices.size();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void LineRenderer::Geometry::updatePositions(
+    std::vector<glm::dvec3> const& positions, size_t begin, size_t end) {
+  if (positions.size() != mVertices.size()) {
+    setPositions(positions);
+    return;
+  }
+
+  // The anchor is kept, so that the other vertices stay valid.
+  for (size_t i = begin; i < end; ++i) {
+    glm::dvec3 relative = positions[i] - mAnchor;
+    mVertices[i].mHigh  = relative;
+    mVertices[i].mLow   = relative - glm::dvec3(mVertices[i].mHigh);
+    mRadius             = std::max(mRadius, glm::length(relative));
+  }
+
+  if (mDirty) {
+    mDirtyBegin = std::min(mDirtyBegin, begin);
+    mDirtyEnd   = std::max(mDirtyEnd, end);
+  } else {
+    mDirty      = true;
+    mDirtyBegin = begin;
+    mDirtyEnd   = end;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void LineRenderer::Geometry::setFrame(std::string const& center, std::string const& frame) {
+  mCenter = center;
+  mFrame  = frame;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void LineRenderer::Geometry::setColor(glm::vec4 const& color) {
+  mColor = color;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void LineRenderer::Geometry::setVisible(bool visible) {
+  mVisible = visible;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+LineRenderer::LineRenderer(std::shared_ptr<cs::core::SolarSystem> pSolarSystem,
+    std::shared_ptr<cs::core::TimeControl>                        pTimeControl)
+    : mSolarSystem(std::move(pSolarSystem))
+    , mTimeControl(std::move(pTimeControl)) {
+
+  mShader.InitVertexShaderFromString(SHADER_VERT);
+  mShader.InitFragmentShaderFromString(SHADER_FRAG);
+  mShader.Link();
+
+  mGeometriesLocation = mShader.GetUniformLocation("uGeometries");
+  mMatPLocation       = mShader.GetUniformLocation("uMatProjection");
+  mFarClipLocation    = mShader.GetUniformLocation("uFarClip");
+
+  mVAO.EnableAttributeArray(0);
+  mVAO.SpecifyAttributeArrayFloat(
+      0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), offsetof(Vertex, mHigh), &mVBO);
+
+  mVAO.EnableAttributeArray(1);
+  mVAO.SpecifyAttributeArrayFloat(
+      1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), offsetof(Vertex, mLow), &mVBO);
+
+  mVAO.EnableAttributeArray(2);
+  mVAO.SpecifyAttributeArrayInteger(
+      2, 1, GL_INT, sizeof(Vertex), offsetof(Vertex, mGeometry), &mVBO);
+
+  mVAO.SpecifyIndexBufferObject(&mIBO, GL_UNSIGNED_INT);
+
+  // The buffer object is only created by its first binding. It needs a data store before it can
+  // be attached to the texture, the data of the geometries is uploaded each frame.
+  mGeometryBuffer.Bind(GL_TEXTURE_BUFFER);
+  mGeometryBuffer.BufferData(TEXELS_PER_GEOMETRY * sizeof(glm::vec4), nullptr, GL_STREAM_DRAW);
+  mGeometryBuffer.Release();
+
+  glGenTextures(1, &mGeometryTexture);
+  glBindTexture(GL_TEXTURE_BUFFER, mGeometryTexture);
+  glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, mGeometryBuffer.GetId());
+  glBindTexture(GL_TEXTURE_BUFFER, 0);
+
+  // All line vertices are drawn relative to the observer, therefore we do not want any
+  // transformation.
+  auto* pSG = GetVistaSystem()->GetGraphicsManager()->GetSceneGraph();
+  mOpenGLNode.reset(pSG->NewOpenGLNode(pSG->GetRoot(), this));
+
+  VistaOpenSGMaterialTools::SetSortKeyOnSubtree(
+      mOpenGLNode.get(), static_cast<int>(cs::utils::DrawOrder::eOpaqueNonHDR));
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+LineRenderer::~LineRenderer() {
+  auto* pSG = GetVistaSystem()->GetGraphicsManager()->GetSceneGraph();
+  pSG->GetRoot()->DisconnectChild(mOpenGLNode.get());
+
+  glDeleteTextures(1, &mGeometryTexture);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+std::shared_ptr<LineRenderer::Geometry> LineRenderer::createGeometry(
+    GLenum mode, float lineWidth, bool depthTest) {
+  std::shared_ptr<Geometry> geometry(new Geometry(mode, lineWidth, depthTest));
+  mGeometries.push_back(geometry);
+  mLayoutDirty = true;
+  return geometry;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void LineRenderer::updateVertexBuffer() {
+  // Removed geometries and geometries whose number of vertices changed require a new layout of the
+  // whole buffer.
+  for (auto it = mGeometries.begin(); it != mGeometries.end();) {
+    auto geometry = it->lock();
+
+    if (!geometry) {
+      it           = mGeometries.erase(it);
+      mLayoutDirty = true;
+    } else {
+      mLayoutDirty |= (geometry->mDirty &&
+                          static_cast<GLsizei>(geometry->mVertices.size()) != geometry->mCount) ||
+                      geometry->mIndicesDirty;
+      ++it;
+    }
+  }
+
+  if (mLayoutDirty) {
+    std::stable_sort(mGeometries.begin(), mGeometries.end(), [](auto const& a, auto const& b) {
+      auto ga = a.lock();
+      auto gb = b.lock();
+      return std::make_tuple(!ga->mDepthTest, ga->mMode, ga->mLineWidth) <
+             std::make_tuple(!gb->mDepthTest, gb->mMode, gb->mLineWidth);
+    });
+
+    mVertices.clear();
+    mIndices.clear();
+
+    for (size_t i = 0; i < mGeometries.size(); ++i) {
+      auto geometry           = mGeometries[i].lock();
+      geometry->mFirst        = static_cast<GLint>(mVertices.size());
+      geometry->mCount        = static_cast<GLsizei>(geometry->mVertices.size());
+      geometry->mFirstIndex   = static_cast<GLint>(mIndices.size());
+      geometry->mDirty        = false;
+      geometry->mIndicesDirty = false;
+
+      for (auto const& v : geometry->mVertices) {
+        mVertices.push_back({v.mHigh, v.mLow, static_cast<int32_t>(i)});
+      }
+
+      // The indices stay relative to the geometry, the first vertex is given as base vertex.
+      mIndices.insert(mIndices.end(), geometry->mIndices.begin(), geometry->mIndices.end());
+    }
+
+    mVBO.Bind(GL_ARRAY_BUFFER);
+    mVBO.BufferData(mVertices.size() * sizeof(Vertex), mVertices.data(), GL_STATIC_DRAW);
+    mVBO.Release();
+
+    mIBO.Bind(GL_ELEMENT_ARRAY_BUFFER);
+    mIBO.BufferData(mIndices.size() * sizeof(uint32_t), mIndices.data(), GL_STATIC_DRAW);
+    mIBO.Release();
+
+    mStatistics.add(Statistics::Counter::eUploadBytes,
+        mVertices.size() * sizeof(Vertex) + mIndices.size() * sizeof(uint32_t));
+
+    mLayoutDirty = false;
+    return;
+  }
+
+  // Geometries which kept their number of vertices are updated in place, only their dirty range
+  // is uploaded.
+  for (size_t i = 0; i < mGeometries.size(); ++i) {
+    auto geometry = mGeometries[i].lock();
+
+    if (!geometry->mDirty) {
+      continue;
+    }
+
+    mVertices.clear();
+
+    for (size_t v = geometry->mDirtyBegin; v < geometry->mDirtyEnd; ++v) {
+      auto const& vertex = geometry->mVertices[v];
+      mVertices.push_back({vertex.mHigh, vertex.mLow, static_cast<int32_t>(i)});
+    }
+
+    mVBO.Bind(GL_ARRAY_BUFFER);
+    mVBO.BufferSubData((geometry->mFirst + geometry->mDirtyBegin) * sizeof(Vertex),
+        mVertices.size() * sizeof(Vertex), mVertices.data());
+    mVBO.Release();
+
+    mStatistics.add(Statistics::Counter::eUploadBytes, mVertices.size() * sizeof(Vertex));
+
+    geometry->mDirty = false;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void LineRenderer::updateGeometryBuffer(glm::dmat4 const& modelView, double pixelScale) {
+  auto        time     = mTimeControl->pSimulationTime.get();
+  auto const& observer = mSolarSystem->getObserver();
+
+  // Most tools share the same few SPICE frames, so their transformations are computed only once.
+  mFrameTransforms.clear();
+  mGeometryData.resize(mGeometries.size() * TEXELS_PER_GEOMETRY);
+
+  for (size_t i = 0; i < mGeometries.size(); ++i) {
+    auto geometry = mGeometries[i].lock();
+
+    auto transform = std::find_if(mFrameTransforms.begin(), mFrameTransforms.end(),
+        [&geometry](FrameTransform const& t) {
+          return t.mCenter == geometry->mCenter && t.mFrame == geometry->mFrame;
+        });
+
+    if (transform == mFrameTransforms.end()) {
+      cs::scene::CelestialAnchor anchor(geometry->mCenter, geometry->mFrame);
+      mFrameTransforms.push_back({geometry->mCenter, geometry->mFrame,
+          modelView * observer.getRelativeTransform(time, anchor)});
+      transform = mFrameTransforms.end() - 1;
+    }
+
+    glm::dmat4 matMV(transform->mTransform * glm::translate(glm::dmat4(1.0), geometry->mAnchor));
+
+    geometry->mDrawLevel = selectLevel(*geometry, matMV, pixelScale);
+
+    for (int c = 0; c < 4; ++c) {
+      mGeometryData[i * TEXELS_PER_GEOMETRY + c] = matMV[c];
+    }
+
+    mGeometryData[i * TEXELS_PER_GEOMETRY + 4] = geometry->mColor;
+  }
+
+  mGeometryBuffer.Bind(GL_TEXTURE_BUFFER);
+  mGeometryBuffer.BufferData(
+      mGeometryData.size() * sizeof(glm::vec4), mGeometryData.data(), GL_STREAM_DRAW);
+  mGeometryBuffer.Release();
+
+  mStatistics.add(Statistics::Counter::eUploadBytes, mGeometryData.size() * sizeof(glm::vec4));
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int LineRenderer::selectLevel(
+    Geometry const& geometry, glm::dmat4 const& modelView, double pixelScale) {
+  if (geometry.mMinScreenSize <= 0.F && geometry.mLevels.empty()) {
+    return 0;
+  }
+
+  // The size of one unit of the geometry in pixels, at the point of its bounding sphere which is
+  // closest to the observer.
+  double scale    = glm::length(glm::dvec3(modelView[0]));
+  double distance = glm::length(glm::dvec3(modelView[3])) - geometry.mRadius * scale;
+
+  if (distance <= 0.0) {
+    return std::max(static_cast<int>(geometry.mLevels.size()) - 1, 0);
+  }
+
+  double pixelsPerUnit = scale * pixelScale / distance;
+
+  if (2.0 * geometry.mRadius * pixelsPerUnit < geometry.mMinScreenSize) {
+    return -1;
+  }
+
+  for (size_t i = 0; i + 1 < geometry.mLevels.size(); ++i) {
+    if (geometry.mLevels[i].mLineLength * pixelsPerUnit <= LOD_LINE_PIXELS) {
+      return static_cast<int>(i);
+    }
+  }
+
+  return std::max(static_cast<int>(geometry.mLevels.size()) - 1, 0);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool LineRenderer::Do() {
+  {
+    Statistics::ScopedTimer timer(mStatistics, Statistics::Stage::eUpload);
+    updateVertexBuffer();
+  }
+
+  if (mGeometries.empty()) {
+    return true;
+  }
+
+  std::array<GLfloat, 16> glMatMV{};
+  std::array<GLfloat, 16> glMatP{};
+  std::array<GLint, 4>    glViewport{};
+  glGetFloatv(GL_MODELVIEW_MATRIX, glMatMV.data());
+  glGetFloatv(GL_PROJECTION_MATRIX, glMatP.data());
+  glGetIntegerv(GL_VIEWPORT, glViewport.data());
+
+  // The second diagonal element of the projection is the cotangent of half the vertical field of
+  // view.
+  double pixelScale = 0.5 * glMatP[5] * glViewport[3];
+
+  {
+    Statistics::ScopedTimer timer(mStatistics, Statistics::Stage::eUpload);
+    updateGeometryBuffer(glm::dmat4(glm::make_mat4x4(glMatMV.data())), pixelScale);
+  }
+
+  glPushAttrib(GL_ENABLE_BIT | GL_COLOR_BUFFER_BIT | GL_LINE_BIT);
+
+  // Enables alpha blending for smooth lines
+  glEnable(GL_BLEND);
+  glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+  // Enables and configures line rendering
+  glEnable(GL_LINE_SMOOTH);
+  glHint(GL_LINE_SMOOTH_HINT, GL_NICEST);
+
+  mShader.Bind();
+  mVAO.Bind();
+
+  glActiveTexture(GL_TEXTURE0);
+  glBindTexture(GL_TEXTURE_BUFFER, mGeometryTexture);
+
+  mShader.SetUniform(mGeometriesLocation, 0);
+  mShader.SetUniform(mFarClipLocation, cs::utils::getCurrentFarClipDistance());
+  glUniformMatrix4fv(mMatPLocation, 1, GL_FALSE, glMatP.data());
+
+  // The geometries are sorted by their draw state, all visible geometries of a run with the same
+  // state are drawn with one call.
+  for (size_t begin = 0; begin < mGeometries.size();) {
+    auto first = mGeometries[begin].lock();
+    auto end   = begin;
+
+    mFirsts.clear();
+    mCounts.clear();
+    mIndexCounts.clear();
+    mIndexOffsets.clear();
+    mBaseVertices.clear();
+
+    for (; end < mGeometries.size(); ++end) {
+      auto geometry = mGeometries[end].lock();
+
+      if (geometry->mDepthTest != first->mDepthTest || geometry->mMode != first->mMode ||
+          geometry->mLineWidth != first->mLineWidth) {
+        break;
+      }
+
+      if (!geometry->mVisible || geometry->mCount == 0 || geometry->mDrawLevel < 0) {
+        continue;
+      }
+
+      if (geometry->mLevels.empty()) {
+        mFirsts.push_back(geometry->mFirst);
+        mCounts.push_back(geometry->mCount);
+      } else {
+        auto const& level = geometry->mLevels[geometry->mDrawLevel];
+        auto        index = geometry->mFirstIndex + level.mFirstIndex;
+
+        mIndexCounts.push_back(level.mIndexCount);
+        mIndexOffsets.push_back(reinterpret_cast<const void*>(index * sizeof(uint32_t)));
+        mBaseVertices.push_back(geometry->mFirst);
+      }
+    }
+
+    if (!mFirsts.empty() || !mIndexCounts.empty()) {
+      if (first->mDepthTest) {
+        glEnable(GL_DEPTH_TEST);
+      } else {
+        glDisable(GL_DEPTH_TEST);
+      }
+
+      glLineWidth(first->mLineWidth);
+    }
+
+    if (!mFirsts.empty()) {
+      glMultiDrawArrays(first->mMode, mFirsts.data(), mCounts.data(),
+          static_cast<GLsizei>(mFirsts.size()));
+    }
+
+    if (!mIndexCounts.empty()) {
+      glMultiDrawElementsBaseVertex(first->mMode, mIndexCounts.data(), GL_UNSIGNED_INT,
+          mIndexOffsets.data(), static_cast<GLsizei>(mIndexCounts.size()), mBaseVertices.data());
+    }
+
+    begin = end;
+  }
+
+  glBindTexture(GL_TEXTURE_BUFFER, 0);
+
+  mVAO.Release();
+  mShader.Release();
+
+  glPopAttrib();
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool LineRenderer::GetBoundingBox(VistaBoundingBox& bb) {
+  std::array fMin{-0.1F, -0.1F, -0.1F};
+  std::array fMax{0.1F, 0.1F, 0.1F};
+
+  bb.SetBounds(fMin.data(), fMax.data());
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+Statistics const& LineRenderer::getStatistics() const {
+  return mStatistics;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void LineRenderer::resetStatistics() {
+  mStatistics.reset();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+} // namespace csp::measurementtools
@@ -0,0 +1,220 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//                               This file is part of CosmoScout VR                               //
+//      and may be used under the terms of the MIT license. See the LICENSE file for details.     //
+//                        Copyright: (c) 2019 German Aerospace Center (DLR)                       //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef CSP_MEASUREMENT_TOOLS_LINE_RENDERER_HPP
+#define CSP_MEASUREMENT_TOOLS_LINE_RENDERER_HPP
+
+#include "Statistics.hpp"
+
+#include <VistaKernel/GraphicsManager/VistaOpenGLDraw.h>
+#include <VistaOGLExt/VistaBufferObject.h>
+#include <VistaOGLExt/VistaGLSLShader.h>
+#include <VistaOGLExt/VistaVertexArrayObject.h>
+
+#include <glm/glm.hpp>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace cs::core {
+class SolarSystem;
+class TimeControl;
+} // namespace cs::core
+
+class VistaOpenGLNode;
+
+namespace csp::measurementtools {
+
+/// Draws the lines of all measurement tools with one shader program and one OpenGL node. The
+/// vertices of all tools are packed into a single buffer, which is only updated when a tool's
+/// vertices change. Each frame, the model view matrix and the color of every tool are written to a
+/// texture buffer and all tools which share the same draw state are drawn with one
+/// glMultiDrawArrays call.
+///
+/// The positions of a tool are stored relative to their center, each one split into a high and a
+/// low float part. The model view matrix is computed for this center in double precision, so that
+/// no precision is lost although the shader works with floats only.
+///
+/// Geometries may also consist of several indexed levels of detail. Each frame, one of them is
+/// selected depending on the size of the geometry on screen.
+class LineRenderer : public IVistaOpenGLDraw {
+ public:
+  /// The lines of a single tool. The renderer only keeps a weak reference to it, the lines are
+  /// removed once the tool releases its shared pointer.
+  class Geometry {
+   public:
+    /// One level of detail: positions and pairs of indices into them.
+    struct Level {
+      std::vector<glm::dvec3> mPositions;
+      std::vector<uint32_t>   mIndices;
+    };
+
+    /// Replaces the vertices. They are given in the coordinate system of the SPICE frame which is
+    /// set with setFrame().
+    void setPositions(std::vector<glm::dvec3> const& positions);
+
+    /// Replaces only the vertices in [begin, end) with the same range of the given positions. The
+    /// number of positions must not have changed since the last call to setPositions(). Only the
+    /// changed range is uploaded to the GPU.
+    void updatePositions(std::vector<glm::dvec3> const& positions, size_t begin, size_t end);
+
+    /// Replaces the vertices with several levels of detail, sorted from coarse to fine. Each frame
+    /// only the coarsest level is drawn whose lines are only a few pixels long on screen on
+    /// average. This should be used with GL_LINES only.
+    void setLevels(std::vector<Level> const& levels);
+
+    /// The geometry is not drawn if its extent on screen is smaller than this many pixels.
+    void setMinScreenSize(float pixels);
+
+    void setFrame(std::string const& center, std::string const& frame);
+    void setColor(glm::vec4 const& color);
+    void setVisible(bool visible);
+
+   private:
+    friend class LineRenderer;
+
+    struct Vertex {
+      glm::vec3 mHigh;
+      glm::vec3 mLow;
+    };
+
+    // The range of a level of detail in mIndices and the average length of its lines.
+    struct LevelRange {
+      GLsizei mFirstIndex;
+      GLsizei mIndexCount;
+      double  mLineLength;
+    };
+
+    Geometry(GLenum mode, float lineWidth, bool depthTest);
+
+    /// Computes the anchor and the relative vertices.
+    void assignVertices(std::vector<glm::dvec3> const& positions);
+
+    GLenum mMode;
+    float  mLineWidth;
+    bool   mDepthTest;
+
+    std::string         mCenter;
+    std::string         mFrame;
+    glm::dvec3          mAnchor = glm::dvec3(0.0);
+    std::vector<Vertex> mVertices;
+    glm::vec4           mColor   = glm::vec4(1.F);
+    bool                mVisible = true;
+
+    // The distance of the farthest vertex from the anchor.
+    double mRadius        = 0.0;
+    float  mMinScreenSize = 0.F;
+
+    // The indices are relative to the first vertex of this geometry. They are empty if the
+    // geometry has no levels of detail.
+    std::vector<uint32_t>   mIndices;
+    std::vector<LevelRange> mLevels;
+    bool                    mIndicesDirty = false;
+
+    // The range of vertices which has to be uploaded.
+    bool   mDirty      = true;
+    size_t mDirtyBegin = 0;
+    size_t mDirtyEnd   = 0;
+
+    // The position of the vertices and indices in the packed buffers.
+    GLint   mFirst      = 0;
+    GLsizei mCount      = 0;
+    GLint   mFirstIndex = 0;
+
+    // The level of detail which is drawn in this frame, -1 if the geometry is too small.
+    int mDrawLevel = 0;
+  };
+
+  LineRenderer(std::shared_ptr<cs::core::SolarSystem> pSolarSystem,
+      std::shared_ptr<cs::core::TimeControl>          pTimeControl);
+
+  LineRenderer(LineRenderer const& other) = delete;
+  LineRenderer(LineRenderer&& other)      = delete;
+
+  LineRenderer& operator=(LineRenderer const& other) = delete;
+  LineRenderer& operator=(LineRenderer&& other) = delete;
+
+  ~LineRenderer() override;
+
+  /// Creates new lines which are drawn as the given primitive type (GL_LINE_STRIP or GL_LINES).
+  /// Lines which do not use the depth test are drawn after all other lines.
+  std::shared_ptr<Geometry> createGeometry(GLenum mode, float lineWidth, bool depthTest = true);
+
+  /// Inherited from IVistaOpenGLDraw.
+  bool Do() override;
+  bool GetBoundingBox(VistaBoundingBox& bb) override;
+
+  /// The time spent on updating the buffer objects in Do() and the number of uploaded bytes since
+  /// the last call to resetStatistics(). The Plugin reads and resets these once per frame.
+  Statistics const& getStatistics() const;
+  void              resetStatistics();
+
+ private:
+  struct Vertex {
+    glm::vec3 mHigh;
+    glm::vec3 mLow;
+    int32_t   mGeometry;
+  };
+
+  /// Removes expired geometries and updates the vertex buffer, if any geometry changed.
+  void updateVertexBuffer();
+
+  /// Writes the model view matrices and colors of all geometries to the texture buffer and selects
+  /// their levels of detail. pixelScale is the size in pixels of an object of unit size at unit
+  /// distance.
+  void updateGeometryBuffer(glm::dmat4 const& modelView, double pixelScale);
+
+  /// Returns the level of detail of the geometry for the given model view matrix or -1 if the
+  /// geometry is smaller than its minimum screen size.
+  static int selectLevel(Geometry const& geometry, glm::dmat4 const& modelView, double pixelScale);
+
+  std::shared_ptr<cs::core::SolarSystem> mSolarSystem;
+  std::shared_ptr<cs::core::TimeControl> mTimeControl;
+
+  std::unique_ptr<VistaOpenGLNode> mOpenGLNode;
+
+  // Sorted by their draw state, so that consecutive geometries can be drawn with one call.
+  std::vector<std::weak_ptr<Geometry>> mGeometries;
+  bool                                 mLayoutDirty = false;
+
+  VistaGLSLShader        mShader;
+  VistaVertexArrayObject mVAO;
+  VistaBufferObject      mVBO;
+  VistaBufferObject      mIBO;
+  VistaBufferObject      mGeometryBuffer;
+  GLuint                 mGeometryTexture = 0;
+
+  int mGeometriesLocation = -1;
+  int mMatPLocation       = -1;
+  int mFarClipLocation    = -1;
+
+  // The transformations of the SPICE frames which are used in the current frame.
+  struct FrameTransform {
+    std::string mCenter;
+    std::string mFrame;
+    glm::dmat4  mTransform;
+  };
+
+  // These are reused each frame to avoid allocations.
+  std::vector<FrameTransform> mFrameTransforms;
+  std::vector<glm::vec4>      mGeometryData;
+  std::vector<Vertex>         mVertices;
+  std::vector<uint32_t>       mIndices;
+  std::vector<GLint>          mFirsts;
+  std::vector<GLsizei>        mCounts;
+  std::vector<GLsizei>        mIndexCounts;
+  std::vector<const void*>    mIndexOffsets;
+  std::vector<GLint>          mBaseVertices;
+
+  Statistics mStatistics;
+
+  static const char* SHADER_VERT;
+  static const char* SHADER_FRAG;
+};
+
+} // namespace csp::measurementtools
+
+#endif // CSP_MEASUREMENT_TOOLS_LINE_RENDERER_HPP
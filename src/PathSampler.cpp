@@ -0,0 +1,216 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//                               This file is part of CosmoScout VR                               //
+//      and may be used under the terms of the MIT license. See the LICENSE file for details.     //
+//                        Copyright: (c) 2019 German Aerospace Center (DLR)                       //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "PathSampler.hpp"
+
+#include "../../../src/cs-utils/convert.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <utility>
+
+namespace csp::measurementtools {
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+const int PathSampler::ADAPTIVE_INITIAL_SAMPLES = 8;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+PathSampler::PathSampler(double radius, HeightCache::HeightSource heightSource, int numSamples,
+    float tolerance, HeightCache::BatchHeightSource batchSource)
+    : mRadius(radius)
+    , mHeightSource(std::move(heightSource))
+    , mBatchSource(std::move(batchSource))
+    , mNumSamples(numSamples)
+    , mTolerance(tolerance) {
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void PathSampler::sampleSegment(
+    glm::dvec2 const& start, glm::dvec2 const& end, Segment& segment) const {
+
+  glm::dvec3 p0 = cs::utils::convert::toCartesian(start, mRadius, mRadius, 0.0);
+  glm::dvec3 p1 = cs::utils::convert::toCartesian(end, mRadius, mRadius, 0.0);
+
+  // Queries the heights at the given positions along the segment in one batch.
+  std::vector<glm::dvec3> positions;
+  std::vector<glm::dvec2> lngLats;
+  std::vector<double>     heights;
+
+  auto queryHeights = [&](std::vector<double> const& ts, std::vector<double>& result) {
+    positions.resize(ts.size());
+    for (size_t i = 0; i < ts.size(); ++i) {
+      positions[i] = p0 + ts[i] * (p1 - p0);
+    }
+
+    projection::toLngLat(positions, lngLats);
+    requestHeights(lngLats, result);
+  };
+
+  std::vector<double> ts;
+
+  if (mTolerance <= 0.F) {
+    ts.resize(mNumSamples);
+    for (int i = 0; i < mNumSamples; ++i) {
+      ts[i] = i / static_cast<double>(mNumSamples);
+    }
+
+    queryHeights(ts, heights);
+
+  } else {
+    // The segment starts with a few uniform intervals. Each interval whose midpoint deviates more
+    // than mTolerance from the linear elevation profile is split in two, until the intervals
+    // reach the resolution of mNumSamples per segment. All midpoints of one level of the
+    // subdivision are queried at once.
+    int initialCount = std::min(mNumSamples, ADAPTIVE_INITIAL_SAMPLES);
+
+    ts.resize(initialCount + 1);
+    for (int i = 0; i <= initialCount; ++i) {
+      ts[i] = i / static_cast<double>(initialCount);
+    }
+
+    queryHeights(ts, heights);
+
+    std::vector<std::pair<size_t, size_t>> intervals;
+    for (size_t i = 0; i + 1 < ts.size(); ++i) {
+      intervals.emplace_back(i, i + 1);
+    }
+
+    double              minLength = 1.0 / mNumSamples;
+    std::vector<double> midTs;
+    std::vector<double> midHeights;
+
+    while (!intervals.empty()) {
+      std::vector<std::pair<size_t, size_t>> refined;
+      midTs.clear();
+
+      for (auto const& [a, b] : intervals) {
+        if (ts[b] - ts[a] > minLength * 1.5) {
+          midTs.push_back(0.5 * (ts[a] + ts[b]));
+          refined.emplace_back(a, b);
+        }
+      }
+
+      if (midTs.empty()) {
+        break;
+      }
+
+      queryHeights(midTs, midHeights);
+      intervals.clear();
+
+      for (size_t i = 0; i < refined.size(); ++i) {
+        auto [a, b]  = refined[i];
+        size_t m     = ts.size();
+        double error = std::abs(midHeights[i] - 0.5 * (heights[a] + heights[b]));
+
+        ts.push_back(midTs[i]);
+        heights.push_back(midHeights[i]);
+
+        if (error > mTolerance) {
+          intervals.emplace_back(a, m);
+          intervals.emplace_back(m, b);
+        }
+      }
+    }
+
+    // Sorts the samples along the segment. The end point is omitted, as it is the first sample of
+    // the next segment.
+    std::vector<size_t> order(ts.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&ts](size_t a, size_t b) { return ts[a] < ts[b]; });
+    order.pop_back();
+
+    std::vector<double> sortedTs(order.size());
+    std::vector<double> sortedHeights(order.size());
+    for (size_t i = 0; i < order.size(); ++i) {
+      sortedTs[i]      = ts[order[i]];
+      sortedHeights[i] = heights[order[i]];
+    }
+
+    ts.swap(sortedTs);
+    heights.swap(sortedHeights);
+
+    positions.resize(ts.size());
+    for (size_t i = 0; i < ts.size(); ++i) {
+      positions[i] = p0 + ts[i] * (p1 - p0);
+    }
+
+    projection::toLngLat(positions, lngLats);
+  }
+
+  projection::toSurfaceSamples(lngLats, heights, segment.mSamples);
+
+  // The distances are measured without the height scale
+  projection::toCartesian(mRadius, segment.mSamples, 1.0, positions);
+
+  segment.mDistances.resize(positions.size());
+  for (size_t i = 0; i < positions.size(); ++i) {
+    segment.mDistances[i] =
+        i == 0 ? 0.0 : segment.mDistances[i - 1] + glm::length(positions[i] - positions[i - 1]);
+  }
+
+  if (!positions.empty()) {
+    segment.mFirstNorm = positions.front();
+    segment.mLastNorm  = positions.back();
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+std::vector<glm::dvec2> PathSampler::getProfile(std::vector<glm::dvec2> const& points) const {
+  std::vector<glm::dvec2> profile;
+
+  Segment previous;
+  Segment current;
+  double  distance = 0.0;
+
+  for (size_t s = 0; s + 1 < points.size(); ++s) {
+    sampleSegment(points[s], points[s + 1], current);
+
+    if (s > 0 && !previous.mDistances.empty()) {
+      distance +=
+          previous.mDistances.back() + glm::length(current.mFirstNorm - previous.mLastNorm);
+    }
+
+    for (size_t i = 0; i < current.mSamples.size(); ++i) {
+      profile.emplace_back(distance + current.mDistances[i], current.mSamples.mHeights[i]);
+    }
+
+    std::swap(previous, current);
+  }
+
+  if (!previous.mDistances.empty()) {
+    std::vector<double> heights;
+    requestHeights({points.back()}, heights);
+
+    double     height = heights[0];
+    glm::dvec3 last   = cs::utils::convert::toCartesian(points.back(), mRadius, mRadius, height);
+
+    distance += previous.mDistances.back() + glm::length(last - previous.mLastNorm);
+    profile.emplace_back(distance, height);
+  }
+
+  return profile;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void PathSampler::requestHeights(
+    std::vector<glm::dvec2> const& lngLats, std::vector<double>& heights) const {
+  if (mBatchSource) {
+    heights.resize(lngLats.size());
+    mBatchSource(lngLats, heights);
+  } else {
+    projection::queryHeights(mHeightSource, lngLats, heights);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+} // namespace csp::measurementtools
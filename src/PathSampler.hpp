@@ -0,0 +1,73 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//                               This file is part of CosmoScout VR                               //
+//      and may be used under the terms of the MIT license. See the LICENSE file for details.     //
+//                        Copyright: (c) 2019 German Aerospace Center (DLR)                       //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef CSP_MEASUREMENT_TOOLS_PATH_SAMPLER_HPP
+#define CSP_MEASUREMENT_TOOLS_PATH_SAMPLER_HPP
+
+#include "HeightCache.hpp"
+#include "SurfaceProjection.hpp"
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+namespace csp::measurementtools {
+
+/// Samples the segments of a path on the terrain and measures the distances along them. The
+/// samples are interpolated between the surface points of a segment's end points and projected
+/// to the terrain afterwards, hence they do not depend on the height scale. The PathTool uses this
+/// for its line and elevation profile; as no scene graph is involved, it can be used on a worker
+/// thread as well.
+class PathSampler {
+ public:
+  /// The samples between two points of a path.
+  struct Segment {
+    projection::SurfaceSamples mSamples;
+
+    /// The distance of each sample from the start of the segment, without the height scale.
+    std::vector<double> mDistances;
+
+    /// The first and last sample without the height scale, to measure the gaps between segments.
+    glm::dvec3 mFirstNorm = glm::dvec3(0.0);
+    glm::dvec3 mLastNorm  = glm::dvec3(0.0);
+  };
+
+  /// Without a tolerance, numSamples samples are created per segment. If the tolerance is larger
+  /// than zero, the segments are only subdivided where the terrain deviates more than the
+  /// tolerance (in meters) from the linear elevation profile between the samples; numSamples then
+  /// is the maximum resolution. The height sources have to be safe to call from the thread the
+  /// sampler is used on. If a batch source is given, it is used for all queries, so that the
+  /// samples of one subdivision level need only one request.
+  PathSampler(double radius, HeightCache::HeightSource heightSource, int numSamples,
+      float tolerance, HeightCache::BatchHeightSource batchSource = {});
+
+  /// Samples the segment between the two lng/lat coordinates (in radians). The end point is not
+  /// included, as it is the first sample of the next segment. All samples of one subdivision level
+  /// are projected to the surface in one batch.
+  void sampleSegment(glm::dvec2 const& start, glm::dvec2 const& end, Segment& segment) const;
+
+  /// Samples all segments between the given lng/lat coordinates and returns the elevation profile
+  /// (distance along the path, height) of the whole path. Other than the profile of the PathTool,
+  /// this includes the last point, so the last distance is the length of the path.
+  std::vector<glm::dvec2> getProfile(std::vector<glm::dvec2> const& points) const;
+
+ private:
+  /// Queries the heights at the given lng/lat coordinates from the batch source if there is one,
+  /// or from the single-point source otherwise.
+  void requestHeights(std::vector<glm::dvec2> const& lngLats, std::vector<double>& heights) const;
+
+  double                         mRadius;
+  HeightCache::HeightSource      mHeightSource;
+  HeightCache::BatchHeightSource mBatchSource;
+  int                            mNumSamples;
+  float                          mTolerance;
+
+  static const int ADAPTIVE_INITIAL_SAMPLES;
+};
+
+} // namespace csp::measurementtools
+
+#endif // CSP_MEASUREMENT_TOOLS_PATH_SAMPLER_HPP
@@ -6,7 +6,6 @@
 
 #include "PathTool.hpp"
 
-#include "../../../src/cs-core/GuiManager.hpp"
 #include "../../../src/cs-core/InputManager.hpp"
 #include "../../../src/cs-core/Settings.hpp"
 #include "../../../src/cs-core/SolarSystem.hpp"
@@ -16,75 +15,64 @@
 #include "../../../src/cs-utils/convert.hpp"
 #include "../../../src/cs-utils/utils.hpp"
 
-#include <VistaKernel/GraphicsManager/VistaOpenGLNode.h>
 #include <VistaKernel/GraphicsManager/VistaSceneGraph.h>
 #include <VistaKernel/VistaSystem.h>
-#include <VistaKernelOpenSGExt/VistaOpenSGMaterialTools.h>
+
+#include <algorithm>
+#include <limits>
 
 namespace csp::measurementtools {
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
-const char* PathTool::SHADER_VERT = R"(
-#version 330
-
-layout(location=0) in vec3 iPosition;
-
-out vec4 vPosition;
+const int PathTool::PROFILE_RESOLUTION = 500;
 
-uniform mat4 uMatModelView;
-uniform mat4 uMatProjection;
+////////////////////////////////////////////////////////////////////////////////////////////////////
 
-void main()
-{
-    vPosition   = uMatModelView * vec4(iPosition, 1.0);
-    gl_Position = uMatProjection * vPosition;
-}
-)";
+namespace {
 
-////////////////////////////////////////////////////////////////////////////////////////////////////
+std::string encodeBase64(std::vector<float> const& values) {
+  static const char* chars = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
 
-const char* PathTool::SHADER_FRAG = R"(
-#version 330
+  auto const* bytes = reinterpret_cast<unsigned char const*>(values.data());
+  size_t      size  = values.size() * sizeof(float);
 
-in vec4 vPosition;
+  std::string result;
+  result.reserve((size + 2) / 3 * 4);
 
-uniform vec3 uColor;
-uniform float uFarClip;
+  for (size_t i = 0; i < size; i += 3) {
+    uint32_t triple = bytes[i] << 16U;
+    triple |= (i + 1 < size ? bytes[i + 1] : 0U) << 8U;
+    triple |= (i + 2 < size ? bytes[i + 2] : 0U);
 
-layout(location = 0) out vec4 oColor;
+    result.push_back(chars[(triple >> 18U) & 63U]);
+    result.push_back(chars[(triple >> 12U) & 63U]);
+    result.push_back(i + 1 < size ? chars[(triple >> 6U) & 63U] : '=');
+    result.push_back(i + 2 < size ? chars[triple & 63U] : '=');
+  }
 
-void main()
-{
-    oColor = vec4(uColor, 1.0);
-    gl_FragDepth = length(vPosition.xyz) / uFarClip;
+  return result;
 }
-)";
+
+} // namespace
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 PathTool::PathTool(std::shared_ptr<cs::core::InputManager> const& pInputManager,
     std::shared_ptr<cs::core::SolarSystem> const&                 pSolarSystem,
     std::shared_ptr<cs::core::Settings> const&                    settings,
-    std::shared_ptr<cs::core::TimeControl> const& pTimeControl, std::string const& sCenter,
+    std::shared_ptr<cs::core::TimeControl> const&                 pTimeControl,
+    std::shared_ptr<LineRenderer> const& pLineRenderer, std::string const& sCenter,
     std::string const& sFrame)
     : MultiPointTool(pInputManager, pSolarSystem, settings, pTimeControl, sCenter, sFrame)
-    , mGuiArea(std::make_unique<cs::gui::WorldSpaceGuiArea>(760, 475))
-    , mGuiItem(std::make_unique<cs::gui::GuiItem>("file://../share/resources/gui/path.html")) {
+    , mLines(pLineRenderer->createGeometry(GL_LINE_STRIP, 5.F)) {
 
-  // create the shader
-  mShader.InitVertexShaderFromString(SHADER_VERT);
-  mShader.InitFragmentShaderFromString(SHADER_FRAG);
-  mShader.Link();
+  // the line is drawn by the plugin's line renderer together with all other tools
+  mLines->setFrame(sCenter, sFrame);
+  pColor.connectAndTouch(
+      [this](glm::vec3 const& color) { mLines->setColor(glm::vec4(color, 1.F)); });
 
-  // attach this as OpenGLNode to scenegraph's root (all line vertices
-  // will be draw relative to the observer, therfore we do not want
-  // any transformation)
   auto* pSG = GetVistaSystem()->GetGraphicsManager()->GetSceneGraph();
-  mPathOpenGLNode.reset(pSG->NewOpenGLNode(pSG->GetRoot(), this));
-
-  VistaOpenSGMaterialTools::SetSortKeyOnSubtree(
-      mPathOpenGLNode.get(), static_cast<int>(cs::utils::DrawOrder::eOpaqueNonHDR));
 
   // create a a CelestialAnchorNode for the user interface
   // it will be moved to the center of all points when a point is moved
@@ -94,44 +82,30 @@ PathTool::PathTool(std::shared_ptr<cs::core::InputManager> const& pInputManager,
   mGuiAnchor->setAnchorScale(mSolarSystem->getObserver().getAnchorScale());
   mSolarSystem->registerAnchor(mGuiAnchor);
 
-  // create the user interface
-  mGuiTransform.reset(pSG->NewTransformNode(mGuiAnchor.get()));
-  mGuiTransform->Translate(0.F, 0.9F, 0.F);
-  mGuiTransform->Scale(0.001F * static_cast<float>(mGuiArea->getWidth()),
-      0.001F * static_cast<float>(mGuiArea->getHeight()), 1.F);
-  mGuiTransform->Rotate(VistaAxisAndAngle(VistaVector3D(0.0, 1.0, 0.0), -glm::pi<float>() / 2.F));
-  mGuiArea->addItem(mGuiItem.get());
-  mGuiArea->setUseLinearDepthBuffer(true);
-  mGuiOpenGLNode.reset(pSG->NewOpenGLNode(mGuiTransform.get(), mGuiArea.get()));
-
-  mInputManager->registerSelectable(mGuiOpenGLNode.get());
+  // create the user interface, its web view is only created when the tool is close to the
+  // observer
+  mGui = std::make_unique<ToolGui>(mInputManager, mGuiAnchor,
+      "file://../share/resources/gui/path.html", 760, 475, glm::vec3(0.F, 0.9F, 0.F));
 
-  mGuiItem->setCanScroll(false);
-  mGuiItem->waitForFinishedLoading();
-
-  mGuiItem->registerCallback("deleteMe", "Call this to delete the tool.",
+  mGui->registerCallback("deleteMe", "Call this to delete the tool.",
       std::function([this]() { pShouldDelete = true; }));
 
-  mGuiItem->registerCallback("setAddPointMode", "Call this to enable creation of new points.",
+  mGui->registerCallback("setAddPointMode", "Call this to enable creation of new points.",
       std::function([this](bool enable) {
         addPoint();
         pAddPointMode = enable;
       }));
 
-  mGuiItem->setCursorChangeCallback([](cs::gui::Cursor c) { cs::core::GuiManager::setCursor(c); });
-
-  VistaOpenSGMaterialTools::SetSortKeyOnSubtree(
-      mGuiAnchor.get(), static_cast<int>(cs::utils::DrawOrder::eTransparentItems));
-
-  // whenever the height scale changes our vertex positions need to be updated
+  // whenever the height scale changes our vertex positions need to be updated. The cached
+  // samples do not depend on the height scale, so the terrain is not sampled again.
   mScaleConnection = mSettings->mGraphics.pHeightScale.connectAndTouch(
       [this](float /*h*/) { mVerticesDirty = true; });
 
   // Update text.
   mTextConnection = pText.connectAndTouch(
-      [this](std::string const& value) { mGuiItem->callJavascript("setText", value); });
+      [this](std::string const& value) { mGui->callJavascript("setText", value); });
 
-  mGuiItem->registerCallback("onSetText",
+  mGui->registerCallback("onSetText",
       "This is called whenever the text input of the tool's name changes.",
       std::function(
           [this](std::string&& value) { pText.setWithEmitForAllButOne(value, mTextConnection); }));
@@ -141,11 +115,6 @@ PathTool::PathTool(std::shared_ptr<cs::core::InputManager> const& pInputManager,
 
 PathTool::~PathTool() {
   mSettings->mGraphics.pHeightScale.disconnect(mScaleConnection);
-  mGuiItem->unregisterCallback("deleteMe");
-  mGuiItem->unregisterCallback("setAddPointMode");
-  mGuiItem->unregisterCallback("onSetText");
-
-  mInputManager->unregisterSelectable(mGuiOpenGLNode.get());
   mSolarSystem->unregisterAnchor(mGuiAnchor);
 }
 
@@ -154,6 +123,10 @@ PathTool::~PathTool() {
 void PathTool::setCenterName(std::string const& name) {
   cs::core::tools::MultiPointTool::setCenterName(name);
   mGuiAnchor->setCenterName(name);
+  mLines->setFrame(getCenterName(), getFrameName());
+
+  // the cached samples were taken on the old body
+  mSegments.clear();
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -161,6 +134,7 @@ void PathTool::setCenterName(std::string const& name) {
 void PathTool::setFrameName(std::string const& name) {
   cs::core::tools::MultiPointTool::setFrameName(name);
   mGuiAnchor->setFrameName(name);
+  mLines->setFrame(getCenterName(), getFrameName());
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -169,37 +143,68 @@ void PathTool::setNumSamples(int const& numSamples) {
   if (mNumSamples != numSamples) {
     mNumSamples    = numSamples;
     mVerticesDirty = true;
+    mSegments.clear();
   }
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
-glm::dvec4 PathTool::getInterpolatedPosBetweenTwoMarks(cs::core::tools::DeletableMark const& l0,
-    cs::core::tools::DeletableMark const& l1, double value, double const& scale) {
+void PathTool::setTolerance(float tolerance) {
+  if (mTolerance != tolerance) {
+    mTolerance     = tolerance;
+    mVerticesDirty = true;
+    mSegments.clear();
+  }
+}
 
-  glm::dvec3 radii = cs::core::SolarSystem::getRadii(getCenterName());
+////////////////////////////////////////////////////////////////////////////////////////////////////
 
-  auto body = mSolarSystem->getBody(getCenterName());
+std::string PathTool::encodeProfile(std::vector<glm::dvec2> const& profile) {
+  std::vector<float> values;
 
-  if (!body) {
-    return glm::dvec4(0.0);
+  if (profile.empty()) {
+    return encodeBase64(values);
   }
 
-  // Calculate the position for the new segment anchor
-  double h0 = body->getHeight(l0.pLngLat.get()) * scale;
-  double h1 = body->getHeight(l1.pLngLat.get()) * scale;
+  // The chart cannot show more than one value per pixel. Therefore the samples are binned by
+  // distance and only the lowest and the highest sample of each bin are kept, in their original
+  // order, so that no peak gets lost.
+  double length = profile.back().x - profile.front().x;
 
-  // Get cartesian coordinates for interpolation
-  glm::dvec3 p0 = cs::utils::convert::toCartesian(l0.pLngLat.get(), radii[0], radii[0], h0);
-  glm::dvec3 p1 = cs::utils::convert::toCartesian(l1.pLngLat.get(), radii[0], radii[0], h1);
-  glm::dvec3 interpolatedPos = p0 + (value * (p1 - p0));
+  auto addSample = [&values](glm::dvec2 const& sample) {
+    values.push_back(static_cast<float>(sample.x));
+    values.push_back(static_cast<float>(sample.y));
+  };
 
-  // Calc final position
-  glm::dvec2 ll     = cs::utils::convert::toLngLatHeight(interpolatedPos, radii[0], radii[0]).xy();
-  double     height = body->getHeight(ll) * scale;
-  glm::dvec3 pos    = cs::utils::convert::toCartesian(ll, radii[0], radii[0], height);
+  size_t binStart = 0;
+  int    bin      = 0;
 
-  return glm::dvec4(pos, height);
+  auto addBin = [&](size_t end) {
+    auto [minIt, maxIt] = std::minmax_element(profile.begin() + binStart, profile.begin() + end,
+        [](glm::dvec2 const& a, glm::dvec2 const& b) { return a.y < b.y; });
+
+    addSample(*std::min(minIt, maxIt));
+
+    if (minIt != maxIt) {
+      addSample(*std::max(minIt, maxIt));
+    }
+  };
+
+  for (size_t i = 1; i < profile.size(); ++i) {
+    int sampleBin = length > 0.0 ? static_cast<int>((profile[i].x - profile.front().x) / length *
+                                                    (PROFILE_RESOLUTION - 1))
+                                 : 0;
+
+    if (sampleBin != bin) {
+      addBin(i);
+      binStart = i;
+      bin      = sampleBin;
+    }
+  }
+
+  addBin(profile.size());
+
+  return encodeBase64(values);
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -227,8 +232,7 @@ void PathTool::updateLineVertices() {
     return;
   }
 
-  // Fill the vertex buffer with sampled data
-  mSampledPositions.clear();
+  Statistics::ScopedTimer timer(mStatistics, Statistics::Stage::eLineVertices);
 
   auto body = mSolarSystem->getBody(getCenterName());
 
@@ -253,140 +257,167 @@ void PathTool::updateLineVertices() {
                          mTimeControl->pSimulationTime.get(), *mGuiAnchor));
   }
 
+  // Segments whose marks did not move are taken from the cache. As points may have been inserted
+  // or removed, the neighbors of a segment's old position are searched as well.
+  std::vector<Segment> segments;
+  segments.reserve(mPoints.size() - 1);
+
   auto lastMark = mPoints.begin();
   auto currMark = ++mPoints.begin();
 
-  std::stringstream json;
-  std::string       jsonSeperator;
-  double            distance = -1;
-  glm::dvec3        lastPos(0.0);
+  bool resampled = mSegments.size() != mPoints.size() - 1;
+
+  PathSampler sampler(
+      radii[0],
+      [this, body](glm::dvec2 const& lngLat) {
+        mStatistics.add(Statistics::Counter::eHeightQueries, 1);
+        return body ? body->getHeight(lngLat) : 0.0;
+      },
+      mNumSamples, mTolerance);
 
   while (currMark != mPoints.end()) {
-    // generate X points for each line segment
-    for (int vertex_id = 0; vertex_id < mNumSamples; vertex_id++) {
-      glm::dvec4 pos = getInterpolatedPosBetweenTwoMarks(
-          **lastMark, **currMark, (vertex_id / static_cast<double>(mNumSamples)), h_scale);
-      mSampledPositions.push_back(pos.xyz());
-
-      // coordinate normalized by height scale; to count distance correctly
-      glm::dvec4 posNorm = pos;
-      if (h_scale != 1) {
-        posNorm = getInterpolatedPosBetweenTwoMarks(
-            **lastMark, **currMark, (vertex_id / static_cast<double>(mNumSamples)), 1);
-      }
+    glm::dvec2 start = (*lastMark)->pLngLat.get();
+    glm::dvec2 end   = (*currMark)->pLngLat.get();
+    size_t     index = segments.size();
+
+    Segment* cached = nullptr;
 
-      if (distance < 0) {
-        distance = 0;
-      } else {
-        distance += glm::length(posNorm.xyz() - lastPos);
+    for (size_t i = (index > 0 ? index - 1 : 0); i <= index + 1 && i < mSegments.size(); ++i) {
+      if (!mSegments[i].mSamples.empty() && mSegments[i].mStart == start &&
+          mSegments[i].mEnd == end) {
+        cached = &mSegments[i];
+        break;
       }
+    }
+
+    if (cached) {
+      segments.push_back(std::move(*cached));
+    } else {
+      Segment segment;
+      segment.mStart = start;
+      segment.mEnd   = end;
 
-      json << jsonSeperator << "[" << distance << "," << pos.w / h_scale << "]";
-      jsonSeperator = ",";
+      sampler.sampleSegment(start, end, segment);
+      segment.mOffset = std::numeric_limits<size_t>::max();
 
-      lastPos = posNorm.xyz();
+      segments.push_back(std::move(segment));
+      resampled = true;
     }
 
     lastMark = currMark;
     ++currMark;
   }
 
-  mGuiItem->callJavascript("setData", "[" + json.str() + "]");
+  // Assembles the vertices and the elevation profile. Only the range of vertices which changed is
+  // uploaded, if the number of vertices stayed the same. If the height scale changed, all
+  // vertices are rebuilt from the cached samples.
+  size_t oldCount     = mSampledPositions.size();
+  size_t changedBegin = std::numeric_limits<size_t>::max();
+  size_t changedEnd   = 0;
+  bool   rescaled     = h_scale != mSampledHeightScale;
 
-  mIndexCount = mSampledPositions.size();
+  // Fill the vertex buffer with sampled data
+  mSampledPositions.clear();
+  mSampledHeightScale = h_scale;
 
-  // Upload new data
-  mVBO.Bind(GL_ARRAY_BUFFER);
-  mVBO.BufferData(mSampledPositions.size() * sizeof(glm::vec3), nullptr, GL_DYNAMIC_DRAW);
-  mVBO.Release();
+  std::vector<glm::dvec2> profile;
+  std::vector<glm::dvec3> positions;
+  double                  distance = 0.0;
 
-  mVAO.EnableAttributeArray(0);
-  mVAO.SpecifyAttributeArrayFloat(0, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), 0, &mVBO);
-}
+  for (size_t s = 0; s < segments.size(); ++s) {
+    auto& segment = segments[s];
 
-////////////////////////////////////////////////////////////////////////////////////////////////////
+    if (s > 0) {
+      distance += segments[s - 1].mDistances.back() +
+                  glm::length(segment.mFirstNorm - segments[s - 1].mLastNorm);
+    }
 
-void PathTool::update() {
-  MultiPointTool::update();
+    if (rescaled || segment.mOffset != mSampledPositions.size()) {
+      segment.mOffset = mSampledPositions.size();
+      changedBegin    = std::min(changedBegin, segment.mOffset);
+      changedEnd      = segment.mOffset + segment.mSamples.size();
+    }
+
+    projection::toCartesian(radii[0], segment.mSamples, h_scale, positions);
+    mSampledPositions.insert(mSampledPositions.end(), positions.begin(), positions.end());
 
-  if (mVerticesDirty) {
-    updateLineVertices();
-    mVerticesDirty = false;
+    if (resampled) {
+      for (size_t i = 0; i < segment.mSamples.size(); ++i) {
+        profile.emplace_back(distance + segment.mDistances[i], segment.mSamples.mHeights[i]);
+      }
+    }
   }
 
-  double simulationTime(mTimeControl->pSimulationTime.get());
+  mSegments.swap(segments);
 
-  cs::core::SolarSystem::scaleRelativeToObserver(*mGuiAnchor, mSolarSystem->getObserver(),
-      simulationTime, pScaleDistance.get(), mSettings->mGraphics.pWidgetScale.get());
-  cs::core::SolarSystem::turnToObserver(
-      *mGuiAnchor, mSolarSystem->getObserver(), simulationTime, false);
+  // The elevation profile does not depend on the height scale
+  if (resampled) {
+    mGui->callJavascript("setData", encodeProfile(profile));
+  }
+
+  // Upload new data, it stays on the GPU until the points change again
+  if (mSampledPositions.size() != oldCount) {
+    mLines->setPositions(mSampledPositions);
+  } else if (changedBegin < changedEnd) {
+    mLines->updatePositions(mSampledPositions, changedBegin, changedEnd);
+  }
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
-bool PathTool::Do() {
-  // transform all high precision sample points to observer centric
-  // low precision coordinates
-  std::vector<glm::vec3> vRelativePositions(mIndexCount);
-
-  auto        time     = mTimeControl->pSimulationTime.get();
-  auto const& observer = mSolarSystem->getObserver();
+bool PathTool::hasPendingUpdate() const {
+  return mVerticesDirty;
+}
 
-  cs::scene::CelestialAnchor centerAnchor(getCenterName(), getFrameName());
-  auto                       mat = observer.getRelativeTransform(time, centerAnchor);
+////////////////////////////////////////////////////////////////////////////////////////////////////
 
-  for (size_t i(0); i < mIndexCount; ++i) {
-    vRelativePositions[i] = (mat * glm::dvec4(mSampledPositions[i], 1.0)).xyz();
+double PathTool::getUpdatePriority() const {
+  if (mPoints.empty()) {
+    return 0.0;
   }
 
-  // upload the new points to the GPU
-  mVBO.Bind(GL_ARRAY_BUFFER);
-  mVBO.BufferSubData(0, vRelativePositions.size() * sizeof(glm::vec3), vRelativePositions.data());
-  mVBO.Release();
+  bool edited = pAddPointMode.get() || UpdateScheduler::isEdited(mPoints);
 
-  glPushAttrib(GL_ENABLE_BIT | GL_COLOR_BUFFER_BIT | GL_LINE_BIT);
+  return UpdateScheduler::getPriority(mSolarSystem->getObserver(),
+      mTimeControl->pSimulationTime.get(), *mPoints.front()->getAnchor(), edited);
+}
 
-  // enable alpha blending for smooth line
-  glEnable(GL_BLEND);
-  glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+////////////////////////////////////////////////////////////////////////////////////////////////////
 
-  // enable and configure line rendering
-  glEnable(GL_LINE_SMOOTH);
-  glHint(GL_LINE_SMOOTH_HINT, GL_NICEST);
-  glLineWidth(5);
+void PathTool::processPendingUpdate() {
+  updateLineVertices();
+  mVerticesDirty = false;
+}
 
-  std::array<GLfloat, 16> glMatMV{};
-  std::array<GLfloat, 16> glMatP{};
-  glGetFloatv(GL_MODELVIEW_MATRIX, glMatMV.data());
-  glGetFloatv(GL_PROJECTION_MATRIX, glMatP.data());
+////////////////////////////////////////////////////////////////////////////////////////////////////
 
-  mShader.Bind();
-  mVAO.Bind();
-  glUniformMatrix4fv(mShader.GetUniformLocation("uMatModelView"), 1, GL_FALSE, glMatMV.data());
-  glUniformMatrix4fv(mShader.GetUniformLocation("uMatProjection"), 1, GL_FALSE, glMatP.data());
+void PathTool::update() {
+  MultiPointTool::update();
 
-  mShader.SetUniform(
-      mShader.GetUniformLocation("uColor"), pColor.get().r, pColor.get().g, pColor.get().b);
-  mShader.SetUniform(
-      mShader.GetUniformLocation("uFarClip"), cs::utils::getCurrentFarClipDistance());
+  double simulationTime(mTimeControl->pSimulationTime.get());
 
-  // draw the linestrip
-  glDrawArrays(GL_LINE_STRIP, 0, static_cast<GLsizei>(mIndexCount));
-  mVAO.Release();
-  mShader.Release();
+  cs::core::SolarSystem::scaleRelativeToObserver(*mGuiAnchor, mSolarSystem->getObserver(),
+      simulationTime, pScaleDistance.get(), mSettings->mGraphics.pWidgetScale.get());
+  cs::core::SolarSystem::turnToObserver(
+      *mGuiAnchor, mSolarSystem->getObserver(), simulationTime, false);
+}
 
-  glPopAttrib();
-  return true;
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+ToolGui& PathTool::getGui() {
+  return *mGui;
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
-bool PathTool::GetBoundingBox(VistaBoundingBox& bb) {
-  std::array fMin{-0.1F, -0.1F, -0.1F};
-  std::array fMax{0.1F, 0.1F, 0.1F};
+Statistics const& PathTool::getStatistics() const {
+  return mStatistics;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
 
-  bb.SetBounds(fMin.data(), fMax.data());
-  return true;
+void PathTool::resetStatistics() {
+  mStatistics.reset();
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
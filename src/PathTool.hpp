@@ -8,8 +8,11 @@
 #define CSP_MEASUREMENT_TOOLS_PATH_HPP
 
 #include "../../../src/cs-core/tools/MultiPointTool.hpp"
-
-#include <VistaKernel/GraphicsManager/VistaOpenGLDraw.h>
+#include "LineRenderer.hpp"
+#include "PathSampler.hpp"
+#include "Statistics.hpp"
+#include "ToolGui.hpp"
+#include "UpdateScheduler.hpp"
 
 #include <glm/glm.hpp>
 #include <vector>
@@ -18,21 +21,10 @@ namespace cs::scene {
 class CelestialAnchorNode;
 }
 
-namespace cs::gui {
-class GuiItem;
-class WorldSpaceGuiArea;
-} // namespace cs::gui
-
-class VistaBufferObject;
-class VistaGLSLShader;
-class VistaOpenGLNode;
-class VistaVertexArrayObject;
-class VistaTransformNode;
-
 namespace csp::measurementtools {
 
 /// The path tool is used to measure the distance and height along a path of lines.
-class PathTool : public IVistaOpenGLDraw, public cs::core::tools::MultiPointTool {
+class PathTool : public cs::core::tools::MultiPointTool, public UpdateScheduler::Client {
  public:
   /// This text is shown on the ui and can be edited by the user.
   cs::utils::Property<std::string> pText = std::string("Path");
@@ -40,7 +32,8 @@ class PathTool : public IVistaOpenGLDraw, public cs::core::tools::MultiPointTool
   PathTool(std::shared_ptr<cs::core::InputManager> const& pInputManager,
       std::shared_ptr<cs::core::SolarSystem> const&       pSolarSystem,
       std::shared_ptr<cs::core::Settings> const&          settings,
-      std::shared_ptr<cs::core::TimeControl> const& pTimeControl, std::string const& sCenter,
+      std::shared_ptr<cs::core::TimeControl> const&       pTimeControl,
+      std::shared_ptr<LineRenderer> const& pLineRenderer, std::string const& sCenter,
       std::string const& sFrame);
 
   PathTool(PathTool const& other) = delete;
@@ -60,19 +53,33 @@ class PathTool : public IVistaOpenGLDraw, public cs::core::tools::MultiPointTool
   /// Called from Tools class.
   void update() override;
 
-  /// Inherited from IVistaOpenGLDraw.
-  bool Do() override;
-  bool GetBoundingBox(VistaBoundingBox& bb) override;
+  /// These are called by the UpdateScheduler. The terrain is only sampled in
+  /// processPendingUpdate().
+  bool   hasPendingUpdate() const override;
+  double getUpdatePriority() const override;
+  void   processPendingUpdate() override;
+
+  /// The web view of the tool is only created when the tool is close to the observer.
+  ToolGui& getGui();
+
+  /// The time spent on sampling the path and the number of terrain queries since the last call to
+  /// resetStatistics(). The Plugin reads and resets these once per frame.
+  Statistics const& getStatistics() const;
+  void              resetStatistics();
 
   void setNumSamples(int const& numSamples);
 
+  /// If the tolerance is larger than zero, the segments are sampled adaptively. They are only
+  /// subdivided where the terrain deviates more than the tolerance (in meters) from the linear
+  /// elevation profile between the samples. The number of samples then is the maximum resolution.
+  void setTolerance(float tolerance);
+
  private:
   void updateLineVertices();
 
-  /// Returns the interpolated position in cartesian coordinates. The fourth component is height
-  /// above the surface.
-  glm::dvec4 getInterpolatedPosBetweenTwoMarks(cs::core::tools::DeletableMark const& l0,
-      cs::core::tools::DeletableMark const& l1, double value, double const& scale);
+  /// Reduces the elevation profile (distance, height) to the resolution of the chart and encodes
+  /// it as base64 string of a Float32Array with alternating distances and heights.
+  static std::string encodeProfile(std::vector<glm::dvec2> const& profile);
 
   /// These are called by the base class MultiPointTool.
   void onPointMoved() override;
@@ -80,27 +87,33 @@ class PathTool : public IVistaOpenGLDraw, public cs::core::tools::MultiPointTool
   void onPointRemoved(int index) override;
 
   std::shared_ptr<cs::scene::CelestialAnchorNode> mGuiAnchor;
+  std::unique_ptr<ToolGui>                        mGui;
 
-  std::unique_ptr<VistaTransformNode>         mGuiTransform;
-  std::unique_ptr<VistaOpenGLNode>            mGuiOpenGLNode;
-  std::unique_ptr<VistaOpenGLNode>            mPathOpenGLNode;
-  std::unique_ptr<cs::gui::WorldSpaceGuiArea> mGuiArea;
-  std::unique_ptr<cs::gui::GuiItem>           mGuiItem;
+  std::shared_ptr<LineRenderer::Geometry> mLines;
 
-  VistaVertexArrayObject mVAO;
-  VistaBufferObject      mVBO;
-  VistaGLSLShader        mShader;
+  // The samples between two marks. They are reused as long as both marks stay where they are.
+  // They do not depend on the height scale.
+  struct Segment : PathSampler::Segment {
+    glm::dvec2 mStart;
+    glm::dvec2 mEnd;
 
+    // The index of the first sample in mSampledPositions.
+    size_t mOffset = 0;
+  };
+
+  std::vector<Segment>    mSegments;
   std::vector<glm::dvec3> mSampledPositions;
-  size_t                  mIndexCount    = 0;
-  bool                    mVerticesDirty = false;
+  double                  mSampledHeightScale = 1.0;
+  bool                    mVerticesDirty      = false;
+
+  Statistics mStatistics;
 
-  int mScaleConnection = -1;
-  int mTextConnection  = -1;
-  int mNumSamples      = 256;
+  int   mScaleConnection = -1;
+  int   mTextConnection  = -1;
+  int   mNumSamples      = 256;
+  float mTolerance       = 0.F;
 
-  static const char* SHADER_VERT;
-  static const char* SHADER_FRAG;
+  static const int PROFILE_RESOLUTION;
 };
 
 } // namespace csp::measurementtools
@@ -0,0 +1,196 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//                               This file is part of CosmoScout VR                               //
+//      and may be used under the terms of the MIT license. See the LICENSE file for details.     //
+//                        Copyright: (c) 2019 German Aerospace Center (DLR)                       //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "PlaneFit.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace csp::measurementtools {
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+const int    PlaneFit::MAX_JACOBI_SWEEPS   = 16;
+const double PlaneFit::COLLINEAR_THRESHOLD = 1e-12;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+PlaneFit::PlaneFit(glm::dvec3 const& reference)
+    : mReference(reference) {
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void PlaneFit::reset(glm::dvec3 const& reference) {
+  mReference = reference;
+  mCount     = 0;
+  mSum       = glm::dvec3(0.0);
+  mSquares   = glm::dmat3(0.0);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void PlaneFit::add(glm::dvec3 const& point) {
+  glm::dvec3 p = point - mReference;
+
+  ++mCount;
+  mSum += p;
+
+  for (int i = 0; i < 3; ++i) {
+    for (int j = 0; j < 3; ++j) {
+      mSquares[i][j] += p[i] * p[j];
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void PlaneFit::remove(glm::dvec3 const& point) {
+  glm::dvec3 p = point - mReference;
+
+  --mCount;
+  mSum -= p;
+
+  for (int i = 0; i < 3; ++i) {
+    for (int j = 0; j < 3; ++j) {
+      mSquares[i][j] -= p[i] * p[j];
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+size_t PlaneFit::getCount() const {
+  return mCount;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+glm::dvec3 PlaneFit::getCenter() const {
+  if (mCount == 0) {
+    return mReference;
+  }
+
+  return mReference + mSum / static_cast<double>(mCount);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool PlaneFit::solve(glm::dvec3 const& up, Plane& plane) const {
+  if (mCount < 3) {
+    return false;
+  }
+
+  auto       count = static_cast<double>(mCount);
+  glm::dvec3 mean  = mSum / count;
+  glm::dmat3 covariance(0.0);
+
+  for (int i = 0; i < 3; ++i) {
+    for (int j = 0; j < 3; ++j) {
+      covariance[i][j] = mSquares[i][j] / count - mean[i] * mean[j];
+    }
+  }
+
+  glm::dvec3 eigenvalues;
+  glm::dmat3 eigenvectors;
+  decomposeSymmetric(covariance, eigenvalues, eigenvectors);
+
+  int smallest = 0;
+  int largest  = 0;
+
+  for (int i = 1; i < 3; ++i) {
+    if (eigenvalues[i] < eigenvalues[smallest]) {
+      smallest = i;
+    }
+    if (eigenvalues[i] > eigenvalues[largest]) {
+      largest = i;
+    }
+  }
+
+  // For points on a line, the two smallest eigenvalues vanish and the normal is undefined.
+  int    middle = 3 - smallest - largest;
+  double spread = eigenvalues[largest];
+
+  if (smallest == largest || spread <= 0.0 || eigenvalues[middle] <= COLLINEAR_THRESHOLD * spread) {
+    return false;
+  }
+
+  plane.mCenter   = mReference + mean;
+  plane.mNormal   = glm::normalize(eigenvectors[smallest]);
+  plane.mVariance = std::max(eigenvalues[smallest], 0.0);
+
+  if (glm::dot(plane.mNormal, up) < 0.0) {
+    plane.mNormal = -plane.mNormal;
+  }
+
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void PlaneFit::decomposeSymmetric(
+    glm::dmat3 const& matrix, glm::dvec3& eigenvalues, glm::dmat3& eigenvectors) {
+  glm::dmat3 a = matrix;
+  eigenvectors = glm::dmat3(1.0);
+
+  double norm = 0.0;
+  for (int i = 0; i < 3; ++i) {
+    for (int j = 0; j < 3; ++j) {
+      norm += a[i][j] * a[i][j];
+    }
+  }
+
+  // Each rotation eliminates one off-diagonal element. A few sweeps over all of them reduce the
+  // off-diagonal part below the precision of the diagonal.
+  for (int sweep = 0; sweep < MAX_JACOBI_SWEEPS; ++sweep) {
+    double offDiagonal = a[1][0] * a[1][0] + a[2][0] * a[2][0] + a[2][1] * a[2][1];
+
+    if (offDiagonal <= 1e-30 * norm) {
+      break;
+    }
+
+    for (int p = 0; p < 2; ++p) {
+      for (int q = p + 1; q < 3; ++q) {
+        if (a[q][p] == 0.0) {
+          continue;
+        }
+
+        // The rotation angle is chosen such that the element (p, q) becomes zero. The smaller of
+        // the two solutions keeps the rotation close to the identity.
+        double theta = (a[q][q] - a[p][p]) / (2.0 * a[q][p]);
+        double t = (theta >= 0.0 ? 1.0 : -1.0) / (std::abs(theta) + std::sqrt(theta * theta + 1.0));
+        double c = 1.0 / std::sqrt(t * t + 1.0);
+        double s = t * c;
+
+        glm::dvec3 columnP = a[p];
+        glm::dvec3 columnQ = a[q];
+        a[p]               = c * columnP - s * columnQ;
+        a[q]               = s * columnP + c * columnQ;
+
+        for (int k = 0; k < 3; ++k) {
+          double rowP = a[k][p];
+          double rowQ = a[k][q];
+          a[k][p]     = c * rowP - s * rowQ;
+          a[k][q]     = s * rowP + c * rowQ;
+        }
+
+        a[q][p] = 0.0;
+        a[p][q] = 0.0;
+
+        glm::dvec3 vectorP = eigenvectors[p];
+        glm::dvec3 vectorQ = eigenvectors[q];
+        eigenvectors[p]    = c * vectorP - s * vectorQ;
+        eigenvectors[q]    = s * vectorP + c * vectorQ;
+      }
+    }
+  }
+
+  eigenvalues = glm::dvec3(a[0][0], a[1][1], a[2][2]);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+} // namespace csp::measurementtools
@@ -0,0 +1,71 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//                               This file is part of CosmoScout VR                               //
+//      and may be used under the terms of the MIT license. See the LICENSE file for details.     //
+//                        Copyright: (c) 2019 German Aerospace Center (DLR)                       //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef CSP_MEASUREMENT_TOOLS_PLANE_FIT_HPP
+#define CSP_MEASUREMENT_TOOLS_PLANE_FIT_HPP
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+
+namespace csp::measurementtools {
+
+/// Fits the plane with the lowest sum of squared distances to a set of points. The points are not
+/// stored; only their count, their sum and the sum of their outer products are accumulated. Points
+/// can therefore be added and removed one at a time, so that a tool only has to update the points
+/// which moved. The sums are taken relative to a reference point close to the points, as cartesian
+/// coordinates on a planet are too large to square them without losing the terrain's detail.
+///
+/// The plane passes through the centroid and its normal is the eigenvector of the covariance
+/// matrix with the smallest eigenvalue. Other than solving the normal equations of z = ax + by + c,
+/// this does not depend on the orientation of the plane in the coordinate system.
+class PlaneFit {
+ public:
+  struct Plane {
+    glm::dvec3 mCenter = glm::dvec3(0.0);
+
+    /// Points to the same side as the up vector given to solve().
+    glm::dvec3 mNormal = glm::dvec3(0.0);
+
+    /// The mean squared distance of the points to the plane.
+    double mVariance = 0.0;
+  };
+
+  explicit PlaneFit(glm::dvec3 const& reference = glm::dvec3(0.0));
+
+  /// Removes all points. The reference should be one of the points which will be added next.
+  void reset(glm::dvec3 const& reference);
+
+  void add(glm::dvec3 const& point);
+
+  /// The point has to have been added before.
+  void remove(glm::dvec3 const& point);
+
+  size_t     getCount() const;
+  glm::dvec3 getCenter() const;
+
+  /// Returns false if there are less than three points or if they are (almost) collinear. The
+  /// plane is not modified then.
+  bool solve(glm::dvec3 const& up, Plane& plane) const;
+
+  /// Computes the eigenvalues and eigenvectors of a symmetric matrix with the cyclic Jacobi method.
+  /// The i-th column of eigenvectors belongs to the i-th eigenvalue; they are not sorted.
+  static void decomposeSymmetric(
+      glm::dmat3 const& matrix, glm::dvec3& eigenvalues, glm::dmat3& eigenvectors);
+
+ private:
+  glm::dvec3 mReference;
+  size_t     mCount = 0;
+  glm::dvec3 mSum   = glm::dvec3(0.0);
+  glm::dmat3 mSquares{0.0};
+
+  static const int    MAX_JACOBI_SWEEPS;
+  static const double COLLINEAR_THRESHOLD;
+};
+
+} // namespace csp::measurementtools
+
+#endif // CSP_MEASUREMENT_TOOLS_PLANE_FIT_HPP
@@ -15,10 +15,19 @@
 #include "../../../src/cs-utils/logger.hpp"
 #include "logger.hpp"
 
+#include "BatchMeasurement.hpp"
 #include "DipStrikeTool.hpp"
 #include "EllipseTool.hpp"
+#include "HeightProvider.hpp"
+#include "LineRenderer.hpp"
 #include "PathTool.hpp"
 #include "PolygonTool.hpp"
+#include "SurfaceProjection.hpp"
+#include "ThreadPool.hpp"
+#include "ToolGui.hpp"
+
+#include <algorithm>
+#include <fstream>
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
@@ -36,6 +45,13 @@ EXPORT_FN void destroy(cs::core::PluginBase* pluginBase) {
 
 namespace csp::measurementtools {
 
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+const double Plugin::STATISTICS_INTERVAL = 1.0;
+const double Plugin::HEIGHT_QUERY_BUDGET = 2.0;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
 namespace {
 // These are only used during settings loading, as they are required in the free from_json methods.
 // Loading never happens on multiple threads, so this is a save thing to do.
@@ -43,6 +59,9 @@ std::shared_ptr<cs::core::InputManager> sInputManager;
 std::shared_ptr<cs::core::SolarSystem>  sSolarSystem;
 std::shared_ptr<cs::core::Settings>     sSettings;
 std::shared_ptr<cs::core::TimeControl>  sTimeControl;
+std::shared_ptr<LineRenderer>           sLineRenderer;
+std::shared_ptr<ThreadPool>             sThreadPool;
+std::shared_ptr<HeightProvider>         sHeightProvider;
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
@@ -60,6 +79,46 @@ void updateTools(T& tools) {
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
+template <typename T>
+void addClients(T const& tools, std::vector<UpdateScheduler::Client*>& clients) {
+  for (auto const& tool : tools) {
+    clients.push_back(tool.get());
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+template <typename T>
+void addGuis(T const& tools, std::vector<ToolGui*>& guis) {
+  for (auto const& tool : tools) {
+    guis.push_back(&tool->getGui());
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// The milliseconds of each stage and all counters, for the statistics panel of the tab.
+nlohmann::json toJson(Statistics const& statistics) {
+  nlohmann::json stages   = nlohmann::json::object();
+  nlohmann::json counters = nlohmann::json::object();
+
+  for (size_t i(0); i < static_cast<size_t>(Statistics::Stage::eCount); ++i) {
+    auto stage = static_cast<Statistics::Stage>(i);
+    if (statistics.getCalls(stage) > 0) {
+      stages[Statistics::getName(stage)] = statistics.getTime(stage);
+    }
+  }
+
+  for (size_t i(0); i < static_cast<size_t>(Statistics::Counter::eCount); ++i) {
+    auto counter                           = static_cast<Statistics::Counter>(i);
+    counters[Statistics::getName(counter)] = statistics.get(counter);
+  }
+
+  return {{"stages", stages}, {"counters", counters}};
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
 template <typename T>
 void deserializeTools(nlohmann::json const& j, std::string const& name, T& tools) {
   auto array = j.find(name);
@@ -118,7 +177,8 @@ void to_json(nlohmann::json& j, std::shared_ptr<DipStrikeTool> const& o) {
 
 void from_json(nlohmann::json const& j, std::shared_ptr<EllipseTool>& o) {
   if (!o) {
-    o = std::make_shared<EllipseTool>(sInputManager, sSolarSystem, sSettings, sTimeControl, "", "");
+    o = std::make_shared<EllipseTool>(sInputManager, sSolarSystem, sSettings, sTimeControl,
+        sLineRenderer, sThreadPool, sHeightProvider, "", "");
   }
 
   std::string center;
@@ -184,7 +244,8 @@ void to_json(nlohmann::json& j, std::shared_ptr<FlagTool> const& o) {
 
 void from_json(nlohmann::json const& j, std::shared_ptr<PathTool>& o) {
   if (!o) {
-    o = std::make_shared<PathTool>(sInputManager, sSolarSystem, sSettings, sTimeControl, "", "");
+    o = std::make_shared<PathTool>(
+        sInputManager, sSolarSystem, sSettings, sTimeControl, sLineRenderer, "", "");
   }
 
   std::string center;
@@ -216,7 +277,8 @@ void to_json(nlohmann::json& j, std::shared_ptr<PathTool> const& o) {
 
 void from_json(nlohmann::json const& j, std::shared_ptr<PolygonTool>& o) {
   if (!o) {
-    o = std::make_shared<PolygonTool>(sInputManager, sSolarSystem, sSettings, sTimeControl, "", "");
+    o = std::make_shared<PolygonTool>(sInputManager, sSolarSystem, sSettings, sTimeControl,
+        sLineRenderer, sThreadPool, sHeightProvider, "", "");
   }
 
   std::string center;
@@ -231,6 +293,33 @@ void from_json(nlohmann::json const& j, std::shared_ptr<PolygonTool>& o) {
   cs::core::Settings::deserialize(j, "showMesh", o->pShowMesh);
   cs::core::Settings::deserialize(j, "text", o->pText);
 
+  // The result of the last session is used instead of a new calculation if its key still matches
+  auto result = j.find("result");
+  if (result != j.end()) {
+    uint64_t key = 0;
+
+    auto entry = std::make_shared<PolygonResultCache::Entry>();
+    cs::core::Settings::deserialize(*result, "key", key);
+    cs::core::Settings::deserialize(*result, "area", entry->mArea);
+    cs::core::Settings::deserialize(*result, "posVolume", entry->mPosVolume);
+    cs::core::Settings::deserialize(*result, "negVolume", entry->mNegVolume);
+
+    for (auto const& l : result->value("levels", nlohmann::json::array())) {
+      std::vector<glm::dvec2> lngLats;
+      std::vector<double>     heights;
+
+      PolygonCalculator::MeshLevel level;
+      cs::core::Settings::deserialize(l, "lngLats", lngLats);
+      cs::core::Settings::deserialize(l, "heights", heights);
+      cs::core::Settings::deserialize(l, "edges", level.mEdges);
+      projection::toSurfaceSamples(lngLats, heights, level.mVertices);
+
+      entry->mMesh.push_back(std::move(level));
+    }
+
+    o->addCachedResult(key, std::move(entry));
+  }
+
   std::vector<glm::dvec2> positions;
   cs::core::Settings::deserialize(j, "positions", positions);
   o->setPositions(positions);
@@ -244,6 +333,31 @@ void to_json(nlohmann::json& j, std::shared_ptr<PolygonTool> const& o) {
   cs::core::Settings::serialize(j, "showMesh", o->pShowMesh);
   cs::core::Settings::serialize(j, "text", o->pText);
   cs::core::Settings::serialize(j, "positions", o->getPositions());
+
+  // Each level of the mesh is stored as lng/lat and unscaled heights of its vertices
+  auto [key, result] = o->getCachedResult();
+  if (result) {
+    std::vector<nlohmann::json> levels;
+
+    for (auto const& level : result->mMesh) {
+      std::vector<glm::dvec2> lngLats;
+      projection::toLngLat(level.mVertices.mDirections, lngLats);
+
+      nlohmann::json l;
+      cs::core::Settings::serialize(l, "lngLats", lngLats);
+      cs::core::Settings::serialize(l, "heights", level.mVertices.mHeights);
+      cs::core::Settings::serialize(l, "edges", level.mEdges);
+      levels.push_back(std::move(l));
+    }
+
+    nlohmann::json r;
+    cs::core::Settings::serialize(r, "key", key);
+    cs::core::Settings::serialize(r, "area", result->mArea);
+    cs::core::Settings::serialize(r, "posVolume", result->mPosVolume);
+    cs::core::Settings::serialize(r, "negVolume", result->mNegVolume);
+    cs::core::Settings::serialize(r, "levels", levels);
+    cs::core::Settings::serialize(j, "result", r);
+  }
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -259,8 +373,21 @@ void from_json(nlohmann::json const& j, Plugin::Settings& o) {
   cs::core::Settings::deserialize(j, "polygonMaxAttempt", o.mPolygonMaxAttempt);
   cs::core::Settings::deserialize(j, "polygonMaxPoints", o.mPolygonMaxPoints);
   cs::core::Settings::deserialize(j, "polygonSleekness", o.mPolygonSleekness);
+  cs::core::Settings::deserialize(
+      j, "polygonIntersectionTolerance", o.mPolygonIntersectionTolerance);
+  cs::core::Settings::deserialize(
+      j, "polygonConvergenceThreshold", o.mPolygonConvergenceThreshold);
+  cs::core::Settings::deserialize(j, "polygonTileAngle", o.mPolygonTileAngle);
+  cs::core::Settings::deserialize(j, "terrainId", o.mTerrainId);
   cs::core::Settings::deserialize(j, "ellipseSamples", o.mEllipseSamples);
+  cs::core::Settings::deserialize(j, "ellipseInteriorSamples", o.mEllipseInteriorSamples);
   cs::core::Settings::deserialize(j, "pathSamples", o.mPathSamples);
+  cs::core::Settings::deserialize(j, "pathTolerance", o.mPathTolerance);
+  cs::core::Settings::deserialize(j, "dipStrikeSamples", o.mDipStrikeSamples);
+  cs::core::Settings::deserialize(j, "updateBudget", o.mUpdateBudget);
+  cs::core::Settings::deserialize(j, "guiDistance", o.mGuiDistance);
+  cs::core::Settings::deserialize(j, "guiPoolSize", o.mGuiPoolSize);
+  cs::core::Settings::deserialize(j, "showStatistics", o.mShowStatistics);
 }
 
 void to_json(nlohmann::json& j, Plugin::Settings const& o) {
@@ -273,8 +400,19 @@ void to_json(nlohmann::json& j, Plugin::Settings const& o) {
   cs::core::Settings::serialize(j, "polygonMaxAttempt", o.mPolygonMaxAttempt);
   cs::core::Settings::serialize(j, "polygonMaxPoints", o.mPolygonMaxPoints);
   cs::core::Settings::serialize(j, "polygonSleekness", o.mPolygonSleekness);
+  cs::core::Settings::serialize(j, "polygonIntersectionTolerance", o.mPolygonIntersectionTolerance);
+  cs::core::Settings::serialize(j, "polygonConvergenceThreshold", o.mPolygonConvergenceThreshold);
+  cs::core::Settings::serialize(j, "polygonTileAngle", o.mPolygonTileAngle);
+  cs::core::Settings::serialize(j, "terrainId", o.mTerrainId);
   cs::core::Settings::serialize(j, "ellipseSamples", o.mEllipseSamples);
+  cs::core::Settings::serialize(j, "ellipseInteriorSamples", o.mEllipseInteriorSamples);
   cs::core::Settings::serialize(j, "pathSamples", o.mPathSamples);
+  cs::core::Settings::serialize(j, "pathTolerance", o.mPathTolerance);
+  cs::core::Settings::serialize(j, "dipStrikeSamples", o.mDipStrikeSamples);
+  cs::core::Settings::serialize(j, "updateBudget", o.mUpdateBudget);
+  cs::core::Settings::serialize(j, "guiDistance", o.mGuiDistance);
+  cs::core::Settings::serialize(j, "guiPoolSize", o.mGuiPoolSize);
+  cs::core::Settings::serialize(j, "showStatistics", o.mShowStatistics);
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -283,6 +421,10 @@ void Plugin::init() {
 
   logger().info("Loading plugin...");
 
+  mThreadPool     = std::make_shared<ThreadPool>();
+  mHeightProvider = std::make_shared<HeightProvider>();
+  mLineRenderer   = std::make_shared<LineRenderer>(mSolarSystem, mTimeControl);
+
   mOnLoadConnection = mAllSettings->onLoad().connect([this]() { onLoad(); });
   mOnSaveConnection = mAllSettings->onSave().connect(
       [this]() { mAllSettings->mPlugins["csp-measurement-tools"] = mPluginSettings; });
@@ -311,6 +453,14 @@ void Plugin::init() {
       "'Landing Ellipse, 'Path', 'Dip & Strike' or 'Polygon'.",
       std::function([this](std::string&& name) { mNextTool = name; }));
 
+  mGuiManager->getGui()->registerCallback("measurementTools.runBatch",
+      "Measures all polygons and paths of the JSON file given as first argument and writes the "
+      "results to the file given as second argument. The input has the same format as the "
+      "settings of this plugin.",
+      std::function([this](std::string&& inputFile, std::string&& outputFile) {
+        runBatch(inputFile, outputFile);
+      }));
+
   mOnClickConnection = mInputManager->pButtons[0].connect([this](bool pressed) {
     if (!pressed && !mInputManager->pHoveredGuiItem.get()) {
       auto intersection = mInputManager->pHoveredObject.get().mObject;
@@ -337,17 +487,19 @@ void Plugin::init() {
 
         } else if (mNextTool == "Landing Ellipse") {
           auto tool = std::make_shared<EllipseTool>(mInputManager, mSolarSystem, mAllSettings,
-              mTimeControl, body->getCenterName(), body->getFrameName());
+              mTimeControl, mLineRenderer, mThreadPool, mHeightProvider, body->getCenterName(),
+              body->getFrameName());
           tool->getCenterHandle().pLngLat = cs::utils::convert::toLngLatHeight(
               mInputManager->pHoveredObject.get().mPosition, radii[0], radii[0])
                                                 .xy();
-          tool->setNumSamples(mPluginSettings.mEllipseSamples.get());
+          applyEllipseSettings(*tool);
           mPluginSettings.mEllipses.push_back(tool);
 
         } else if (mNextTool == "Path") {
           auto tool = std::make_shared<PathTool>(mInputManager, mSolarSystem, mAllSettings,
-              mTimeControl, body->getCenterName(), body->getFrameName());
+              mTimeControl, mLineRenderer, body->getCenterName(), body->getFrameName());
           tool->setNumSamples(mPluginSettings.mPathSamples.get());
+          tool->setTolerance(mPluginSettings.mPathTolerance.get());
           tool->pAddPointMode = true;
           tool->addPoint();
           mPluginSettings.mPaths.push_back(tool);
@@ -355,17 +507,16 @@ void Plugin::init() {
         } else if (mNextTool == "Dip & Strike") {
           auto tool = std::make_shared<DipStrikeTool>(mInputManager, mSolarSystem, mAllSettings,
               mTimeControl, body->getCenterName(), body->getFrameName());
+          tool->setDenseSamples(mPluginSettings.mDipStrikeSamples.get());
           tool->pAddPointMode = true;
           tool->addPoint();
           mPluginSettings.mDipStrikes.push_back(tool);
 
         } else if (mNextTool == "Polygon") {
           auto tool = std::make_shared<PolygonTool>(mInputManager, mSolarSystem, mAllSettings,
-              mTimeControl, body->getCenterName(), body->getFrameName());
-          tool->setHeightDiff(mPluginSettings.mPolygonHeightDiff.get());
-          tool->setMaxAttempt(mPluginSettings.mPolygonMaxAttempt.get());
-          tool->setMaxPoints(mPluginSettings.mPolygonMaxPoints.get());
-          tool->setSleekness(mPluginSettings.mPolygonSleekness.get());
+              mTimeControl, mLineRenderer, mThreadPool, mHeightProvider, body->getCenterName(),
+              body->getFrameName());
+          applyPolygonSettings(*tool);
           tool->pAddPointMode = true;
           tool->addPoint();
           mPluginSettings.mPolygons.push_back(tool);
@@ -409,18 +560,70 @@ void Plugin::init() {
     }
   });
 
+  mPluginSettings.mPolygonIntersectionTolerance.connect([this](float val) {
+    for (auto& p : mPluginSettings.mPolygons) {
+      p->setIntersectionTolerance(val);
+    }
+  });
+
+  mPluginSettings.mPolygonConvergenceThreshold.connect([this](float val) {
+    for (auto& p : mPluginSettings.mPolygons) {
+      p->setConvergenceThreshold(val);
+    }
+  });
+
+  mPluginSettings.mPolygonTileAngle.connect([this](float val) {
+    for (auto& p : mPluginSettings.mPolygons) {
+      p->setTileAngle(val);
+    }
+  });
+
+  mPluginSettings.mTerrainId.connect([this](std::string const& val) {
+    for (auto& p : mPluginSettings.mPolygons) {
+      p->setTerrainId(val);
+    }
+  });
+
   mPluginSettings.mEllipseSamples.connect([this](int32_t val) {
     for (auto& p : mPluginSettings.mEllipses) {
       p->setNumSamples(val);
     }
   });
 
+  mPluginSettings.mEllipseInteriorSamples.connect([this](int32_t val) {
+    for (auto& p : mPluginSettings.mEllipses) {
+      p->setInteriorSamples(val);
+    }
+  });
+
   mPluginSettings.mPathSamples.connect([this](int32_t val) {
     for (auto& p : mPluginSettings.mPaths) {
       p->setNumSamples(val);
     }
   });
 
+  mPluginSettings.mPathTolerance.connect([this](float val) {
+    for (auto& p : mPluginSettings.mPaths) {
+      p->setTolerance(val);
+    }
+  });
+
+  mPluginSettings.mDipStrikeSamples.connect([this](int32_t val) {
+    for (auto& p : mPluginSettings.mDipStrikes) {
+      p->setDenseSamples(val);
+    }
+  });
+
+  mPluginSettings.mUpdateBudget.connectAndTouch(
+      [this](float val) { mUpdateScheduler.setBudget(val); });
+
+  mPluginSettings.mGuiPoolSize.connectAndTouch(
+      [this](int32_t val) { mGuiPool.setCapacity(static_cast<size_t>(std::max(val, 0))); });
+
+  mPluginSettings.mShowStatistics.connectAndTouch([this](bool val) {
+    mGuiManager->getGui()->callJavascript("CosmoScout.measurementTools.showStatistics", val);
+  });
+
   // Load settings.
   onLoad();
 
@@ -435,6 +638,7 @@ void Plugin::deInit() {
   mGuiManager->removePluginTab("Measurement Tools");
 
   mGuiManager->getGui()->unregisterCallback("measurementTools.setNext");
+  mGuiManager->getGui()->unregisterCallback("measurementTools.runBatch");
   mGuiManager->getGui()->callJavascript("CosmoScout.gui.unregisterHtml", "measurement-tools");
   mGuiManager->getGui()->callJavascript(
       "CosmoScout.gui.unregisterCss", "css/csp-measurement-tools-sidebar.css");
@@ -445,6 +649,15 @@ void Plugin::deInit() {
   mAllSettings->onLoad().disconnect(mOnLoadConnection);
   mAllSettings->onSave().disconnect(mOnSaveConnection);
 
+  // The thread pool waits for the running items, the remaining ones are skipped.
+  if (mPendingBatch) {
+    mPendingBatch->mCancel->store(true);
+  }
+
+  // The calculations which are waiting for terrain heights are aborted, as these are only
+  // answered in update(). Otherwise the thread pool could not be joined.
+  mHeightProvider->shutdown();
+
   logger().info("Unloading done.");
 }
 
@@ -458,23 +671,299 @@ void Plugin::update() {
   updateTools(mPluginSettings.mFlags);
   updateTools(mPluginSettings.mPaths);
   updateTools(mPluginSettings.mPolygons);
+
+  // The expensive recomputations of the tools are spread over several frames. Tools which are
+  // being edited or are close to the observer are processed first.
+  std::vector<UpdateScheduler::Client*> clients;
+  addClients(mPluginSettings.mDipStrikes, clients);
+  addClients(mPluginSettings.mEllipses, clients);
+  addClients(mPluginSettings.mPaths, clients);
+  addClients(mPluginSettings.mPolygons, clients);
+
+  // The web views of the pool are shared by the tools closest to the observer, if they are closer
+  // than mGuiDistance. As loading a web view blocks, they are handed out by the scheduler as well.
+  std::vector<ToolGui*> guis;
+  addGuis(mPluginSettings.mDipStrikes, guis);
+  addGuis(mPluginSettings.mEllipses, guis);
+  addGuis(mPluginSettings.mFlags, guis);
+  addGuis(mPluginSettings.mPaths, guis);
+  addGuis(mPluginSettings.mPolygons, guis);
+
+  mGuiPool.update(guis, mSolarSystem->getObserver(), mTimeControl->pSimulationTime.get(),
+      mPluginSettings.mGuiDistance.get());
+  clients.insert(clients.end(), guis.begin(), guis.end());
+
+  mUpdateScheduler.run(clients);
+
+  // The calculations on the thread pool receive their terrain heights from the main thread
+  mHeightProvider->processQueries(HEIGHT_QUERY_BUDGET);
+
+  updateStatistics();
+
+  if (mPendingBatch &&
+      mPendingBatch->mFinished.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+    auto batch = std::move(*mPendingBatch);
+    mPendingBatch.reset();
+
+    try {
+      batch.mFinished.get();
+    } catch (std::exception const& e) {
+      logger().error("Batch measurement failed: {}", e.what());
+    }
+  }
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 void Plugin::onLoad() {
-  sInputManager = mInputManager;
-  sSolarSystem  = mSolarSystem;
-  sSettings     = mAllSettings;
-  sTimeControl  = mTimeControl;
+  sInputManager   = mInputManager;
+  sSolarSystem    = mSolarSystem;
+  sSettings       = mAllSettings;
+  sTimeControl    = mTimeControl;
+  sLineRenderer   = mLineRenderer;
+  sThreadPool     = mThreadPool;
+  sHeightProvider = mHeightProvider;
 
   // Read settings from JSON.
   from_json(mAllSettings->mPlugins.at("csp-measurement-tools"), mPluginSettings);
 
+  // The settings are only passed to new tools and to all tools when they change. The loaded tools
+  // would keep their defaults if the loaded settings do not differ from the current ones.
+  for (auto const& polygon : mPluginSettings.mPolygons) {
+    applyPolygonSettings(*polygon);
+  }
+
+  for (auto const& ellipse : mPluginSettings.mEllipses) {
+    applyEllipseSettings(*ellipse);
+  }
+
+  for (auto const& dipStrike : mPluginSettings.mDipStrikes) {
+    dipStrike->setDenseSamples(mPluginSettings.mDipStrikeSamples.get());
+  }
+
   sInputManager.reset();
   sSolarSystem.reset();
   sSettings.reset();
   sTimeControl.reset();
+  sLineRenderer.reset();
+  sThreadPool.reset();
+  sHeightProvider.reset();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void Plugin::applyPolygonSettings(PolygonTool& tool) const {
+  tool.setHeightDiff(mPluginSettings.mPolygonHeightDiff.get());
+  tool.setMaxAttempt(mPluginSettings.mPolygonMaxAttempt.get());
+  tool.setMaxPoints(mPluginSettings.mPolygonMaxPoints.get());
+  tool.setSleekness(mPluginSettings.mPolygonSleekness.get());
+  tool.setIntersectionTolerance(mPluginSettings.mPolygonIntersectionTolerance.get());
+  tool.setConvergenceThreshold(mPluginSettings.mPolygonConvergenceThreshold.get());
+  tool.setTileAngle(mPluginSettings.mPolygonTileAngle.get());
+  tool.setTerrainId(mPluginSettings.mTerrainId.get());
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void Plugin::applyEllipseSettings(EllipseTool& tool) const {
+  tool.setNumSamples(mPluginSettings.mEllipseSamples.get());
+  tool.setInteriorSamples(mPluginSettings.mEllipseInteriorSamples.get());
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void Plugin::runBatch(std::string const& inputFile, std::string const& outputFile) {
+  if (mPendingBatch) {
+    logger().warn("Failed to start batch measurement: Another one is still running!");
+    return;
+  }
+
+  // The items are copied to the output, each one is amended with its results. Items on unknown
+  // bodies are marked as invalid.
+  std::vector<nlohmann::json> polygons;
+  std::vector<nlohmann::json> paths;
+  std::vector<size_t>         polygonItems;
+  std::vector<size_t>         pathItems;
+
+  BatchMeasurement::Input input;
+  input.mThreadPool = mThreadPool.get();
+
+  try {
+    nlohmann::json json;
+    std::ifstream  stream(inputFile);
+    stream.exceptions(std::ifstream::failbit | std::ifstream::badbit);
+    stream >> json;
+
+    auto const& current = mPluginSettings;
+
+    PolygonCalculator::Input settings;
+    settings.mHeightDiff = json.value("polygonHeightDiff", current.mPolygonHeightDiff.get());
+    settings.mMaxAttempt = json.value("polygonMaxAttempt", current.mPolygonMaxAttempt.get());
+    settings.mMaxPoints  = json.value("polygonMaxPoints", current.mPolygonMaxPoints.get());
+    settings.mSleekness  = json.value("polygonSleekness", current.mPolygonSleekness.get());
+    settings.mIntersectionTolerance =
+        json.value("polygonIntersectionTolerance", current.mPolygonIntersectionTolerance.get());
+    settings.mConvergenceThreshold =
+        json.value("polygonConvergenceThreshold", current.mPolygonConvergenceThreshold.get());
+    settings.mTileAngle = json.value("polygonTileAngle", current.mPolygonTileAngle.get());
+
+    int   pathSamples   = json.value("pathSamples", current.mPathSamples.get());
+    float pathTolerance = json.value("pathTolerance", current.mPathTolerance.get());
+
+    // Reads the center and the positions of an item and returns the body they belong to.
+    auto readItem = [this](nlohmann::json const& item, std::vector<glm::dvec2>& positions) {
+      std::string center;
+      cs::core::Settings::deserialize(item, "center", center);
+      cs::core::Settings::deserialize(item, "positions", positions);
+
+      auto body = mSolarSystem->getBody(center);
+
+      if (!body) {
+        logger().warn("Skipping item of batch measurement: Unknown center '{}'!", center);
+      }
+
+      return body;
+    };
+
+    for (auto const& item : json.value("polygons", nlohmann::json::array())) {
+      polygons.push_back(item);
+      cs::core::Settings::serialize(polygons.back(), "valid", false);
+
+      std::vector<glm::dvec2> positions;
+      auto                    body = readItem(item, positions);
+
+      if (!body) {
+        continue;
+      }
+
+      PolygonCalculator::Input polygon = settings;
+      polygon.mRadii                   = body->getRadii();
+      polygon.mHeightSource            = HeightProvider::getSource(mHeightProvider, body);
+      polygon.mBatchHeightSource       = HeightProvider::getBatchSource(mHeightProvider, body);
+
+      for (auto const& p : positions) {
+        polygon.mPositions.push_back(cs::utils::convert::toCartesian(
+            p, polygon.mRadii[0], polygon.mRadii[0], body->getHeight(p)));
+      }
+
+      input.mPolygons.push_back(std::move(polygon));
+      polygonItems.push_back(polygons.size() - 1);
+    }
+
+    for (auto const& item : json.value("paths", nlohmann::json::array())) {
+      paths.push_back(item);
+
+      BatchMeasurement::Path path;
+      auto                   body = readItem(item, path.mPoints);
+
+      if (!body) {
+        continue;
+      }
+
+      path.mRadius            = body->getRadii()[0];
+      path.mHeightSource      = HeightProvider::getSource(mHeightProvider, body);
+      path.mBatchHeightSource = HeightProvider::getBatchSource(mHeightProvider, body);
+      path.mNumSamples        = pathSamples;
+      path.mTolerance         = pathTolerance;
+
+      input.mPaths.push_back(std::move(path));
+      pathItems.push_back(paths.size() - 1);
+    }
+  } catch (std::exception const& e) {
+    logger().error("Failed to read batch measurement '{}': {}", inputFile, e.what());
+    return;
+  }
+
+  logger().info("Starting batch measurement of {} polygons and {} paths...",
+      input.mPolygons.size(), input.mPaths.size());
+
+  auto batch  = std::make_shared<BatchMeasurement>(std::move(input));
+  auto cancel = std::make_shared<std::atomic_bool>(false);
+
+  // The results are written on the worker thread as well, as the profiles of thousands of paths
+  // take a while to serialize.
+  auto finished = mThreadPool->enqueue([batch, cancel, polygons = std::move(polygons),
+                                           paths = std::move(paths), polygonItems, pathItems,
+                                           outputFile]() mutable {
+    if (!batch->compute(*cancel)) {
+      return;
+    }
+
+    auto const& result = batch->getResult();
+
+    for (size_t i = 0; i < result.mPolygons.size(); ++i) {
+      auto& item = polygons[polygonItems[i]];
+      cs::core::Settings::serialize(item, "valid", result.mPolygons[i].mValid);
+      cs::core::Settings::serialize(item, "area", result.mPolygons[i].mArea);
+      cs::core::Settings::serialize(item, "posVolume", result.mPolygons[i].mPosVolume);
+      cs::core::Settings::serialize(item, "negVolume", result.mPolygons[i].mNegVolume);
+    }
+
+    for (size_t i = 0; i < result.mPaths.size(); ++i) {
+      auto& item = paths[pathItems[i]];
+      cs::core::Settings::serialize(item, "length", result.mPaths[i].mLength);
+      cs::core::Settings::serialize(item, "profile", result.mPaths[i].mProfile);
+    }
+
+    nlohmann::json output;
+    cs::core::Settings::serialize(output, "polygons", polygons);
+    cs::core::Settings::serialize(output, "paths", paths);
+
+    std::ofstream stream(outputFile);
+    stream.exceptions(std::ofstream::failbit | std::ofstream::badbit);
+    stream << output.dump(2);
+
+    logger().info("Wrote results of batch measurement to '{}'.", outputFile);
+  });
+
+  mPendingBatch = PendingBatch{cancel, std::move(finished)};
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void Plugin::updateStatistics() {
+  for (auto const& path : mPluginSettings.mPaths) {
+    mFrameStatistics.merge(path->getStatistics());
+    path->resetStatistics();
+  }
+
+  for (auto const& polygon : mPluginSettings.mPolygons) {
+    auto const& statistics = polygon->getStatistics();
+
+    // Refinement attempts are only counted in the frame in which a calculation has finished.
+    if (mPluginSettings.mShowStatistics.get() &&
+        statistics.get(Statistics::Counter::eAttempts) > 0) {
+      mGuiManager->getGui()->callJavascript(
+          "CosmoScout.measurementTools.setStatistics", toJson(statistics).dump());
+    }
+
+    mFrameStatistics.merge(statistics);
+    polygon->resetStatistics();
+  }
+
+  // These are the uploads of the previous frame, as the LineRenderer draws after the update.
+  mFrameStatistics.merge(mLineRenderer->getStatistics());
+  mLineRenderer->resetStatistics();
+
+  ++mStatisticsFrames;
+
+  auto                          now     = std::chrono::steady_clock::now();
+  std::chrono::duration<double> elapsed = now - mStatisticsStart;
+
+  if (elapsed.count() < STATISTICS_INTERVAL) {
+    return;
+  }
+
+  if (!mFrameStatistics.getIsEmpty()) {
+    logger().debug("Measurement tools in the last {} frames: {}; {} updates postponed in the "
+                   "last frame, {} web views in use.",
+        mStatisticsFrames, mFrameStatistics.toString(), mUpdateScheduler.getPostponedCount(),
+        mGuiPool.getUsedCount());
+  }
+
+  mFrameStatistics.reset();
+  mStatisticsFrames = 0;
+  mStatisticsStart  = now;
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
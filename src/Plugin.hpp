@@ -9,8 +9,16 @@
 
 #include "../../../src/cs-core/PluginBase.hpp"
 #include "../../../src/cs-utils/DefaultProperty.hpp"
+#include "GuiPool.hpp"
+#include "Statistics.hpp"
+#include "UpdateScheduler.hpp"
 
+#include <atomic>
+#include <chrono>
+#include <future>
 #include <list>
+#include <memory>
+#include <optional>
 #include <string>
 
 namespace cs::core::tools {
@@ -22,8 +30,11 @@ namespace csp::measurementtools {
 class DipStrikeTool;
 class EllipseTool;
 class FlagTool;
+class HeightProvider;
+class LineRenderer;
 class PathTool;
 class PolygonTool;
+class ThreadPool;
 
 /// This plugin enables the user to measure different things on the surface of planets and moons.
 /// See README.md for details.
@@ -37,12 +48,23 @@ class Plugin : public cs::core::PluginBase {
     std::vector<std::shared_ptr<PathTool>>      mPaths;
     std::vector<std::shared_ptr<PolygonTool>>   mPolygons;
 
-    cs::utils::DefaultProperty<float>   mPolygonHeightDiff{1.002F};
-    cs::utils::DefaultProperty<int32_t> mPolygonMaxAttempt{5};
-    cs::utils::DefaultProperty<int32_t> mPolygonMaxPoints{1000};
-    cs::utils::DefaultProperty<int32_t> mPolygonSleekness{15};
-    cs::utils::DefaultProperty<int32_t> mEllipseSamples{100};
-    cs::utils::DefaultProperty<int32_t> mPathSamples{256};
+    cs::utils::DefaultProperty<float>       mPolygonHeightDiff{1.002F};
+    cs::utils::DefaultProperty<int32_t>     mPolygonMaxAttempt{5};
+    cs::utils::DefaultProperty<int32_t>     mPolygonMaxPoints{1000};
+    cs::utils::DefaultProperty<int32_t>     mPolygonSleekness{15};
+    cs::utils::DefaultProperty<float>       mPolygonIntersectionTolerance{1.F};
+    cs::utils::DefaultProperty<float>       mPolygonConvergenceThreshold{0.0001F};
+    cs::utils::DefaultProperty<float>       mPolygonTileAngle{0.F};
+    cs::utils::DefaultProperty<std::string> mTerrainId{""};
+    cs::utils::DefaultProperty<int32_t>     mEllipseSamples{100};
+    cs::utils::DefaultProperty<int32_t>     mEllipseInteriorSamples{0};
+    cs::utils::DefaultProperty<int32_t>     mPathSamples{256};
+    cs::utils::DefaultProperty<float>       mPathTolerance{0.F};
+    cs::utils::DefaultProperty<int32_t>     mDipStrikeSamples{0};
+    cs::utils::DefaultProperty<float>       mUpdateBudget{2.F};
+    cs::utils::DefaultProperty<float>       mGuiDistance{500000.F};
+    cs::utils::DefaultProperty<int32_t>     mGuiPoolSize{16};
+    cs::utils::DefaultProperty<bool>        mShowStatistics{false};
   };
 
   void init() override;
@@ -52,13 +74,60 @@ class Plugin : public cs::core::PluginBase {
  private:
   void onLoad();
 
-  Settings    mPluginSettings{};
-  std::string mNextTool = "none";
+  /// Applies the current polygon settings to the given tool. This is done for new tools and for
+  /// the tools which are loaded from the settings, so that the keys of their cached results are
+  /// computed with the same settings as when they were stored.
+  void applyPolygonSettings(PolygonTool& tool) const;
+
+  /// Applies the current ellipse settings to the given tool. Like for the polygons, this is done
+  /// for new tools and for the tools which are loaded from the settings.
+  void applyEllipseSettings(EllipseTool& tool) const;
+
+  /// Measures all polygons and paths of the given file on the thread pool and writes the results
+  /// to the output file. The file uses the same format as the plugin settings, but no tools are
+  /// created for its items. Settings like "polygonMaxPoints" are taken from the file if present,
+  /// from the current settings otherwise.
+  void runBatch(std::string const& inputFile, std::string const& outputFile);
+
+  /// Collects the statistics of all tools and of the LineRenderer and logs their sum about once
+  /// per STATISTICS_INTERVAL. The statistics of each finished polygon calculation are shown in
+  /// the tab if mShowStatistics is set.
+  void updateStatistics();
+
+  // These are declared before the settings, so that all tools are destroyed before them.
+  std::shared_ptr<ThreadPool>     mThreadPool;
+  std::shared_ptr<HeightProvider> mHeightProvider;
+  std::shared_ptr<LineRenderer>   mLineRenderer;
+  GuiPool                         mGuiPool;
+
+  Settings        mPluginSettings{};
+  UpdateScheduler mUpdateScheduler;
+  std::string     mNextTool = "none";
+
+  // The batch measurement which is currently running on the thread pool.
+  struct PendingBatch {
+    std::shared_ptr<std::atomic_bool> mCancel;
+    std::future<void>                 mFinished;
+  };
+
+  std::optional<PendingBatch> mPendingBatch;
+
+  // The work of all tools since the statistics were logged last.
+  Statistics                            mFrameStatistics;
+  uint32_t                              mStatisticsFrames = 0;
+  std::chrono::steady_clock::time_point mStatisticsStart  = std::chrono::steady_clock::now();
 
   int mOnClickConnection       = -1;
   int mOnDoubleClickConnection = -1;
   int mOnLoadConnection        = -1;
   int mOnSaveConnection        = -1;
+
+  // In seconds.
+  static const double STATISTICS_INTERVAL;
+
+  // In milliseconds per frame. The terrain height queries of the calculations on the thread pool
+  // are answered on the main thread within this time.
+  static const double HEIGHT_QUERY_BUDGET;
 };
 
 } // namespace csp::measurementtools
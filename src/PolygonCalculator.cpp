@@ -0,0 +1,1495 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//                               This file is part of CosmoScout VR                               //
+//      and may be used under the terms of the MIT license. See the LICENSE file for details.     //
+//                        Copyright: (c) 2019 German Aerospace Center (DLR)                       //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "PolygonCalculator.hpp"
+
+#include "../../../src/cs-utils/convert.hpp"
+#include "PlaneFit.hpp"
+#include "PolygonTiling.hpp"
+#include "logger.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+
+namespace csp::measurementtools {
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+// Hashes the exact bits of a position, this is used to find vertices which are shared by the
+// meshes of neighboring triangles.
+struct PositionHash {
+  size_t operator()(glm::dvec3 const& p) const {
+    std::hash<double> hash;
+    size_t            seed = hash(p.x);
+    seed ^= hash(p.y) + 0x9e3779b9 + (seed << 6U) + (seed >> 2U);
+    seed ^= hash(p.z) + 0x9e3779b9 + (seed << 6U) + (seed >> 2U);
+    return seed;
+  }
+};
+
+} // namespace
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+const int PolygonCalculator::MAX_INTERSECTION_ITERATIONS = 32;
+const int PolygonCalculator::MAX_VOLUME_REFINEMENT       = 2;
+const int PolygonCalculator::DIVIDING_POINTS             = 9;
+
+const float PolygonCalculator::MIN_TILE_ANGLE = 1.F;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+PolygonCalculator::PolygonCalculator(Input input)
+    : mInput(std::move(input)) {
+  if (mInput.mTileAngle > 0.F) {
+    mInput.mTileAngle = std::max(mInput.mTileAngle, MIN_TILE_ANGLE);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+PolygonCalculator::Result const& PolygonCalculator::getResult() const {
+  return mResult;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+PolygonCalculator::Result& PolygonCalculator::getResult() {
+  return mResult;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool PolygonCalculator::getProgress(Progress& progress) {
+  std::lock_guard<std::mutex> lock(mProgressMutex);
+
+  if (!mProgressUpdated) {
+    return false;
+  }
+
+  progress         = mProgress;
+  mProgressUpdated = false;
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+PolygonCalculator::MeshLevel PolygonCalculator::createMeshLevel(
+    std::vector<TriangleResult> const& results) {
+  MeshLevel level;
+
+  std::unordered_map<glm::dvec3, uint32_t, PositionHash> vertices;
+  std::unordered_set<uint64_t>                           edges;
+
+  auto addVertex = [&](projection::SurfaceSamples const& samples, size_t i) {
+    auto [it, inserted] = vertices.emplace(
+        samples.mDirections[i], static_cast<uint32_t>(level.mVertices.size()));
+
+    if (inserted) {
+      level.mVertices.append(samples, i, i + 1);
+    }
+
+    return it->second;
+  };
+
+  for (auto const& result : results) {
+    auto const& samples = result.mTriangulation;
+
+    for (size_t i = 0; i + 1 < samples.size(); i += 2) {
+      uint32_t a = addVertex(samples, i);
+      uint32_t b = addVertex(samples, i + 1);
+
+      if (a == b) {
+        continue;
+      }
+
+      uint64_t key = (static_cast<uint64_t>(std::min(a, b)) << 32U) | std::max(a, b);
+
+      if (edges.insert(key).second) {
+        level.mEdges.push_back(a);
+        level.mEdges.push_back(b);
+      }
+    }
+  }
+
+  return level;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void PolygonCalculator::pruneMeshLevels(std::vector<MeshLevel>& levels) {
+  for (size_t i = levels.size(); i > 1; --i) {
+    if (2 * levels[i - 2].mEdges.size() > levels[i - 1].mEdges.size()) {
+      levels.erase(levels.begin() + static_cast<std::ptrdiff_t>(i - 2));
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Based on
+// https://stackoverflow.com/questions/8721406/how-to-determine-if-a-point-is-inside-a-2d-convex-polygon
+bool PolygonCalculator::checkPoint(glm::dvec2 const& point) {
+  bool result = false;
+
+  // Positive x (other directions could be compared, but it works reliable with only one direction)
+  for (size_t i = 0, j = mCorners.size() - 1; i < mCorners.size(); j = i++) {
+    if (((mCorners[i].mY > point.y) != (mCorners[j].mY > point.y) &&
+            (point.x < (mCorners[j].mX - mCorners[i].mX) * (point.y - mCorners[i].mY) /
+                               (mCorners[j].mY - mCorners[i].mY) +
+                           mCorners[i].mX)) ||
+        // Checks surroundings to avoid numerical errors
+        ((mCorners[i].mY > point.y) != (mCorners[j].mY > point.y) &&
+            std::abs(point.x - ((mCorners[j].mX - mCorners[i].mX) * (point.y - mCorners[i].mY) /
+                                       (mCorners[j].mY - mCorners[i].mY) +
+                                   mCorners[i].mX)) < 0.001)) {
+      result = !result;
+    }
+  }
+  return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool PolygonCalculator::findIntersection(Site const& s1, Site const& s2, Site const& s3,
+    Site const& s4, double& intersectionX, double& intersectionY) {
+  // Avoids division with 0
+  if ((s1.mX == 0) || (s2.mX == 0) || (s3.mX == 0) || (s4.mX == 0) || (s1.mY == 0) ||
+      (s2.mY == 0) || (s3.mY == 0) || (s4.mY == 0)) {
+    return false;
+  }
+
+  // Based on
+  // http://www.softwareandfinance.com/Visual_CPP/VCPP_Intersection_Two_lines_EndPoints.html
+
+  // Safety band - to avoid point duplications - set to 1%
+  double safety = 0.01;
+
+  double m1{};
+  double m2{};
+  double c1{};
+  double c2{};
+
+  // Line 1 (y = m1 * x + c1)
+  m1 = (s2.mY - s1.mY) / (s2.mX - s1.mX);
+  c1 = s1.mY - m1 * s1.mX;
+
+  // Line 2 (y = m2 * x + c2)
+  m2 = (s4.mY - s3.mY) / (s4.mX - s3.mX);
+  c2 = s3.mY - m2 * s3.mX;
+
+  // Edges are not exactly parallel
+  if (m1 != m2) {
+    // Intersection of lines
+    intersectionX = (c2 - c1) / (m1 - m2);
+    intersectionY = m1 * (intersectionX) + c1;
+
+    // Checks if intersection point is on the edges or not (between a bounding box)
+    if (((s1.mX > intersectionX) != (s2.mX > intersectionX)) &&
+        ((s3.mX > intersectionX) != (s4.mX > intersectionX)) &&
+        ((s1.mY > intersectionY) != (s2.mY > intersectionY)) &&
+        ((s3.mY > intersectionY) != (s4.mY > intersectionY))) {
+      // Checks all 4 points: do not return with an intersection point within the safety band
+      if (((std::abs((s1.mX - intersectionX) / s1.mX) > safety) ||
+              (std::abs((s1.mY - intersectionY) / s1.mY) > safety)) &&
+          ((std::abs((s2.mX - intersectionX) / s2.mX) > safety) ||
+              (std::abs((s2.mY - intersectionY) / s2.mY) > safety)) &&
+          ((std::abs((s3.mX - intersectionX) / s3.mX) > safety) ||
+              (std::abs((s3.mY - intersectionY) / s3.mY) > safety)) &&
+          ((std::abs((s4.mX - intersectionX) / s4.mX) > safety) ||
+              (std::abs((s4.mY - intersectionY) / s4.mY) > safety))) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void PolygonCalculator::createMesh(std::vector<Triangle>& triangles, SiteArray& sites) {
+  // The corners are inserted one after another into a triangle which contains all of them. Other
+  // than the sweep, this is robust for many co-linear and co-circular corners. The bounding
+  // triangle is outside of the polygon, so none of its triangles is classified as inside.
+  auto      addr = static_cast<uint32_t>(mCorners.size());
+  SiteArray bounds;
+  bounds.emplace_back(-10.0, -10.0, addr);
+  bounds.emplace_back(10.0, -10.0, addr + 1);
+  bounds.emplace_back(0.0, 10.0, addr + 2);
+
+  VoronoiGenerator voronoi;
+  voronoi.parse(bounds);
+
+  for (auto const& corner : mCorners) {
+    voronoi.insert(corner);
+  }
+
+  // Inserts the edges of the polygon as constraints
+
+  bool constrained = true;
+
+  for (size_t i = 0; i < mCorners.size() && constrained; i++) {
+    constrained = voronoi.insertConstraint(mCorners[i], mCorners[(i + 1) % mCorners.size()]);
+  }
+
+  mResult.mStatistics.merge(voronoi.getStatistics());
+
+  // Self-intersecting polygons cannot be triangulated like this
+  if (!constrained) {
+    createRepairedMesh(triangles, sites);
+    return;
+  }
+
+  // A flood fill over the triangulation finds the triangles inside of the polygon: these are
+  // separated from the outside by an odd number of the polygon's edges
+  std::vector<uint32_t> depths = voronoi.getConstraintDepths();
+
+  triangles.clear();
+
+  for (size_t i = 0; i < depths.size(); ++i) {
+    if (depths[i] % 2 == 1) {
+      triangles.push_back(voronoi.getTriangles()[i]);
+    }
+  }
+
+  sites = voronoi.getSites();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void PolygonCalculator::createRepairedMesh(std::vector<Triangle>& triangles, SiteArray& sites) {
+  bool edgesOK = false;
+  int  it      = 0;
+
+  // Does the triangulaiton of the original polygon
+  // Checks and refines the triangulation until all original edges of the polygon are in the
+  // triangulation Quits after 5 iteration to avoid performance issues and displays error message
+  while (!edgesOK && it < 5) {
+    it++;
+
+    // Performs the Delaunay triangulation
+    VoronoiGenerator voronoi;
+    voronoi.parse(mCorners);
+
+    // Original edges of the polygon which are missing in the Delaunay triangulation (the
+    // original polygon edges have neighbor addresses)
+    std::vector<glm::ivec2> missingEdges;
+
+    for (size_t i = 0; i < mCorners.size(); i++) {
+      size_t next = (i + 1) % mCorners.size();
+      if (!voronoi.hasEdge(mCorners[i], mCorners[next])) {
+        missingEdges.emplace_back(i, next);
+      }
+    }
+
+    // If some of the polygon edges did not match with a voronoi edge
+    // This means, that some edges are missing, and need to be recovered
+    // Intersection points of the missing edges and voronoi edges need to determined
+    // These points are added to mCorners, and the triangulation hopefully
+    // solves the problem in the next cycle (works for most of the cases)
+    if (!missingEdges.empty()) {
+      // Vector of corners on missing edges - to be added to mCorners
+      std::vector<Site> addCorners;
+
+      for (auto const& missingAddr : missingEdges) {
+        // Points of the missing edge
+        Site site1 = mCorners[missingAddr.x];
+        Site site2 = mCorners[missingAddr.y];
+
+        // Finds intersecting edges (if a triangulation edge intersects the original polygon edge,
+        // it is wrong)
+        for (auto const& s : voronoi.getTriangulation()) {
+          double intersectionX{};
+          double intersectionY{};
+
+          if (findIntersection(site1, site2, s.first, s.second, intersectionX, intersectionY)) {
+            uint32_t addrNew =
+                site1.mAddr + 1; // = site2.mAddr (except for the last edge, where site2.mAddr=0!
+            Site oldCorner(0, 0, 0);
+            bool done = false;
+
+            // Cycles through addCorners vector and saves current intersection into the right
+            // place
+            for (auto& addCorner : addCorners) {
+              // If current intersection is not saved yet
+              if (!done) {
+                // Compares addresses of the two intersection
+                if (addCorner.mAddr < addrNew) {
+                  // Skips first elements of vector
+                } else if (addCorner.mAddr == addrNew) {
+                  // If edges points to positive x
+                  if (intersectionX > site1.mX) {
+                    // Saves intersection only when it is in front of the
+                    // existing intersection; otherwise it will be handled
+                    // in the next cycle
+                    if (addCorner.mX > intersectionX) {
+                      // Saves existing intersection to oldCorner
+                      // will be placed back to vector in the next cycle
+                      oldCorner = addCorner;
+                      addCorner = Site(intersectionX, intersectionY, addrNew);
+                      done      = true;
+                    }
+                  }
+                  // If edges points to negative x
+                  else if (intersectionX < site1.mX) {
+                    if (addCorner.mX < intersectionX) {
+                      oldCorner = addCorner;
+                      addCorner = Site(intersectionX, intersectionY, addrNew);
+                      done      = true;
+                    }
+                  }
+                  // Handles the very rare case of a vertical edge
+                  // Does the same, as before, just now with y coordinates
+                  else if (intersectionX == site1.mX) {
+                    if (intersectionY > site1.mY) {
+                      if (addCorner.mY > intersectionY) {
+                        oldCorner = addCorner;
+                        addCorner = Site(intersectionX, intersectionY, addrNew);
+                        done      = true;
+                      }
+                    } else if (intersectionY < site1.mY) {
+                      if (addCorner.mY < intersectionY) {
+                        oldCorner = addCorner;
+                        addCorner = Site(intersectionX, intersectionY, addrNew);
+                        done      = true;
+                      }
+                    }
+                  } // if (intersectionX==s.first.mX)
+                }   // if (addCorners[i].mAddr == addrNew)
+                // if (addCorners[i].mAddr > addrNew)
+                else {
+                  oldCorner = addCorner;
+                  addCorner = Site(intersectionX, intersectionY, addrNew);
+                  done      = true;
+                }
+              } // if (!done)
+              else {
+                // After the current intersecting point is added to the middle of the vector
+                // shifts back every other element by one position
+                Site newCorner = addCorner;
+                addCorner      = oldCorner;
+                oldCorner      = newCorner;
+              }
+            } // for (int i = 0; i < addCorners.size(); i++)
+
+            // If the current intersection was placed in the vector
+            if (done) {
+              // Emplaces the last element to the end of the vector
+              addCorners.emplace_back(oldCorner);
+            } else {
+              // Emplaces back current intersection to the end of the vector
+              addCorners.emplace_back(Site(intersectionX, intersectionY, addrNew));
+            }
+
+            // Corners needed to be added -> run the cycle again
+            edgesOK = false;
+          } // if (findIntersection(...))
+        }   // for (auto const& s : triangulation)
+      }     // for (auto const& missingAddr : missingEdges)
+
+      // Counts the intersection corners already added to mCorners
+      int cornerCount = 0;
+
+      // Goes through the intersection corners and adds them to the right place of mCorners
+      for (auto const& c : addCorners) {
+        // Address of the intersection if it is the only one in the vector
+        int addr3 = c.mAddr;
+        addr3 += cornerCount;
+
+        // If intersection is not between last and first Site
+        if (addr3 < static_cast<int>(mCorners.size())) {
+          // Saves intersection corner to mCorners and element of mCorners to oldSite
+          Site oldSite    = mCorners[addr3];
+          mCorners[addr3] = Site(c.mX, c.mY, addr3);
+
+          addr3++;
+
+          // Shifts every other corner of mCorners behind by one
+          for (; addr3 < static_cast<int>(mCorners.size()); addr3++) {
+            Site newSite    = mCorners[addr3];
+            mCorners[addr3] = Site(oldSite.mX, oldSite.mY, addr3);
+            oldSite         = newSite;
+          }
+
+          // Emplaces back the last corner
+          mCorners.emplace_back(Site(oldSite.mX, oldSite.mY, addr3));
+        } else {
+          // Emplaces back the intersection corner
+          mCorners.emplace_back(Site(c.mX, c.mY, addr3));
+        }
+
+        cornerCount++;
+      }
+    } // if (!missingEdges.empty())
+    else {
+      // All of the original edges are in voronoiEdges -> no need for an other cycle
+      edgesOK = true;
+    }
+    // Saves the original triangles
+    triangles = voronoi.getTriangles();
+    sites     = voronoi.getSites();
+
+    mResult.mStatistics.merge(voronoi.getStatistics());
+  } // while (!edgesOK && it < 5)
+
+  // If the voronoi edges are still wrong after 5 cycles of refinement, display the problem
+  if (!edgesOK) {
+    logger().warn("Area calculation can be false: Concave or self-intersecting polygon! Check "
+                  "triangulation mesh.");
+  }
+
+  // Only keeps the triangles whose middle point is inside of the polygon
+  triangles.erase(std::remove_if(triangles.begin(), triangles.end(),
+                      [&](Triangle const& t) {
+                        return !checkPoint(glm::dvec2(
+                            (sites.mX[t[0]] + sites.mX[t[1]] + sites.mX[t[2]]) / 3,
+                            (sites.mY[t[0]] + sites.mY[t[1]] + sites.mY[t[2]]) / 3));
+                      }),
+      triangles.end());
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool PolygonCalculator::checkSleekness(int count) {
+  // Voronoi inside the original triangles - to check triangle angles
+  VoronoiGenerator const& voronoiCheck = updateTriangulation(count);
+
+  // Vector to save addresses of added points - to avoid adding the same point twice
+  std::vector<std::pair<uint32_t, uint32_t>> addedPoints;
+
+  auto const& sites     = voronoiCheck.getSites();
+  auto const& triangles = voronoiCheck.getTriangles();
+
+  // Length of the edges: edge 1 is between corner 1 and 2, edge 2 between corner 1 and 3 and edge
+  // 3 between corner 2 and 3 of each triangle
+  std::vector<double> lengths(3 * triangles.size());
+
+  for (size_t i = 0; i < triangles.size(); ++i) {
+    auto [a, b, c] = triangles[i];
+
+    lengths[3 * i]     = std::sqrt((sites.mX[a] - sites.mX[b]) * (sites.mX[a] - sites.mX[b]) +
+                               (sites.mY[a] - sites.mY[b]) * (sites.mY[a] - sites.mY[b]));
+    lengths[3 * i + 1] = std::sqrt((sites.mX[a] - sites.mX[c]) * (sites.mX[a] - sites.mX[c]) +
+                                   (sites.mY[a] - sites.mY[c]) * (sites.mY[a] - sites.mY[c]));
+    lengths[3 * i + 2] = std::sqrt((sites.mX[b] - sites.mX[c]) * (sites.mX[b] - sites.mX[c]) +
+                                   (sites.mY[b] - sites.mY[c]) * (sites.mY[b] - sites.mY[c]));
+  }
+
+  // Checks triangle sleekness and add middle points to vector if they are too sleek
+  // Could be done in multiple iterations for a more precise result
+  for (size_t i = 0; i < triangles.size(); ++i) {
+    // Minimun angle criteria (for 2 simple cases, approximately correct in general)
+    float minAngle = mInput.mSleekness * glm::pi<float>() / 180;
+    // Ratio of two edges in triangle
+    float sleekness1 = 1 / std::sin(minAngle);
+    // Ration between the sum of 2 smaller edges and the long edge in triangle
+    float sleekness2 = 1 / std::cos(minAngle);
+
+    Site si1 = sites[triangles[i][0]];
+    Site si2 = sites[triangles[i][1]];
+    Site si3 = sites[triangles[i][2]];
+
+    double length1 = lengths[3 * i];
+    double length2 = lengths[3 * i + 1];
+    double length3 = lengths[3 * i + 2];
+
+    // Edge 1 is too long compared to the others
+    if ((length2 * sleekness1 < length1) || (length3 * sleekness1 < length1) ||
+        (length2 + length3 < length1 * sleekness2)) {
+      bool addPoint = true;
+      // Checks previously added points if they are the same
+      for (auto const& addr : addedPoints) {
+        if (((addr.first == si1.mAddr) && (addr.second == si2.mAddr)) ||
+            ((addr.first == si2.mAddr) && (addr.second == si1.mAddr))) {
+          addPoint = false;
+        }
+      }
+      // If not, adds this point to vector
+      if (addPoint) {
+        mCornersFine[count].emplace_back((si1.mX + si2.mX) / 2, (si1.mY + si2.mY) / 2,
+            static_cast<uint32_t>(mCornersFine[count].size()));
+        addedPoints.emplace_back(si1.mAddr, si2.mAddr);
+      }
+    }
+
+    // Edge 2 is too long compared to the others
+    if ((length1 * sleekness1 < length2) || (length3 * sleekness1 < length2) ||
+        (length1 + length3 < length2 * sleekness2)) {
+      bool addPoint = true;
+      for (auto const& addr : addedPoints) {
+        if (((addr.first == si1.mAddr) && (addr.second == si3.mAddr)) ||
+            ((addr.first == si3.mAddr) && (addr.second == si1.mAddr))) {
+          addPoint = false;
+        }
+      }
+      if (addPoint) {
+        mCornersFine[count].emplace_back((si1.mX + si3.mX) / 2, (si1.mY + si3.mY) / 2,
+            static_cast<uint32_t>(mCornersFine[count].size()));
+        addedPoints.emplace_back(si1.mAddr, si3.mAddr);
+      }
+    }
+
+    // Edge 3 is too long compared to the others
+    if ((length1 * sleekness1 < length3) || (length2 * sleekness1 < length3) ||
+        (length1 + length2 < length3 * sleekness2)) {
+      bool addPoint = true;
+      for (auto const& addr : addedPoints) {
+        if (((addr.first == si2.mAddr) && (addr.second == si3.mAddr)) ||
+            ((addr.first == si3.mAddr) && (addr.second == si2.mAddr))) {
+          addPoint = false;
+        }
+      }
+      if (addPoint) {
+        mCornersFine[count].emplace_back((si2.mX + si3.mX) / 2, (si2.mY + si3.mY) / 2,
+            static_cast<uint32_t>(mCornersFine[count].size()));
+        addedPoints.emplace_back(si2.mAddr, si3.mAddr);
+      }
+    }
+  }
+
+  return addedPoints.size() >
+         1.5 * static_cast<double>(mCornersFine[count].size() - addedPoints.size());
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+VoronoiGenerator const& PolygonCalculator::updateTriangulation(int count) {
+  auto&       triangulation = *mTriangulations[count];
+  auto const& corners       = mCornersFine[count];
+
+  for (size_t i = triangulation.getSites().size(); i < corners.size(); ++i) {
+    triangulation.insert(corners[i]);
+  }
+
+  return triangulation;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void PolygonCalculator::refineMesh(Edge2 const& edge, int count, double h1, double h2,
+    double hAvg, double const* dividingHeights, bool& fine) {
+
+  // Middle point of the edge on voronoi plane
+  glm::dvec2 avgPoint2 =
+      glm::dvec2((edge.first.mX + edge.second.mX) / 2, (edge.first.mY + edge.second.mY) / 2);
+
+  // Checks height of the middle point
+  if (exceedsHeightDiff(hAvg, (h1 + h2) / 2)) {
+    mCornersFine[count].emplace_back(
+        avgPoint2.x, avgPoint2.y, static_cast<uint32_t>(mCornersFine[count].size()));
+    fine = false;
+  }
+  // Checks height of other points between the two Sites
+  else {
+    std::vector<glm::dvec2> points;
+
+    // Trisecting points, etc.
+    size_t k = 0;
+    for (int j = 3; j < 6; j++) {
+      // Checks "level" only if no points were emplaced back form the previous cycle
+      if (fine) {
+        points.clear();
+        getDividingPoints(edge, j, points);
+
+        for (int i = 1; i < j; i++) {
+          if (exceedsHeightDiff(dividingHeights[k + i - 1], (i * h1 + (j - i) * h2) / j)) {
+            mCornersFine[count].emplace_back(points[i - 1].x, points[i - 1].y,
+                static_cast<uint32_t>(mCornersFine[count].size()));
+            fine = false;
+          }
+        }
+      }
+
+      k += j - 1;
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void PolygonCalculator::getDividingPoints(
+    Edge2 const& edge, int parts, std::vector<glm::dvec2>& points) {
+  for (int i = 1; i < parts; i++) {
+    points.emplace_back((i * edge.first.mX + (parts - i) * edge.second.mX) / parts,
+        (i * edge.first.mY + (parts - i) * edge.second.mY) / parts);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool PolygonCalculator::exceedsHeightDiff(double height, double expected) const {
+  return (height / expected > mInput.mHeightDiff) || (expected / height > mInput.mHeightDiff);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void PolygonCalculator::sampleHeights(projection::TangentPlane const& plane, double radius,
+    std::vector<glm::dvec2> const& points, std::vector<double>& heights) {
+  std::vector<glm::dvec3> positions;
+  std::vector<glm::dvec2> lngLats;
+
+  projection::planeToSurface(plane, radius, points, positions);
+  projection::toLngLat(positions, lngLats);
+  mHeightCache.getHeights(lngLats, heights);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void PolygonCalculator::calculateAreaAndVolume(std::vector<Triangle> const& triangles,
+    SiteArray const& sites, double mdist, glm::dvec3 const& e, glm::dvec3 const& n,
+    glm::dvec3 const& r, double& area, double& pvol, double& nvol) {
+  // The sites are shared by several triangles, therefore all of them are projected at once
+  std::vector<glm::dvec2> points(sites.size());
+  for (size_t i = 0; i < sites.size(); ++i) {
+    points[i] = glm::dvec2(sites.mX[i], sites.mY[i]);
+  }
+
+  std::vector<glm::dvec3> surfacePositions;
+  std::vector<glm::dvec2> lngLats;
+  std::vector<double>     heights;
+  std::vector<glm::dvec3> positions;
+
+  // Cartesian coordinates without height, LongLat coordinates, heights of the points and
+  // Cartesian coordinates with height
+  projection::planeToSurface({mMiddlePoint, e, n, mdist}, r[0], points, surfacePositions);
+  projection::toLngLat(surfacePositions, lngLats);
+  mHeightCache.getHeights(lngLats, heights);
+  projection::toCartesian(r[0], lngLats, heights, 1.0, positions);
+
+  std::vector<VolumeTriangle> volumeTriangles;
+  volumeTriangles.reserve(triangles.size());
+
+  // Counts area and volume in every triangle
+  for (const auto& triangle : triangles) {
+    // ------------------------------------------ AREA ------------------------------------------
+    glm::dvec3 const& p1 = surfacePositions[triangle[0]];
+    glm::dvec3 const& p2 = surfacePositions[triangle[1]];
+    glm::dvec3 const& p3 = surfacePositions[triangle[2]];
+
+    double h1 = heights[triangle[0]];
+    double h2 = heights[triangle[1]];
+    double h3 = heights[triangle[2]];
+
+    glm::dvec3 const& r1 = positions[triangle[0]];
+    glm::dvec3 const& r2 = positions[triangle[1]];
+    glm::dvec3 const& r3 = positions[triangle[2]];
+
+    // Area is the half of the cross product of two edges in triangle
+    area += glm::length(glm::cross(r2 - r1, r3 - r1)) / 2;
+
+    // ----------------------------------------- Volume -----------------------------------------
+
+    // Heights over the least squares plane
+    double hl1 = getHeightOverPlane(p1, h1);
+    double hl2 = getHeightOverPlane(p2, h2);
+    double hl3 = getHeightOverPlane(p3, h3);
+
+    volumeTriangles.push_back({{p1, p2, p3}, {hl1, hl2, hl3}});
+  }
+
+  calculateVolumes(std::move(volumeTriangles), r[0], pvol, nvol);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+double PolygonCalculator::getHeightOverPlane(glm::dvec3 const& position, double height) const {
+  if (mInput.mReferenceHeight) {
+    return height - *mInput.mReferenceHeight;
+  }
+
+  return height - (glm::dot(mNormal2, mMiddlePoint2) / glm::dot(mNormal2, position) - 1) *
+                      glm::length(mMiddlePoint2);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void PolygonCalculator::sampleHeightsOverPlane(
+    std::vector<glm::dvec3> const& positions, double radius, std::vector<double>& heights) {
+  std::vector<glm::dvec2> lngLats(positions.size());
+  for (size_t i = 0; i < positions.size(); ++i) {
+    lngLats[i] = cs::utils::convert::toLngLatHeight(positions[i], radius, radius).xy();
+  }
+
+  mHeightCache.getHeights(lngLats, heights);
+
+  for (size_t i = 0; i < positions.size(); ++i) {
+    heights[i] = getHeightOverPlane(positions[i], heights[i]);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void PolygonCalculator::findPlaneIntersections(std::vector<PlaneCrossing> const& crossings,
+    double radius, std::vector<glm::dvec3>& intersections) {
+
+  // The intersection is bracketed by [mA, mB]. The edge is parametrized from 0 to 1, so the
+  // tolerance in meters is converted to this parameter
+  struct Bracket {
+    double mA     = 0.0;
+    double mB     = 1.0;
+    double mFA    = 0.0;
+    double mFB    = 0.0;
+    double mTol   = 1.0;
+    int    mSide  = 0;
+    bool   mFound = false;
+  };
+
+  auto pointOnEdge = [&](size_t i, double t) {
+    return glm::normalize((1 - t) * crossings[i].mStart + t * crossings[i].mEnd) * radius;
+  };
+
+  std::vector<Bracket> brackets(crossings.size());
+  intersections.resize(crossings.size());
+
+  for (size_t i = 0; i < crossings.size(); ++i) {
+    double length    = glm::length(crossings[i].mEnd - crossings[i].mStart);
+    brackets[i].mFA  = crossings[i].mStartHeight;
+    brackets[i].mFB  = crossings[i].mEndHeight;
+    brackets[i].mTol = length > 0.0 ? mInput.mIntersectionTolerance / length : 1.0;
+  }
+
+  std::vector<size_t>     active;
+  std::vector<double>     ts;
+  std::vector<glm::dvec3> positions;
+  std::vector<double>     heights;
+
+  for (int iteration = 0; iteration < MAX_INTERSECTION_ITERATIONS; ++iteration) {
+    active.clear();
+    ts.clear();
+    positions.clear();
+
+    // Regula falsi step of all brackets which are not small enough yet
+    for (size_t i = 0; i < brackets.size(); ++i) {
+      Bracket const& b = brackets[i];
+
+      if (!b.mFound && b.mB - b.mA > b.mTol) {
+        double t = (b.mA * b.mFB - b.mB * b.mFA) / (b.mFB - b.mFA);
+        active.push_back(i);
+        ts.push_back(t);
+        positions.push_back(pointOnEdge(i, t));
+      }
+    }
+
+    if (active.empty()) {
+      break;
+    }
+
+    sampleHeightsOverPlane(positions, radius, heights);
+
+    for (size_t j = 0; j < active.size(); ++j) {
+      Bracket& b  = brackets[active[j]];
+      double   t  = ts[j];
+      double   ft = heights[j];
+
+      if (ft == 0.0) {
+        intersections[active[j]] = positions[j];
+        b.mFound                 = true;
+        continue;
+      }
+
+      // If the same end of the bracket is kept twice in a row, its value is halved (Illinois
+      // method), as the bracket would shrink only from one side otherwise
+      if ((ft > 0) == (b.mFB > 0)) {
+        b.mB  = t;
+        b.mFB = ft;
+        if (b.mSide == -1) {
+          b.mFA /= 2;
+        }
+        b.mSide = -1;
+      } else {
+        b.mA  = t;
+        b.mFA = ft;
+        if (b.mSide == 1) {
+          b.mFB /= 2;
+        }
+        b.mSide = 1;
+      }
+    }
+  }
+
+  for (size_t i = 0; i < brackets.size(); ++i) {
+    Bracket const& b = brackets[i];
+
+    if (!b.mFound) {
+      intersections[i] = pointOnEdge(i, (b.mA * b.mFB - b.mB * b.mFA) / (b.mFB - b.mFA));
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void PolygonCalculator::calculateVolumes(
+    std::vector<VolumeTriangle> triangles, double radius, double& pvol, double& nvol) {
+
+  // Returns the index of the corner which is on the other side of the least squares plane than
+  // the two others, or -1 if all corners are on the same side
+  auto getLoneCorner = [](VolumeTriangle const& triangle) {
+    bool above1 = triangle.mHeights[0] > 0;
+    bool above2 = triangle.mHeights[1] > 0;
+    bool above3 = triangle.mHeights[2] > 0;
+
+    if (above1 == above2) {
+      return above1 == above3 ? -1 : 2;
+    }
+
+    return above1 == above3 ? 1 : 0;
+  };
+
+  // Triangles which cross the plane exactly twice
+  std::vector<VolumeTriangle> crossing;
+
+  for (int depth = 0; !triangles.empty(); ++depth) {
+    std::vector<VolumeTriangle> straddling;
+
+    for (auto const& triangle : triangles) {
+      auto const& p  = triangle.mCorners;
+      auto const& hl = triangle.mHeights;
+
+      // If all of the triangle's corners' are on the same size of the least square plane
+      if (getLoneCorner(triangle) < 0) {
+        // Base area: planet surface without heights / least square plane
+        double baseArea = glm::length(glm::cross(p[1] - p[0], p[2] - p[0])) / 2;
+        // Volume is the multiplication of surface and average height over the plane
+        double volume = baseArea * ((hl[0] + hl[1] + hl[2]) / 3);
+
+        // Counts positive and negative volumes separately
+        if (volume > 0) {
+          pvol += volume;
+        } else {
+          nvol += volume;
+        }
+      } else if (depth < MAX_VOLUME_REFINEMENT) {
+        straddling.push_back(triangle);
+      } else {
+        crossing.push_back(triangle);
+      }
+    }
+
+    triangles.clear();
+
+    if (straddling.empty()) {
+      break;
+    }
+
+    // If the triangle straddles the plane, exactly two of its edges cross it. The third edge may
+    // still cross the plane twice, e.g. if a ridge runs through the triangle. This is the case if
+    // its middle point is on the other side than both of its ends. Then the triangle is split in
+    // four and each part is processed on its own. The middle points of the third edges of all
+    // triangles are queried first, the other middle points only for the triangles which are split
+    std::vector<glm::dvec3> positions(straddling.size());
+    std::vector<double>     heights;
+
+    for (size_t i = 0; i < straddling.size(); ++i) {
+      auto const& p    = straddling[i].mCorners;
+      int         lone = getLoneCorner(straddling[i]);
+      positions[i]     = glm::normalize(p[(lone + 1) % 3] + p[(lone + 2) % 3]) * radius;
+    }
+
+    sampleHeightsOverPlane(positions, radius, heights);
+
+    std::vector<VolumeTriangle> split;
+
+    for (size_t i = 0; i < straddling.size(); ++i) {
+      int  lone  = getLoneCorner(straddling[i]);
+      bool above = straddling[i].mHeights[(lone + 1) % 3] > 0;
+
+      if ((heights[i] > 0) == above) {
+        crossing.push_back(straddling[i]);
+      } else {
+        split.push_back(straddling[i]);
+      }
+    }
+
+    positions.resize(3 * split.size());
+    for (size_t i = 0; i < split.size(); ++i) {
+      auto const& p        = split[i].mCorners;
+      positions[3 * i]     = glm::normalize(p[0] + p[1]) * radius;
+      positions[3 * i + 1] = glm::normalize(p[0] + p[2]) * radius;
+      positions[3 * i + 2] = glm::normalize(p[1] + p[2]) * radius;
+    }
+
+    sampleHeightsOverPlane(positions, radius, heights);
+
+    for (size_t i = 0; i < split.size(); ++i) {
+      auto const& p  = split[i].mCorners;
+      auto const& hl = split[i].mHeights;
+
+      glm::dvec3 const& m12  = positions[3 * i];
+      glm::dvec3 const& m13  = positions[3 * i + 1];
+      glm::dvec3 const& m23  = positions[3 * i + 2];
+      double            hl12 = heights[3 * i];
+      double            hl13 = heights[3 * i + 1];
+      double            hl23 = heights[3 * i + 2];
+
+      triangles.push_back({{p[0], m12, m13}, {hl[0], hl12, hl13}});
+      triangles.push_back({{m12, p[1], m23}, {hl12, hl[1], hl23}});
+      triangles.push_back({{m13, m23, p[2]}, {hl13, hl23, hl[2]}});
+      triangles.push_back({{m12, m23, m13}, {hl12, hl23, hl13}});
+    }
+  }
+
+  // Find the intersection points with the least square plane and split each triangle into a
+  // smaller triangle around the corner on the one side and a quadrilateral on the other side.
+  // The corners are rotated, so that a is the corner of the smaller triangle
+  std::vector<PlaneCrossing> crossings(2 * crossing.size());
+
+  for (size_t i = 0; i < crossing.size(); ++i) {
+    auto const& p  = crossing[i].mCorners;
+    auto const& hl = crossing[i].mHeights;
+    int         a  = getLoneCorner(crossing[i]);
+    int         b  = (a + 1) % 3;
+    int         c  = (a + 2) % 3;
+
+    crossings[2 * i]     = {p[a], p[b], hl[a], hl[b]};
+    crossings[2 * i + 1] = {p[a], p[c], hl[a], hl[c]};
+  }
+
+  std::vector<glm::dvec3> intersections;
+  findPlaneIntersections(crossings, radius, intersections);
+
+  for (size_t i = 0; i < crossing.size(); ++i) {
+    auto const& p  = crossing[i].mCorners;
+    auto const& hl = crossing[i].mHeights;
+    int         a  = getLoneCorner(crossing[i]);
+    int         b  = (a + 1) % 3;
+    int         c  = (a + 2) % 3;
+
+    glm::dvec3 const& pAB = intersections[2 * i];
+    glm::dvec3 const& pAC = intersections[2 * i + 1];
+
+    // Area of the smaller triangle
+    double baseArea1 = glm::length(glm::cross(pAB - p[a], pAC - p[a])) / 2;
+    // Area of the quadrilateral
+    double baseArea2 = glm::length(glm::cross(pAB - p[c], pAC - p[c])) / 2 +
+                       glm::length(glm::cross(pAB - p[b], p[c] - p[b])) / 2;
+
+    // Decide the sign of the volume based on the height of the corner in the small triangle
+    // (Heights of intersections are considered to be 0)
+    if (hl[a] > 0) {
+      pvol += baseArea1 * hl[a] / 3;
+      nvol += baseArea2 * ((hl[b] + hl[c]) / 4);
+    } else {
+      nvol += baseArea1 * hl[a] / 3;
+      pvol += baseArea2 * ((hl[b] + hl[c]) / 4);
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+PolygonCalculator::TriangleResult PolygonCalculator::refineTriangle(size_t count,
+    size_t pointOffset, uint32_t attempt, double mdist, glm::dvec3 const& e, glm::dvec3 const& n,
+    glm::dvec3 const& r) {
+  TriangleResult result;
+
+  // Checks sleekness of triangles in Delaunay-mesh and refines them, if necessary
+  bool refine = false;
+  {
+    Statistics::ScopedTimer timer(result.mStatistics, Statistics::Stage::eCheckSleekness);
+    refine = checkSleekness(static_cast<int32_t>(count));
+  }
+
+  // Voronoi inside the original triangles - to refine triangle angles
+  VoronoiGenerator const& voronoiRefine = updateTriangulation(static_cast<int32_t>(count));
+  auto const&             edges         = voronoiRefine.getTriangulation();
+
+  projection::TangentPlane plane{mMiddlePoint, e, n, mdist};
+
+  // Both end points of all edges. No need for checkPoint, all of the edges are inside the
+  // triangle and the polygon
+  std::vector<glm::dvec2> points(2 * edges.size());
+  for (size_t i = 0; i < edges.size(); ++i) {
+    points[2 * i]     = glm::dvec2(edges[i].first.mX, edges[i].first.mY);
+    points[2 * i + 1] = glm::dvec2(edges[i].second.mX, edges[i].second.mY);
+  }
+
+  std::vector<glm::dvec3> positions;
+  std::vector<glm::dvec2> lngLats;
+  std::vector<double>     heights;
+
+  // Calculates mesh coordinates on planet's surface and saves these coordinates for display
+  projection::planeToSurface(plane, r[0], points, positions);
+  projection::toLngLat(positions, lngLats);
+  mHeightCache.getHeights(lngLats, heights);
+  projection::toSurfaceSamples(lngLats, heights, result.mTriangulation);
+
+  // If not too many points are addded in checkSleekness and it is not the the last attempt
+  // than refines the mesh based on edge length and height differences
+  if ((!refine) && (pointOffset < mInput.mMaxPoints) && (attempt < mInput.mMaxAttempt)) {
+    Statistics::ScopedTimer timer(result.mStatistics, Statistics::Stage::eRefineMesh);
+
+    // Heights of the middle points of all edges
+    std::vector<glm::dvec2> middlePoints(edges.size());
+    std::vector<double>     middleHeights;
+
+    for (size_t i = 0; i < edges.size(); ++i) {
+      middlePoints[i] = glm::dvec2((edges[i].first.mX + edges[i].second.mX) / 2,
+          (edges[i].first.mY + edges[i].second.mY) / 2);
+    }
+
+    sampleHeights(plane, r[0], middlePoints, middleHeights);
+
+    // The points which divide the edges into three, four and five parts are only checked as long
+    // as no point has been added to this triangle. Hence each level is only needed for the edges
+    // before the first one where a point is added. The levels are queried one after another, each
+    // with one batch for all of these edges
+    size_t limit = 0;
+    while (limit < edges.size() &&
+           !exceedsHeightDiff(
+               middleHeights[limit], (heights[2 * limit] + heights[2 * limit + 1]) / 2)) {
+      ++limit;
+    }
+
+    std::vector<double>     dividingHeights(edges.size() * DIVIDING_POINTS);
+    std::vector<glm::dvec2> levelPoints;
+    std::vector<double>     levelHeights;
+    size_t                  offset = 0;
+
+    for (int j = 3; j < 6; j++) {
+      levelPoints.clear();
+      for (size_t i = 0; i < limit; ++i) {
+        getDividingPoints(edges[i], j, levelPoints);
+      }
+
+      sampleHeights(plane, r[0], levelPoints, levelHeights);
+
+      size_t firstAdded = limit;
+      for (size_t i = 0; i < limit; ++i) {
+        double h1 = heights[2 * i];
+        double h2 = heights[2 * i + 1];
+
+        for (int k = 1; k < j; k++) {
+          double height = levelHeights[i * (j - 1) + k - 1];
+          dividingHeights[i * DIVIDING_POINTS + offset + k - 1] = height;
+
+          if (firstAdded == limit && exceedsHeightDiff(height, (k * h1 + (j - k) * h2) / j)) {
+            firstAdded = i;
+          }
+        }
+      }
+
+      limit = firstAdded;
+      offset += j - 1;
+    }
+
+    for (size_t i = 0; i < edges.size(); ++i) {
+      refineMesh(edges[i], static_cast<int32_t>(count), heights[2 * i], heights[2 * i + 1],
+          middleHeights[i], &dividingHeights[i * DIVIDING_POINTS], result.mFine);
+    }
+  }
+
+  // Calculates area and volume
+  {
+    Statistics::ScopedTimer timer(result.mStatistics, Statistics::Stage::eAreaAndVolume);
+    calculateAreaAndVolume(voronoiRefine.getTriangles(), voronoiRefine.getSites(), mdist, e, n,
+        r, result.mArea, result.mPosVolume, result.mNegVolume);
+  }
+
+  return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool PolygonCalculator::computeTiles(std::atomic_bool const& cancel,
+    std::vector<glm::dvec3> const& corners, double referenceHeight) {
+  auto tilesPerFace = static_cast<uint32_t>(std::ceil(90.0 / mInput.mTileAngle));
+  auto parts        = tiling::split(corners, tilesPerFace);
+
+  // Each part is calculated like a small polygon, but with the common reference height
+  std::vector<std::unique_ptr<PolygonCalculator>> tiles;
+
+  for (auto const& part : parts) {
+    Input input            = mInput;
+    input.mTileAngle       = 0.F;
+    input.mReferenceHeight = referenceHeight;
+    input.mPositions.clear();
+
+    for (auto const& direction : part) {
+      input.mPositions.push_back(direction * mInput.mRadii[0]);
+    }
+
+    tiles.push_back(std::make_unique<PolygonCalculator>(std::move(input)));
+  }
+
+  // The tiles refine their triangles on the same pool, which is fine as parallelFor() works on
+  // the tasks itself while it waits.
+  auto computeTile = [&](size_t i) {
+    if (!cancel.load()) {
+      tiles[i]->compute(cancel);
+    }
+  };
+
+  if (mInput.mThreadPool) {
+    mInput.mThreadPool->parallelFor(tiles.size(), computeTile);
+  } else {
+    for (size_t i = 0; i < tiles.size(); ++i) {
+      computeTile(i);
+    }
+  }
+
+  if (cancel.load()) {
+    return false;
+  }
+
+  // The totals would be too small if a tile was missing, so the whole polygon fails then
+  for (auto const& tile : tiles) {
+    if (!tile->getResult().mValid) {
+      mResult.mStatistics.add(Statistics::Counter::eTiles, tiles.size());
+      return true;
+    }
+  }
+
+  // The levels of the tiles are merged from the finest one on. Tiles with fewer levels contribute
+  // their coarsest level to the remaining ones. The seams are not stitched: each tile refines the
+  // edges along its seams on its own, so neighboring tiles may have different vertices there.
+  size_t levelCount = 0;
+
+  for (auto const& tile : tiles) {
+    auto const& result = tile->getResult();
+
+    mResult.mArea += result.mArea;
+    mResult.mPosVolume += result.mPosVolume;
+    mResult.mNegVolume += result.mNegVolume;
+    mResult.mStatistics.merge(result.mStatistics);
+
+    levelCount = std::max(levelCount, result.mMesh.size());
+  }
+
+  mResult.mMesh.resize(levelCount);
+
+  for (size_t i = 0; i < levelCount; ++i) {
+    MeshLevel& mesh = mResult.mMesh[levelCount - 1 - i];
+
+    for (auto const& tile : tiles) {
+      auto const& levels = tile->getResult().mMesh;
+
+      if (levels.empty()) {
+        continue;
+      }
+
+      auto const& level  = levels[levels.size() - 1 - std::min(i, levels.size() - 1)];
+      auto        offset = static_cast<uint32_t>(mesh.mVertices.size());
+
+      mesh.mVertices.append(level.mVertices, 0, level.mVertices.size());
+      for (uint32_t index : level.mEdges) {
+        mesh.mEdges.push_back(index + offset);
+      }
+    }
+  }
+
+  pruneMeshLevels(mResult.mMesh);
+
+  mResult.mStatistics.add(Statistics::Counter::eTiles, tiles.size());
+  mResult.mStatistics.add(Statistics::Counter::eHeightQueries, mHeightCache.getMisses());
+  mResult.mStatistics.add(Statistics::Counter::eHeightCacheHits, mHeightCache.getHits());
+
+  mResult.mValid = true;
+
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Creates a new plane normal to the middle of the polygon and projects the polygon points to
+// this plane and generates a Delaunay-mesh on this plane and calculates the area and volume
+// of the original polygon using this mesh
+bool PolygonCalculator::compute(std::atomic_bool const& cancel) {
+  mCorners.clear();
+  mCornersFine.clear();
+  mTriangulations.clear();
+  mResult = Result();
+
+  // Returns if no triangle can be created
+  if (mInput.mPositions.size() < 3) {
+    return true;
+  }
+
+  auto radii = mInput.mRadii;
+
+  // All stages below query the terrain for many identical locations, so the heights are cached
+  // for the duration of this calculation
+  mHeightCache.reset(mInput.mHeightSource, mInput.mBatchHeightSource);
+
+  // Middle point of the polygon's corners
+  glm::dvec3 averagePosition(0.0);
+  for (auto const& position : mInput.mPositions) {
+    averagePosition += position / static_cast<double>(mInput.mPositions.size());
+  }
+
+  // Corrected positions of the corners (works for every height scale)
+  std::vector<glm::dvec3> positionsNorm;
+  std::vector<glm::dvec2> lngLats;
+  std::vector<double>     heights;
+
+  projection::toSurface(radii[0], mInput.mPositions, positionsNorm);
+  projection::toLngLat(positionsNorm, lngLats);
+  mHeightCache.getHeights(lngLats, heights);
+  projection::toCartesian(radii[0], lngLats, heights, 1.0, positionsNorm);
+
+  // Corrected average position
+  glm::dvec3 averagePositionNorm(0.0);
+  for (auto const& posNorm : positionsNorm) {
+    averagePositionNorm += posNorm / static_cast<double>(mInput.mPositions.size());
+  }
+
+  // Large polygons are split into tiles. Their volume is measured relative to the average height
+  // of the corners, as a least squares plane does not follow the curvature of the body.
+  if (mInput.mTileAngle > 0.F && glm::length(averagePosition) > 0.0) {
+    glm::dvec3 middle   = glm::normalize(averagePosition);
+    double     maxAngle = 0.0;
+
+    std::vector<glm::dvec3> directions;
+    for (auto const& posNorm : positionsNorm) {
+      directions.push_back(glm::normalize(posNorm));
+      maxAngle = std::max(maxAngle, std::acos(std::clamp(glm::dot(middle, directions.back()),
+                                        -1.0, 1.0)));
+    }
+
+    if (2.0 * glm::degrees(maxAngle) > mInput.mTileAngle) {
+      double referenceHeight = 0.0;
+      for (double height : heights) {
+        referenceHeight += height / static_cast<double>(heights.size());
+      }
+
+      return computeTiles(cancel, directions, referenceHeight);
+    }
+  }
+
+  // Longest distance to average position
+  double maxDist = 0;
+  for (auto const& position : mInput.mPositions) {
+    double dist = glm::length(averagePosition - position);
+    if (dist > maxDist) {
+      maxDist = dist;
+    }
+  }
+
+  // If polygon is to big (disable area calculation and mesh generation)
+  // Voronoi implementation is designed for a maximal area of one hemisphere
+  if (maxDist > radii[0]) {
+    return true;
+  }
+  // Converts maxDist to Voronoi plane (approx.)
+  // 1.2 is for safety -> makes sure, that the voronoi coordinates are under 1
+  maxDist = 1.2 * maxDist * radii[0] / (std::sqrt(std::pow(radii[0], 2) - std::pow(maxDist, 2)));
+
+  // Planes normal is perpendicular to the average position
+  mNormal      = glm::normalize(averagePosition);
+  mMiddlePoint = mNormal * radii[0];
+  // Coordinate system of the plane
+  glm::dvec3 east(0.0);
+  glm::dvec3 north(0.0);
+
+  if (mNormal.y != 0) {
+    // Normal and north is perpendicular -> dot product is 0
+    double yNorth = (std::pow(mNormal.x, 2) + std::pow(mNormal.z, 2)) / mNormal.y;
+    north         = glm::normalize(glm::dvec3(-mNormal.x, yNorth, -mNormal.z));
+    // Changes south to north on the southern hemisphere
+    if (yNorth < 0) {
+      north = glm::normalize(glm::dvec3(mNormal.x, -yNorth, mNormal.z));
+    }
+  } else {
+    // If plane normal is perpendicular to y axes, north is y
+    north = glm::dvec3(0, 1, 0);
+  }
+
+  east = -glm::cross(mNormal, north);
+
+  // The least squares plane of the corners is the reference of the volume calculation. If the
+  // corners are collinear, the tangent plane at their middle is used.
+  PlaneFit fit(averagePositionNorm);
+  for (auto const& posNorm : positionsNorm) {
+    fit.add(posNorm);
+  }
+
+  PlaneFit::Plane plane;
+  plane.mCenter = averagePositionNorm;
+  plane.mNormal = glm::normalize(averagePositionNorm);
+  fit.solve(mNormal, plane);
+
+  mNormal2      = plane.mNormal;
+  mMiddlePoint2 = plane.mCenter;
+
+  // Projects points to Voronoi plane and calculates their position in the new coordinate system
+  int        addr = 0;
+  glm::dvec3 lastPosition{0};
+
+  for (auto const& currentPosition : mInput.mPositions) {
+    // Filters out double points
+    if (currentPosition != lastPosition) {
+      // Corrects distance from origin (average point is inside of the sphere)
+      double     k   = glm::dot(mNormal, mMiddlePoint) / glm::dot(mNormal, currentPosition);
+      glm::dvec3 pos = k * currentPosition;
+
+      // Coordinates on the plane
+      double x = glm::dot(east, pos - mMiddlePoint);
+      double y = glm::dot(north, pos - mMiddlePoint);
+
+      // Avoids crashing when moving to the other side of the planet
+      if ((std::isnan(x / maxDist)) || (std::isnan(y / maxDist))) {
+        return true;
+      }
+
+      // Saves coordinates normalized with maxDist
+      mCorners.emplace_back(x / maxDist, y / maxDist, addr);
+
+      lastPosition = currentPosition;
+      addr++;
+    }
+  }
+
+  // Vector to save triangles from voronoi generator
+  std::vector<Triangle> triangles;
+  SiteArray             sites;
+
+  // Creates Delaunay-mesh of the original polygon
+  {
+    Statistics::ScopedTimer timer(mResult.mStatistics, Statistics::Stage::eCreateMesh);
+    createMesh(triangles, sites);
+  }
+
+  if (cancel.load()) {
+    return false;
+  }
+
+  // Each triangle of the original Delaunay-mesh is refined separately with its own triangulation
+  for (auto const& t : triangles) {
+    // Emplaces back the 3 corners of the triangle
+    SiteArray corners;
+    corners.emplace_back(sites.mX[t[0]], sites.mY[t[0]], 0);
+    corners.emplace_back(sites.mX[t[1]], sites.mY[t[1]], 1);
+    corners.emplace_back(sites.mX[t[2]], sites.mY[t[2]], 2);
+
+    mCornersFine.emplace_back(corners);
+
+    mTriangulations.push_back(std::make_unique<VoronoiGenerator>());
+    mTriangulations.back()->parse(corners);
+  }
+
+  bool     fine       = false;
+  bool     converged  = false;
+  uint32_t attempt    = 0;
+  double   area       = 0;
+  double   negVolume  = 0;
+  double   posVolume  = 0;
+  size_t   pointCount = 0;
+
+  // Counts points of the original Delaunay-mesh
+  for (auto const& vect : mCornersFine) {
+    pointCount += vect.size();
+  }
+
+  std::vector<TriangleResult> results(mCornersFine.size());
+  std::vector<size_t>         pointOffsets(mCornersFine.size());
+
+  // Refines triangulation until it is necessary or mMaxAttempt or mMaxPoints or until the results
+  // do not change anymore
+  while ((!fine) && (!converged) && (attempt < mInput.mMaxAttempt) &&
+         (pointCount < mInput.mMaxPoints)) {
+    attempt++;
+
+    // Number of points in all preceding triangles. A triangle is only refined further if these
+    // are below mMaxPoints. The counts from before this attempt are used, so that the result does
+    // not depend on the order in which the triangles are processed.
+    pointCount = 0;
+    for (size_t i = 0; i < mCornersFine.size(); ++i) {
+      pointOffsets[i] = pointCount;
+      pointCount += mCornersFine[i].size();
+    }
+
+    auto refine = [&](size_t i) {
+      // A newer calculation is pending, so this result would be discarded anyway
+      if (!cancel.load()) {
+        results[i] = refineTriangle(i, pointOffsets[i], attempt, maxDist, east, north, radii);
+      }
+    };
+
+    if (mInput.mThreadPool) {
+      mInput.mThreadPool->parallelFor(mCornersFine.size(), refine);
+    } else {
+      for (size_t i = 0; i < mCornersFine.size(); ++i) {
+        refine(i);
+      }
+    }
+
+    if (cancel.load()) {
+      return false;
+    }
+
+    Progress previous{attempt - 1, area, posVolume, negVolume};
+
+    // Reduces the results in a fixed order, so that the sums do not depend on the scheduling
+    fine       = true;
+    area       = 0;
+    negVolume  = 0;
+    posVolume  = 0;
+    pointCount = 0;
+
+    for (size_t i = 0; i < results.size(); ++i) {
+      fine = fine && results[i].mFine;
+      area += results[i].mArea;
+      posVolume += results[i].mPosVolume;
+      negVolume += results[i].mNegVolume;
+      pointCount += mCornersFine[i].size();
+      mResult.mStatistics.merge(results[i].mStatistics);
+    }
+
+    mResult.mMesh.push_back(createMeshLevel(results));
+
+    // Publishes the current estimate. The relative change of the volumes is measured against the
+    // total volume, so that a tiny positive or negative part does not prevent convergence
+    Progress progress{attempt, area, posVolume, negVolume};
+
+    if (attempt > 1) {
+      auto relativeChange = [](double a, double b, double scale) {
+        return scale > 0.0 ? std::abs(a - b) / scale : 0.0;
+      };
+
+      double totalVolume = std::abs(posVolume) + std::abs(negVolume);
+
+      progress.mChange = std::max({relativeChange(area, previous.mArea, std::abs(area)),
+          relativeChange(posVolume, previous.mPosVolume, totalVolume),
+          relativeChange(negVolume, previous.mNegVolume, totalVolume)});
+
+      converged = progress.mChange < mInput.mConvergenceThreshold;
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(mProgressMutex);
+      mProgress        = progress;
+      mProgressUpdated = true;
+    }
+  } // while ((!fine) && (!converged) && (attempt < mMaxAttempt) && (pointCount < mMaxPoints))
+
+  pruneMeshLevels(mResult.mMesh);
+
+  // Includes the parse() calls of the triangulations before the first attempt and during insert()
+  for (auto const& triangulation : mTriangulations) {
+    mResult.mStatistics.merge(triangulation->getStatistics());
+  }
+
+  mResult.mStatistics.add(Statistics::Counter::eAttempts, attempt);
+  mResult.mStatistics.add(Statistics::Counter::ePoints, pointCount);
+  mResult.mStatistics.add(Statistics::Counter::eHeightQueries, mHeightCache.getMisses());
+  mResult.mStatistics.add(Statistics::Counter::eHeightCacheHits, mHeightCache.getHits());
+
+  mResult.mValid     = true;
+  mResult.mArea      = std::isnan(area) ? 0.0 : area;
+  mResult.mPosVolume = std::isnan(posVolume) ? 0.0 : posVolume;
+  mResult.mNegVolume = std::isnan(negVolume) ? 0.0 : negVolume;
+
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+} // namespace csp::measurementtools
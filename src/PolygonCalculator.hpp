@@ -0,0 +1,281 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//                               This file is part of CosmoScout VR                               //
+//      and may be used under the terms of the MIT license. See the LICENSE file for details.     //
+//                        Copyright: (c) 2019 German Aerospace Center (DLR)                       //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef CSP_MEASUREMENT_TOOLS_POLYGON_CALCULATOR_HPP
+#define CSP_MEASUREMENT_TOOLS_POLYGON_CALCULATOR_HPP
+
+#include "HeightCache.hpp"
+#include "Statistics.hpp"
+#include "SurfaceProjection.hpp"
+#include "ThreadPool.hpp"
+#include "voronoi/VoronoiGenerator.hpp"
+
+#include <glm/glm.hpp>
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+namespace csp::measurementtools {
+
+/// Calculates the Delaunay-mesh, the area and the volume of a polygon on the surface of a body.
+/// It operates on a snapshot of the polygon and does not access any scene graph or OpenGL state,
+/// therefore it can be run on a worker thread. The PolygonTool creates a new instance for each
+/// calculation.
+///
+/// The mesh is created in a single tangent plane, which distorts large polygons and does not work
+/// at all for polygons larger than a hemisphere. Therefore large polygons are split into tiles
+/// with tiling::split(), each of which is calculated by a PolygonCalculator of its own in its own
+/// tangent plane. The results of the tiles are summed afterwards.
+class PolygonCalculator {
+ public:
+  struct Input {
+    /// Cartesian positions of the polygon's corners, relative to the body's center. These may be
+    /// exaggerated by the height scale.
+    std::vector<glm::dvec3> mPositions;
+
+    glm::dvec3 mRadii = glm::dvec3(0.0);
+
+    /// Is used for all terrain height queries. As the calculation may run on a worker thread,
+    /// this has to be safe to call from any thread. CelestialBody::getHeight() is not, the tools
+    /// pass the sources of a HeightProvider instead.
+    HeightCache::HeightSource mHeightSource;
+
+    /// If set, this is used to query the heights of many points with one request. This has to be
+    /// safe to call from any thread as well.
+    HeightCache::BatchHeightSource mBatchHeightSource;
+
+    /// The triangles of the mesh are refined in parallel on this pool. If it is not set, they are
+    /// processed one after another on the calling thread. This is not owned by the calculator, as
+    /// the calculation itself runs on the pool and the pool waits for it on destruction.
+    ThreadPool* mThreadPool = nullptr;
+
+    // For triangle fineness
+    float    mHeightDiff = 1.002F;
+    uint32_t mMaxAttempt = 10;
+    uint32_t mMaxPoints  = 1000;
+    uint32_t mSleekness  = 15;
+
+    /// The accuracy in meters of the points where the terrain crosses the least squares plane of
+    /// the volume calculation.
+    float mIntersectionTolerance = 1.F;
+
+    /// The refinement stops once the relative change of area and volume between two attempts is
+    /// below this value.
+    float mConvergenceThreshold = 0.F;
+
+    /// Polygons which span more than this angle in degrees are split into tiles of about this
+    /// size. Each tile is refined up to the limits above. If this is zero, all polygons are
+    /// calculated in one tangent plane, which fails for polygons larger than a hemisphere. Values
+    /// below MIN_TILE_ANGLE are raised to it. The seams between the tiles are not stitched, so the
+    /// merged mesh may have T-junctions along them.
+    float mTileAngle = 0.F;
+
+    /// If set, the volume is measured relative to the sphere with this height above the surface
+    /// instead of the least squares plane of the corners. This is used for the tiles of a large
+    /// polygon, so that their volumes share one reference.
+    std::optional<double> mReferenceHeight;
+  };
+
+  /// The estimate of area and volume after a refinement attempt.
+  struct Progress {
+    uint32_t mAttempt   = 0;
+    double   mArea      = 0.0;
+    double   mPosVolume = 0.0;
+    double   mNegVolume = 0.0;
+
+    /// The largest relative change of area and volume compared to the previous attempt. This is
+    /// negative after the first attempt.
+    double mChange = -1.0;
+  };
+
+  /// The edges of the mesh for display. Each vertex is only stored once and each edge consists of
+  /// two indices into them. The vertices do not depend on the height scale, so the mesh can be
+  /// exaggerated without a new calculation.
+  struct MeshLevel {
+    projection::SurfaceSamples mVertices;
+    std::vector<uint32_t>      mEdges;
+  };
+
+  struct Result {
+    /// False if the polygon was too large for a calculation or if any of its tiles failed. The
+    /// other members are zero then.
+    bool mValid = false;
+
+    /// The mesh after the refinement attempts, from coarse to fine. The last level is the final
+    /// mesh, coarser levels are only kept if they have at most half as many edges as the next
+    /// finer one. For tiled polygons, the levels of the tiles are merged from the finest one on.
+    std::vector<MeshLevel> mMesh;
+
+    double mArea      = 0.0;
+    double mPosVolume = 0.0;
+    double mNegVolume = 0.0;
+
+    /// The time spent in each stage of the calculation, the refinement attempts, the points of the
+    /// final mesh and the terrain queries.
+    Statistics mStatistics;
+  };
+
+  /// The smallest size of the tiles in degrees. Each face of the cube which is used for the
+  /// tiling is split into (90 / angle)² cells, so smaller angles would create far too many tiles.
+  static const float MIN_TILE_ANGLE;
+
+  explicit PolygonCalculator(Input input);
+
+  /// Runs the whole calculation. The cancel flag is checked regularly; if it is set, the
+  /// calculation is aborted and false is returned. In this case, the result is incomplete.
+  bool compute(std::atomic_bool const& cancel);
+
+  Result const& getResult() const;
+  Result&       getResult();
+
+  /// Returns true and stores the latest estimate in progress, if another refinement attempt has
+  /// finished since the last call. This can be called from any thread while compute() is running.
+  bool getProgress(Progress& progress);
+
+ private:
+  /// Partial result of one triangle of the original Delaunay-mesh.
+  struct TriangleResult {
+    projection::SurfaceSamples mTriangulation;
+
+    double mArea      = 0.0;
+    double mPosVolume = 0.0;
+    double mNegVolume = 0.0;
+
+    /// False if points have been added to the triangle.
+    bool mFine = true;
+
+    /// The stages which ran for this triangle. They are merged into the result in a fixed order.
+    Statistics mStatistics;
+  };
+
+  /// A triangle of the volume integration, given by its corners on the surface without height
+  /// and their heights over the least squares plane.
+  struct VolumeTriangle {
+    std::array<glm::dvec3, 3> mCorners;
+    std::array<double, 3>     mHeights;
+  };
+
+  /// An edge whose end points are on different sides of the least squares plane.
+  struct PlaneCrossing {
+    glm::dvec3 mStart;
+    glm::dvec3 mEnd;
+    double     mStartHeight = 0.0;
+    double     mEndHeight   = 0.0;
+  };
+
+  /// Splits the polygon with the given corners into tiles and calculates each of them in parallel.
+  /// The corners are directions from the body's center, the volume is measured relative to
+  /// the given height.
+  bool computeTiles(std::atomic_bool const& cancel, std::vector<glm::dvec3> const& corners,
+      double referenceHeight);
+
+  /// Merges the meshes of all triangles and removes the edges which are shared by neighboring
+  /// triangles.
+  static MeshLevel createMeshLevel(std::vector<TriangleResult> const& results);
+
+  /// Removes the levels which have more than half as many edges as the next finer one. The finest
+  /// level is always kept.
+  static void pruneMeshLevels(std::vector<MeshLevel>& levels);
+
+  /// Finds the intersection point between two sites
+  static bool findIntersection(Site const& s1, Site const& s2, Site const& s3, Site const& s4,
+      double& intersectionX, double& intersectionY);
+
+  /// Creates a constrained Delaunay-mesh of the original polygon which contains all of its edges
+  /// and returns the triangles inside of the polygon. The triangles refer to the returned sites.
+  void createMesh(std::vector<Triangle>& triangles, SiteArray& sites);
+  /// Fallback for self-intersecting polygons: creates a Delaunay-mesh and corrects it by adding
+  /// the intersection points of missing edges to mCorners. The triangles are classified by their
+  /// middle points.
+  void createRepairedMesh(std::vector<Triangle>& triangles, SiteArray& sites);
+  /// Checks sleekness of a triangle from the original Delaunay-mesh and its subtriangles
+  /// If a triangle is too sleek, divides it
+  /// Returns true if a lot of new points are added
+  bool checkSleekness(int count);
+  /// Refines one triangle of the original Delaunay-mesh and calculates its area and volume. This
+  /// only modifies the state of the given triangle, so it can be called for several triangles in
+  /// parallel.
+  TriangleResult refineTriangle(size_t count, size_t pointOffset, uint32_t attempt, double mdist,
+      glm::dvec3 const& e, glm::dvec3 const& n, glm::dvec3 const& r);
+  /// Refines mesh based on edge length and terrain. h1, h2 and hAvg are the heights of the edge's
+  /// end points and its middle point. dividingHeights are the heights of the DIVIDING_POINTS
+  /// points which divide the edge into three, four and five parts, in this order. Only the heights
+  /// which are checked while fine is still true have to be set.
+  void refineMesh(Edge2 const& edge, int count, double h1, double h2, double hAvg,
+      double const* dividingHeights, bool& fine);
+  /// Appends the points which divide the edge into the given number of parts to points
+  static void getDividingPoints(Edge2 const& edge, int parts, std::vector<glm::dvec2>& points);
+  /// Returns true if the height differs too much from the expected height, in which case a point
+  /// is added to the mesh
+  bool exceedsHeightDiff(double height, double expected) const;
+  /// Queries the heights at all given points of the Voronoi plane with one batch
+  void sampleHeights(projection::TangentPlane const& plane, double radius,
+      std::vector<glm::dvec2> const& points, std::vector<double>& heights);
+  /// Calculates triangle areas and prism volumes
+  void calculateAreaAndVolume(std::vector<Triangle> const& triangles, SiteArray const& sites,
+      double mdist, glm::dvec3 const& e, glm::dvec3 const& n, glm::dvec3 const& r, double& area,
+      double& pvol, double& nvol);
+  /// Returns the height over the least squares plane of a point with the given position on the
+  /// surface and the given terrain height.
+  double getHeightOverPlane(glm::dvec3 const& position, double height) const;
+  /// Queries the terrain heights at the given positions on the surface with one batch and
+  /// returns their heights over the least squares plane.
+  void sampleHeightsOverPlane(
+      std::vector<glm::dvec3> const& positions, double radius, std::vector<double>& heights);
+  /// Finds the points on the given edges where the terrain crosses the least squares plane. Each
+  /// crossing is bracketed with the Illinois method until the bracket is shorter than
+  /// mInput.mIntersectionTolerance. All edges are searched at once, so that the heights of one
+  /// iteration are queried with one batch.
+  void findPlaneIntersections(std::vector<PlaneCrossing> const& crossings, double radius,
+      std::vector<glm::dvec3>& intersections);
+  /// Adds the prism volumes of the triangles between the terrain and the least squares plane to
+  /// pvol and nvol. Triangles which may cross the plane more than twice are subdivided up to
+  /// MAX_VOLUME_REFINEMENT times. The triangles are processed level by level, so that the heights
+  /// of each subdivision step are queried with one batch for all of them.
+  void calculateVolumes(
+      std::vector<VolumeTriangle> triangles, double radius, double& pvol, double& nvol);
+  // Checks if point is inside of the polygon or not
+  bool checkPoint(glm::dvec2 const& point);
+  /// Inserts all points of mCornersFine[count] which have been added since the last call into
+  /// the triangulation of this triangle and returns it
+  VoronoiGenerator const& updateTriangulation(int count);
+
+  Input  mInput;
+  Result mResult;
+
+  // For Delaunay-mesh
+  std::vector<Site>      mCorners;
+  std::vector<SiteArray> mCornersFine;
+  glm::dvec3             mNormal      = glm::dvec3(0.0);
+  glm::dvec3             mMiddlePoint = glm::dvec3(0.0);
+
+  // Triangulations of mCornersFine, these are refined incrementally in every attempt
+  std::vector<std::unique_ptr<VoronoiGenerator>> mTriangulations;
+
+  // The least squares plane for the volume calculation
+  glm::dvec3 mNormal2      = glm::dvec3(0.0);
+  glm::dvec3 mMiddlePoint2 = glm::dvec3(0.0);
+
+  // Terrain heights of this calculation
+  HeightCache mHeightCache;
+
+  // The estimate of the last refinement attempt, it is read by the main thread
+  std::mutex mProgressMutex;
+  Progress   mProgress;
+  bool       mProgressUpdated = false;
+
+  static const int MAX_INTERSECTION_ITERATIONS;
+  static const int MAX_VOLUME_REFINEMENT;
+  static const int DIVIDING_POINTS;
+};
+
+} // namespace csp::measurementtools
+
+#endif // CSP_MEASUREMENT_TOOLS_POLYGON_CALCULATOR_HPP
@@ -0,0 +1,147 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//                               This file is part of CosmoScout VR                               //
+//      and may be used under the terms of the MIT license. See the LICENSE file for details.     //
+//                        Copyright: (c) 2019 German Aerospace Center (DLR)                       //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "PolygonResultCache.hpp"
+
+namespace csp::measurementtools {
+
+namespace {
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// The keys are stored in the settings, so they have to be the same in every session. std::hash
+// does not guarantee this, therefore the 64 bit FNV-1a hash is used.
+class KeyHasher {
+ public:
+  void add(void const* data, size_t size) {
+    auto const* bytes = static_cast<unsigned char const*>(data);
+
+    for (size_t i = 0; i < size; ++i) {
+      mHash ^= bytes[i];
+      mHash *= 0x100000001b3ULL;
+    }
+  }
+
+  template <typename T>
+  void add(T value) {
+    add(&value, sizeof(T));
+  }
+
+  // The size is added as well, so that the strings can not be mixed up with the values next to
+  // them.
+  void add(std::string const& value) {
+    add<uint64_t>(value.size());
+    add(value.data(), value.size());
+  }
+
+  uint64_t get() const {
+    return mHash;
+  }
+
+ private:
+  uint64_t mHash = 0xcbf29ce484222325ULL;
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+} // namespace
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+uint64_t PolygonResultCache::getKey(std::vector<glm::dvec2> const& lngLats,
+    std::string const& center, std::string const& terrainId,
+    PolygonCalculator::Input const& settings) {
+  KeyHasher hasher;
+
+  hasher.add<uint64_t>(lngLats.size());
+  for (auto const& lngLat : lngLats) {
+    hasher.add(lngLat.x);
+    hasher.add(lngLat.y);
+  }
+
+  hasher.add(center);
+  hasher.add(terrainId);
+
+  hasher.add(settings.mHeightDiff);
+  hasher.add(settings.mMaxAttempt);
+  hasher.add(settings.mMaxPoints);
+  hasher.add(settings.mSleekness);
+  hasher.add(settings.mIntersectionTolerance);
+  hasher.add(settings.mConvergenceThreshold);
+  hasher.add(settings.mTileAngle);
+
+  return hasher.get();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+std::shared_ptr<const PolygonResultCache::Entry> PolygonResultCache::createEntry(
+    PolygonCalculator::Result const& result) {
+  auto entry = std::make_shared<Entry>();
+
+  entry->mArea      = result.mArea;
+  entry->mPosVolume = result.mPosVolume;
+  entry->mNegVolume = result.mNegVolume;
+  entry->mMesh      = result.mMesh;
+
+  return entry;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+PolygonResultCache::PolygonResultCache(size_t capacity)
+    : mCapacity(capacity) {
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+std::shared_ptr<const PolygonResultCache::Entry> PolygonResultCache::get(uint64_t key) {
+  auto it = mIndex.find(key);
+
+  if (it == mIndex.end()) {
+    return nullptr;
+  }
+
+  mItems.splice(mItems.begin(), mItems, it->second);
+
+  return it->second->second;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void PolygonResultCache::insert(uint64_t key, std::shared_ptr<const Entry> entry) {
+  auto it = mIndex.find(key);
+
+  if (it != mIndex.end()) {
+    mItems.erase(it->second);
+    mIndex.erase(it);
+  }
+
+  mItems.emplace_front(key, std::move(entry));
+  mIndex[key] = mItems.begin();
+
+  while (mItems.size() > mCapacity) {
+    mIndex.erase(mItems.back().first);
+    mItems.pop_back();
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void PolygonResultCache::clear() {
+  mItems.clear();
+  mIndex.clear();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+size_t PolygonResultCache::getSize() const {
+  return mIndex.size();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+} // namespace csp::measurementtools
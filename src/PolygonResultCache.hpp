@@ -0,0 +1,76 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//                               This file is part of CosmoScout VR                               //
+//      and may be used under the terms of the MIT license. See the LICENSE file for details.     //
+//                        Copyright: (c) 2019 German Aerospace Center (DLR)                       //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef CSP_MEASUREMENT_TOOLS_POLYGON_RESULT_CACHE_HPP
+#define CSP_MEASUREMENT_TOOLS_POLYGON_RESULT_CACHE_HPP
+
+#include "PolygonCalculator.hpp"
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace csp::measurementtools {
+
+/// Keeps the results of the latest polygon calculations, so that moving a corner back to an
+/// earlier position or changing a setting back to an earlier value does not require a new
+/// calculation. The entries are identified by a key which is computed from everything the result
+/// depends on. If more than the given number of entries are inserted, the least recently used
+/// one is removed. This is not thread-safe, the PolygonTool only uses it on the main thread.
+class PolygonResultCache {
+ public:
+  /// All levels of the mesh are kept, so that a cached result is drawn with the same levels of
+  /// detail as a calculated one.
+  struct Entry {
+    double mArea      = 0.0;
+    double mPosVolume = 0.0;
+    double mNegVolume = 0.0;
+
+    std::vector<PolygonCalculator::MeshLevel> mMesh;
+  };
+
+  /// Returns the key of a calculation of the polygon with the given corners in lng/lat on the
+  /// given body. The terrain ID identifies the dataset of the heights, as the body itself does
+  /// not tell which one is used. All refinement settings of the input are included, its positions
+  /// and sources are ignored. The key only depends on these values, so it can be stored in the
+  /// settings and compared with keys of later sessions.
+  static uint64_t getKey(std::vector<glm::dvec2> const& lngLats, std::string const& center,
+      std::string const& terrainId, PolygonCalculator::Input const& settings);
+
+  /// Creates an entry from the mesh levels and the area and volume of a valid result.
+  static std::shared_ptr<const Entry> createEntry(PolygonCalculator::Result const& result);
+
+  explicit PolygonResultCache(size_t capacity = 16);
+
+  /// Returns nullptr if there is no entry for the key. Otherwise, the entry becomes the most
+  /// recently used one.
+  std::shared_ptr<const Entry> get(uint64_t key);
+
+  /// An existing entry with the same key is replaced.
+  void insert(uint64_t key, std::shared_ptr<const Entry> entry);
+
+  void   clear();
+  size_t getSize() const;
+
+ private:
+  using Item = std::pair<uint64_t, std::shared_ptr<const Entry>>;
+
+  size_t mCapacity;
+
+  // Ordered from the most to the least recently used entry.
+  std::list<Item>                                         mItems;
+  std::unordered_map<uint64_t, std::list<Item>::iterator> mIndex;
+};
+
+} // namespace csp::measurementtools
+
+#endif // CSP_MEASUREMENT_TOOLS_POLYGON_RESULT_CACHE_HPP
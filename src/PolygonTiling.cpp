@@ -0,0 +1,414 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//                               This file is part of CosmoScout VR                               //
+//      and may be used under the terms of the MIT license. See the LICENSE file for details.     //
+//                        Copyright: (c) 2019 German Aerospace Center (DLR)                       //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "PolygonTiling.hpp"
+
+#include <glm/gtc/constants.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+
+namespace csp::measurementtools::tiling {
+
+namespace {
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// The arcs from a to b and from c to d have to be shorter than half a great circle. The same
+// half-open rule as for the usual point in polygon test is used, so that an arc passing exactly
+// through a corner is counted once.
+bool arcsCross(glm::dvec3 const& a, glm::dvec3 const& b, glm::dvec3 const& c, glm::dvec3 const& d) {
+  glm::dvec3 n1 = glm::cross(a, b);
+  glm::dvec3 n2 = glm::cross(c, d);
+
+  if ((glm::dot(n1, c) > 0.0) == (glm::dot(n1, d) > 0.0) ||
+      (glm::dot(n2, a) > 0.0) == (glm::dot(n2, b) > 0.0)) {
+    return false;
+  }
+
+  // The great circles intersect at x and -x. Each arc contains the one which is on the side of
+  // its middle.
+  glm::dvec3 x = glm::cross(n1, n2);
+  if (glm::dot(x, a + b) < 0.0) {
+    x = -x;
+  }
+
+  return glm::dot(x, c + d) > 0.0;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// A face of the cube around the body. The coordinates on the face are the gnomonic projection
+// (dot(p, u), dot(p, v)) / dot(p, d), cross(u, v) is d, so that counter-clockwise on the face is
+// counter-clockwise seen from above the surface.
+struct Face {
+  glm::dvec3 mD;
+  glm::dvec3 mU;
+  glm::dvec3 mV;
+};
+
+const std::array<Face, 6> FACES = {{
+    {{1.0, 0.0, 0.0}, {0.0, 1.0, 0.0}, {0.0, 0.0, 1.0}},
+    {{-1.0, 0.0, 0.0}, {0.0, 0.0, 1.0}, {0.0, 1.0, 0.0}},
+    {{0.0, 1.0, 0.0}, {0.0, 0.0, 1.0}, {1.0, 0.0, 0.0}},
+    {{0.0, -1.0, 0.0}, {1.0, 0.0, 0.0}, {0.0, 0.0, 1.0}},
+    {{0.0, 0.0, 1.0}, {1.0, 0.0, 0.0}, {0.0, 1.0, 0.0}},
+    {{0.0, 0.0, -1.0}, {0.0, 1.0, 0.0}, {1.0, 0.0, 0.0}},
+}};
+
+// One tile, [mMin.x, mMax.x] x [mMin.y, mMax.y] in the coordinates of its face.
+struct Tile {
+  Face       mFace;
+  glm::dvec2 mMin;
+  glm::dvec2 mMax;
+
+  glm::dvec3 toDirection(glm::dvec2 const& p) const {
+    return glm::normalize(mFace.mD + p.x * mFace.mU + p.y * mFace.mV);
+  }
+
+  glm::dvec2 toFace(glm::dvec3 const& p) const {
+    return glm::dvec2(glm::dot(p, mFace.mU), glm::dot(p, mFace.mV)) / glm::dot(p, mFace.mD);
+  }
+
+  // The tile is the part of the sphere which is on the positive side of these four planes
+  // through the center.
+  std::array<glm::dvec3, 4> getPlanes() const {
+    return {mFace.mU - mMin.x * mFace.mD, mMax.x * mFace.mD - mFace.mU,
+        mFace.mV - mMin.y * mFace.mD, mMax.y * mFace.mD - mFace.mV};
+  }
+
+  // The position of a point on the border, counter-clockwise from mMin. Each side has length 1.
+  double getPerimeter(glm::dvec2 const& p) const {
+    glm::dvec2 t = (p - mMin) / (mMax - mMin);
+
+    std::array<double, 4> distances = {
+        std::abs(t.y), std::abs(1.0 - t.x), std::abs(1.0 - t.y), std::abs(t.x)};
+    auto side = std::min_element(distances.begin(), distances.end()) - distances.begin();
+
+    switch (side) {
+    case 0:
+      return t.x;
+    case 1:
+      return 1.0 + t.y;
+    case 2:
+      return 2.0 + (1.0 - t.x);
+    default:
+      return 3.0 + (1.0 - t.y);
+    }
+  }
+
+  glm::dvec2 getCorner(int i) const {
+    switch (i % 4) {
+    case 0:
+      return mMin;
+    case 1:
+      return glm::dvec2(mMax.x, mMin.y);
+    case 2:
+      return mMax;
+    default:
+      return glm::dvec2(mMin.x, mMax.y);
+    }
+  }
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Removes corners which are equal to their predecessor.
+std::vector<glm::dvec3> removeDuplicates(std::vector<glm::dvec3> const& corners) {
+  std::vector<glm::dvec3> result;
+
+  for (auto const& corner : corners) {
+    if (result.empty() || glm::length(corner - result.back()) > 1e-12) {
+      result.push_back(corner);
+    }
+  }
+
+  while (result.size() > 1 && glm::length(result.front() - result.back()) <= 1e-12) {
+    result.pop_back();
+  }
+
+  return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Clips the parts of the outline inside of the tile. Each chain enters the tile at its first
+// point and leaves it at its last point. Returns false if all corners are inside of the tile.
+bool clip(std::vector<glm::dvec3> const& loop, Tile const& tile,
+    std::vector<std::vector<glm::dvec2>>& chains) {
+  auto planes = tile.getPlanes();
+
+  auto isInside = [&planes](glm::dvec3 const& p) {
+    return std::all_of(
+        planes.begin(), planes.end(), [&p](glm::dvec3 const& m) { return glm::dot(m, p) >= 0.0; });
+  };
+
+  // The chains are collected starting at a corner outside of the tile, so that no chain wraps
+  // around the end of the loop.
+  auto start = std::find_if_not(loop.begin(), loop.end(), isInside);
+
+  if (start == loop.end()) {
+    return false;
+  }
+
+  size_t first = static_cast<size_t>(start - loop.begin());
+  bool   open  = false;
+
+  for (size_t step = 0; step < loop.size(); ++step) {
+    glm::dvec3 const& a = loop[(first + step) % loop.size()];
+    glm::dvec3 const& b = loop[(first + step + 1) % loop.size()];
+
+    // The arc is the central projection of the chord between a and b. As the planes pass
+    // through the center, the part of the chord on their positive side is projected onto the
+    // part of the arc inside of the tile.
+    double t0 = 0.0;
+    double t1 = 1.0;
+
+    for (auto const& m : planes) {
+      double fa = glm::dot(m, a);
+      double fb = glm::dot(m, b);
+
+      if (fa < 0.0 && fb < 0.0) {
+        t0 = 1.0;
+        t1 = 0.0;
+        break;
+      }
+
+      if (fa < 0.0) {
+        t0 = std::max(t0, fa / (fa - fb));
+      } else if (fb < 0.0) {
+        t1 = std::min(t1, fa / (fa - fb));
+      }
+    }
+
+    if (t0 >= t1) {
+      open = false;
+      continue;
+    }
+
+    if (!open) {
+      chains.push_back({tile.toFace(a + t0 * (b - a))});
+      open = true;
+    }
+
+    chains.back().push_back(tile.toFace(a + t1 * (b - a)));
+
+    if (t1 < 1.0) {
+      open = false;
+    }
+  }
+
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Returns 1 if the inside of the polygon is to the left of the given part of its outline and -1
+// otherwise. The side of a point close to the longest segment of the chain is tested.
+int getOrientation(
+    std::vector<glm::dvec3> const& loop, Tile const& tile, std::vector<glm::dvec2> const& chain) {
+  glm::dvec3 p0(0.0);
+  glm::dvec3 p1(0.0);
+
+  for (size_t i = 0; i + 1 < chain.size(); ++i) {
+    glm::dvec3 a = tile.toDirection(chain[i]);
+    glm::dvec3 b = tile.toDirection(chain[i + 1]);
+
+    if (glm::length(b - a) > glm::length(p1 - p0)) {
+      p0 = a;
+      p1 = b;
+    }
+  }
+
+  glm::dvec3 middle = glm::normalize(p0 + p1);
+  glm::dvec3 left   = glm::normalize(glm::cross(middle, p1 - p0));
+  glm::dvec3 point  = glm::normalize(middle + 1e-3 * glm::length(p1 - p0) * left);
+
+  return contains(loop, point) ? 1 : -1;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Joins the chains, whose inside is to their left, to closed outlines along the border of the
+// tile. From the end of each chain, the border is followed counter-clockwise to the next start of
+// a chain.
+std::vector<std::vector<glm::dvec2>> join(
+    Tile const& tile, std::vector<std::vector<glm::dvec2>> const& chains) {
+  std::vector<std::vector<glm::dvec2>> outlines;
+  std::vector<bool>                    used(chains.size(), false);
+
+  for (size_t start = 0; start < chains.size(); ++start) {
+    if (used[start]) {
+      continue;
+    }
+
+    std::vector<glm::dvec2> outline;
+    size_t                  current = start;
+
+    // Each chain is added once, so this terminates after at most chains.size() steps.
+    for (size_t step = 0; step < chains.size(); ++step) {
+      used[current] = true;
+      outline.insert(outline.end(), chains[current].begin(), chains[current].end());
+
+      double exit      = tile.getPerimeter(chains[current].back());
+      size_t next      = start;
+      double nextDelta = std::numeric_limits<double>::max();
+
+      for (size_t i = 0; i < chains.size(); ++i) {
+        if (used[i] && i != start) {
+          continue;
+        }
+
+        double delta = std::fmod(tile.getPerimeter(chains[i].front()) - exit + 4.0, 4.0);
+
+        if (delta < nextDelta) {
+          next      = i;
+          nextDelta = delta;
+        }
+      }
+
+      // Adds the corners of the tile which are passed on the way to the next chain.
+      for (double corner = std::floor(exit) + 1.0; corner < exit + nextDelta; corner += 1.0) {
+        outline.push_back(tile.getCorner(static_cast<int>(corner)));
+      }
+
+      if (next == start) {
+        break;
+      }
+
+      current = next;
+    }
+
+    outlines.push_back(std::move(outline));
+  }
+
+  return outlines;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+} // namespace
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool contains(std::vector<glm::dvec3> const& corners, glm::dvec3 const& point) {
+  glm::dvec3 sum(0.0);
+  for (auto const& corner : corners) {
+    sum += corner;
+  }
+
+  if (corners.size() < 3 || glm::length(sum) <= 0.0) {
+    return false;
+  }
+
+  glm::dvec3 outside = -glm::normalize(sum);
+
+  // The path from the outside to the point crosses the outline an odd number of times if the
+  // point is inside. It is split at a point in between, so that both arcs are clearly shorter
+  // than half a great circle.
+  glm::dvec3 between = outside + point;
+
+  if (glm::length(between) < 0.5) {
+    glm::dvec3 axis = std::abs(outside.x) < 0.9 ? glm::dvec3(1, 0, 0) : glm::dvec3(0, 1, 0);
+    between         = glm::cross(outside, axis);
+  }
+
+  between = glm::normalize(between);
+
+  bool inside = false;
+
+  for (size_t i = 0; i < corners.size(); ++i) {
+    glm::dvec3 const& a = corners[i];
+    glm::dvec3 const& b = corners[(i + 1) % corners.size()];
+
+    if (arcsCross(outside, between, a, b) != arcsCross(between, point, a, b)) {
+      inside = !inside;
+    }
+  }
+
+  return inside;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+std::vector<std::vector<glm::dvec3>> split(
+    std::vector<glm::dvec3> const& corners, uint32_t tilesPerFace) {
+  std::vector<std::vector<glm::dvec3>> parts;
+  std::vector<glm::dvec3>              loop = removeDuplicates(corners);
+
+  if (loop.size() < 3 || tilesPerFace == 0) {
+    return parts;
+  }
+
+  // The tiles span equal angles, so that they have a similar size on the whole sphere.
+  std::vector<double> bounds(tilesPerFace + 1);
+  for (uint32_t i = 0; i <= tilesPerFace; ++i) {
+    double angle = glm::pi<double>() * (static_cast<double>(i) / tilesPerFace - 0.5) / 2.0;
+    bounds[i]    = std::tan(angle);
+  }
+
+  // The orientation of the outline is determined once it is needed for the first time.
+  int orientation = 0;
+
+  for (auto const& face : FACES) {
+    for (uint32_t i = 0; i < tilesPerFace; ++i) {
+      for (uint32_t j = 0; j < tilesPerFace; ++j) {
+        Tile tile{face, {bounds[i], bounds[j]}, {bounds[i + 1], bounds[j + 1]}};
+
+        std::vector<std::vector<glm::dvec2>> chains;
+
+        // A polygon inside of a single tile is the smaller of the two parts of the sphere.
+        if (!clip(loop, tile, chains)) {
+          parts.push_back(loop);
+          continue;
+        }
+
+        std::vector<std::vector<glm::dvec2>> outlines;
+
+        if (chains.empty()) {
+          // The outline does not pass through the tile, so it is either completely inside or
+          // completely outside of the polygon.
+          if (contains(loop, tile.toDirection((tile.mMin + tile.mMax) / 2.0))) {
+            outlines.push_back({tile.getCorner(0), tile.getCorner(1), tile.getCorner(2),
+                tile.getCorner(3)});
+          }
+        } else {
+          if (orientation == 0) {
+            orientation = getOrientation(loop, tile, chains.front());
+          }
+
+          if (orientation < 0) {
+            for (auto& chain : chains) {
+              std::reverse(chain.begin(), chain.end());
+            }
+          }
+
+          outlines = join(tile, chains);
+        }
+
+        for (auto const& outline : outlines) {
+          std::vector<glm::dvec3> part(outline.size());
+          std::transform(outline.begin(), outline.end(), part.begin(),
+              [&tile](glm::dvec2 const& p) { return tile.toDirection(p); });
+
+          part = removeDuplicates(part);
+
+          if (part.size() >= 3) {
+            parts.push_back(std::move(part));
+          }
+        }
+      }
+    }
+  }
+
+  return parts;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+} // namespace csp::measurementtools::tiling
@@ -0,0 +1,39 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//                               This file is part of CosmoScout VR                               //
+//      and may be used under the terms of the MIT license. See the LICENSE file for details.     //
+//                        Copyright: (c) 2019 German Aerospace Center (DLR)                       //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef CSP_MEASUREMENT_TOOLS_POLYGON_TILING_HPP
+#define CSP_MEASUREMENT_TOOLS_POLYGON_TILING_HPP
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <vector>
+
+/// Splits polygons on the surface of a body into tiles which are small enough to be meshed in a
+/// tangent plane of their own. The polygon's edges are the great circle arcs between its corners,
+/// which is what they are in the tangent plane of a single calculation as well. The tiles are the
+/// cells of a grid on the faces of a cube around the body. The lines of this grid are great
+/// circles, so the seams between neighboring tiles are straight lines in the tangent planes of
+/// both tiles and their meshes cover the polygon without gaps or overlaps.
+///
+/// On a sphere, each closed outline divides the surface into two parts. The outside of a polygon
+/// is the part which contains the point opposite to the average of its corners.
+namespace csp::measurementtools::tiling {
+
+/// Returns true if the given direction is inside of the polygon with the given corners. All
+/// arguments are normalized directions from the body's center.
+bool contains(std::vector<glm::dvec3> const& corners, glm::dvec3 const& point);
+
+/// Returns the parts of the polygon inside of each tile, as the corners of simple polygons. There
+/// are tilesPerFace x tilesPerFace tiles on each face of the cube, which span equal angles. A
+/// tile may contain several parts of the polygon. Tiles outside of the polygon are omitted. All
+/// corners are normalized directions from the body's center.
+std::vector<std::vector<glm::dvec3>> split(
+    std::vector<glm::dvec3> const& corners, uint32_t tilesPerFace);
+
+} // namespace csp::measurementtools::tiling
+
+#endif // CSP_MEASUREMENT_TOOLS_POLYGON_TILING_HPP
@@ -8,31 +8,36 @@
 #define CSP_MEASUREMENT_TOOLS_POLYGONTOOL_HPP
 
 #include "../../../src/cs-core/tools/MultiPointTool.hpp"
+#include "AsyncCalculation.hpp"
+#include "LineRenderer.hpp"
 #include "Plugin.hpp"
-
-#include <VistaKernel/GraphicsManager/VistaOpenGLDraw.h>
+#include "PolygonCalculator.hpp"
+#include "PolygonResultCache.hpp"
+#include "Statistics.hpp"
+#include "ToolGui.hpp"
+#include "UpdateScheduler.hpp"
 
 #include <glm/glm.hpp>
+#include <string>
+#include <utility>
 #include <vector>
 
-#include "voronoi/VoronoiGenerator.hpp"
-
 namespace cs::scene {
 class CelestialAnchorNode;
 }
 
-namespace cs::gui {
-class GuiItem;
-class WorldSpaceGuiArea;
-} // namespace cs::gui
-
-class VistaTransformNode;
-
 namespace csp::measurementtools {
 
+class HeightProvider;
+class ThreadPool;
+
 /// Measures the area and volume of an arbitrary polygon on surface with a Delaunay-mesh. It
 /// displays the bounding box of the selected polygon, which can be copied for cache generator.
-class PolygonTool : public IVistaOpenGLDraw, public cs::core::tools::MultiPointTool {
+/// The mesh, area and volume are computed by a PolygonCalculator on the given thread pool, so
+/// that moving a point does not stall the rendering. The results of the latest calculations are
+/// cached, so that they are shown immediately if the polygon or the settings return to an earlier
+/// state.
+class PolygonTool : public cs::core::tools::MultiPointTool, public UpdateScheduler::Client {
  public:
   /// This text is shown on the ui and can be edited by the user.
   cs::utils::Property<std::string> pText = std::string("Polygon");
@@ -43,7 +48,10 @@ class PolygonTool : public IVistaOpenGLDraw, public cs::core::tools::MultiPointT
   PolygonTool(std::shared_ptr<cs::core::InputManager> const& pInputManager,
       std::shared_ptr<cs::core::SolarSystem> const&          pSolarSystem,
       std::shared_ptr<cs::core::Settings> const&             settings,
-      std::shared_ptr<cs::core::TimeControl> const& pTimeControl, std::string const& sCenter,
+      std::shared_ptr<cs::core::TimeControl> const&          pTimeControl,
+      std::shared_ptr<LineRenderer> const&                   pLineRenderer,
+      std::shared_ptr<ThreadPool> const& pThreadPool,
+      std::shared_ptr<HeightProvider> const& pHeightProvider, std::string const& sCenter,
       std::string const& sFrame);
 
   PolygonTool(PolygonTool const& other) = delete;
@@ -63,47 +71,75 @@ class PolygonTool : public IVistaOpenGLDraw, public cs::core::tools::MultiPointT
   /// Called from Tools class
   void update() override;
 
-  /// Inherited from IVistaOpenGLDraw
-  bool Do() override;
-  bool GetBoundingBox(VistaBoundingBox& bb) override;
+  /// These are called by the UpdateScheduler. The terrain is only sampled in
+  /// processPendingUpdate().
+  bool   hasPendingUpdate() const override;
+  double getUpdatePriority() const override;
+  void   processPendingUpdate() override;
+
+  /// The web view of the tool is only created when the tool is close to the observer.
+  ToolGui& getGui();
+
+  /// The time spent on sampling the outline and the statistics of the calculations which finished
+  /// since the last call to resetStatistics(). The Plugin reads and resets these once per frame.
+  Statistics const& getStatistics() const;
+  void              resetStatistics();
 
   void setHeightDiff(float hDiff);
   void setMaxAttempt(uint32_t att);
   void setMaxPoints(uint32_t points);
   void setSleekness(uint32_t degree);
 
+  /// The accuracy in meters of the points where the terrain crosses the reference plane of the
+  /// volume calculation.
+  void setIntersectionTolerance(float tolerance);
+
+  /// The refinement of the mesh stops once area and volume change less than this fraction between
+  /// two attempts. Zero disables this.
+  void setConvergenceThreshold(float threshold);
+
+  /// Polygons which span more than this angle in degrees are split into tiles of about this size,
+  /// each of which is meshed in its own tangent plane. Zero disables this.
+  void setTileAngle(float angle);
+
+  /// Identifies the terrain dataset of the body. It is part of the keys of the cached results, so
+  /// that these are not used for another dataset.
+  void setTerrainId(std::string const& id);
+
+  /// The key and the result of the latest calculation. These are stored in the settings, so that
+  /// the polygon does not have to be calculated again when the settings are loaded. The result is
+  /// nullptr if there is no valid result yet.
+  std::pair<uint64_t, std::shared_ptr<const PolygonResultCache::Entry>> getCachedResult() const;
+
+  /// Adds a result which has been stored in the settings to the cache. It is only used if its key
+  /// matches the polygon and the settings.
+  void addCachedResult(uint64_t key, std::shared_ptr<const PolygonResultCache::Entry> result);
+
  private:
+  /// Samples the outline of the polygon and projects it to the terrain.
   void updateLineVertices();
+
+  /// Rebuilds the positions of the outline and the mesh from their samples with the current height
+  /// scale. This does not query the terrain.
+  void updateLinePositions();
+  void updateMeshPositions();
+
+  /// Starts a new calculation on the thread pool. A calculation which is still running is
+  /// cancelled.
   void updateCalculation();
+  void cancelCalculation();
+
+  /// Called on the main thread once a calculation has finished. The result's mesh is swapped
+  /// into mTriangulation.
+  void applyCalculationResult(PolygonCalculator::Result& result);
 
-  /// Returns the interpolated position in cartesian coordinates. The fourth component is
-  /// height above the surface
-  glm::dvec4 getInterpolatedPosBetweenTwoMarks(cs::core::tools::DeletableMark const& l0,
-      cs::core::tools::DeletableMark const& l1, double value);
-
-  /// Finds the intersection point between two sites
-  static bool findIntersection(Site const& s1, Site const& s2, Site const& s3, Site const& s4,
-      double& intersectionX, double& intersectionY);
-
-  /// Creates a Delaunay-mesh and corrects it to match the original polygon
-  /// (especially for concave polygons)
-  void createMesh(std::vector<Triangle>& triangles);
-  /// Checks sleekness of a triangle from the original Delaunay-mesh and its subtriangles
-  /// If a triangle is too sleek, divides it
-  /// Returns true if a lot of new points are added
-  bool checkSleekness(int count);
-  /// Draws the Delaunay-mesh on the planet's surface
-  void displayMesh(Edge2 const& edge, double mdist, glm::dvec3 const& e, glm::dvec3 const& n,
-      glm::dvec3 const& r, double scale, double& h1, double& h2);
-  /// Refines mesh based on edge length and terrain
-  void refineMesh(Edge2 const& edge, double mdist, glm::dvec3 const& e, glm::dvec3 const& n,
-      glm::dvec3 const& r, int count, double h1, double h2, bool& fine);
-  /// Calculates triangle areas and prism volumes
-  void calculateAreaAndVolume(std::vector<Triangle> const& triangles, double mdist,
-      glm::dvec3 const& e, glm::dvec3 const& n, glm::dvec3 const& r, double& area, double& pvol,
-      double& nvol);
-  // Checks if point is inside of the polygon or not
-  bool checkPoint(glm::dvec2 const& point);
+  /// Shows a result which has been found in the cache instead of calculating it.
+  void applyCachedResult(PolygonResultCache::Entry const& result);
+
+  /// Appends NUM_SAMPLES lng/lat coordinates between the two marks to lngLats. The second mark is
+  /// not included, as it is the first sample of the next segment.
+  void interpolateBetweenTwoMarks(cs::core::tools::DeletableMark const& l0,
+      cs::core::tools::DeletableMark const& l1, std::vector<glm::dvec2>& lngLats);
 
   // These are called by the base class MultiPointTool
   void onPointMoved() override;
@@ -111,24 +147,30 @@ class PolygonTool : public IVistaOpenGLDraw, public cs::core::tools::MultiPointT
   void onPointRemoved(int index) override;
 
   std::shared_ptr<cs::scene::CelestialAnchorNode> mGuiAnchor;
-  std::unique_ptr<cs::gui::WorldSpaceGuiArea>     mGuiArea;
-  std::unique_ptr<cs::gui::GuiItem>               mGuiItem;
-  std::unique_ptr<VistaTransformNode>             mGuiTransform;
-  std::unique_ptr<VistaOpenGLNode>                mGuiNode;
-  std::unique_ptr<VistaOpenGLNode>                mParent;
+  std::unique_ptr<ToolGui>                        mGui;
 
   // For Lines
-  VistaVertexArrayObject mVAO;
-  VistaBufferObject      mVBO;
+  std::shared_ptr<LineRenderer::Geometry> mLines;
 
   // For Delaunay
-  VistaVertexArrayObject mVAO2;
-  VistaBufferObject      mVBO2;
-  VistaGLSLShader        mShader;
+  std::shared_ptr<LineRenderer::Geometry> mMesh;
+
+  // The outline without the height scale and its current positions.
+  projection::SurfaceSamples mOutline;
+  std::vector<glm::dvec3>    mSampledPositions;
+
+  // The position of the GUI, without the height scale.
+  glm::dvec2 mCenterLngLat = glm::dvec2(0.0);
+  double     mCenterHeight = 0.0;
 
-  std::vector<glm::dvec3> mSampledPositions;
-  size_t                  mIndexCount    = 0;
-  bool                    mVerticesDirty = false;
+  // Set if the marks changed, the outline has to be sampled again and area and volume have to be
+  // recalculated then.
+  bool mVerticesDirty = false;
+
+  // Set if only the height scale changed.
+  bool mPositionsDirty = false;
+
+  Statistics mStatistics;
 
   int mTextConnection  = -1;
   int mScaleConnection = -1;
@@ -137,12 +179,8 @@ class PolygonTool : public IVistaOpenGLDraw, public cs::core::tools::MultiPointT
   glm::dvec4 mBoundingBox = glm::dvec4(0.0);
 
   // For Delaunay-mesh
-  std::vector<Site>              mCorners;
-  std::vector<std::vector<Site>> mCornersFine;
-  std::vector<glm::dvec3>        mTriangulation;
-  glm::dvec3                     mNormal      = glm::dvec3(0.0);
-  glm::dvec3                     mMiddlePoint = glm::dvec3(0.0);
-  size_t                         mIndexCount2 = 0;
+  std::vector<PolygonCalculator::MeshLevel> mTriangulation;
+  std::vector<LineRenderer::Geometry::Level> mMeshLevels;
 
   // For triangle fineness
   float    mHeightDiff = 1.002F;
@@ -150,14 +188,28 @@ class PolygonTool : public IVistaOpenGLDraw, public cs::core::tools::MultiPointT
   uint32_t mMaxPoints  = 1000;
   uint32_t mSleekness  = 15;
 
-  // For volume calculation
-  double     mOffset{};
-  glm::dvec3 mNormal2      = glm::dvec3(0.0);
-  glm::dvec3 mMiddlePoint2 = glm::dvec3(0.0);
+  float mIntersectionTolerance = 1.F;
+  float mConvergenceThreshold  = 0.F;
+  float mTileAngle             = 0.F;
+
+  std::string mTerrainId;
+
+  // The latest valid results. mResult is the one which is currently shown, it is nullptr while a
+  // calculation is running.
+  PolygonResultCache                               mResultCache;
+  uint64_t                                         mResultKey = 0;
+  std::shared_ptr<const PolygonResultCache::Entry> mResult;
+
+  // The result of the running calculation is swapped in by update() and cached with this key.
+  std::shared_ptr<ThreadPool>         mThreadPool;
+  std::shared_ptr<HeightProvider>     mHeightProvider;
+  AsyncCalculation<PolygonCalculator> mCalculation;
+  uint64_t                            mCalculationKey = 0;
+
+  static const int NUM_SAMPLES;
 
-  static const int   NUM_SAMPLES;
-  static const char* SHADER_VERT;
-  static const char* SHADER_FRAG;
+  // The mesh is not drawn if the polygon is smaller than this many pixels on screen.
+  static const float MESH_MIN_SCREEN_SIZE;
 };
 
 } // namespace csp::measurementtools
@@ -0,0 +1,170 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//                               This file is part of CosmoScout VR                               //
+//      and may be used under the terms of the MIT license. See the LICENSE file for details.     //
+//                        Copyright: (c) 2019 German Aerospace Center (DLR)                       //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "Statistics.hpp"
+
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+
+namespace csp::measurementtools {
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+Statistics::ScopedTimer::ScopedTimer(Statistics& statistics, Stage stage)
+    : mStatistics(statistics)
+    , mStage(stage)
+    , mStart(std::chrono::steady_clock::now()) {
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+Statistics::ScopedTimer::~ScopedTimer() {
+  std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - mStart;
+  mStatistics.addTime(mStage, elapsed.count());
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void Statistics::addTime(Stage stage, double milliseconds) {
+  mTimes.at(static_cast<size_t>(stage)) += milliseconds;
+  ++mCalls.at(static_cast<size_t>(stage));
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void Statistics::add(Counter counter, uint64_t value) {
+  mCounters.at(static_cast<size_t>(counter)) += value;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void Statistics::merge(Statistics const& other) {
+  for (size_t i(0); i < STAGE_COUNT; ++i) {
+    mTimes[i] += other.mTimes[i];
+    mCalls[i] += other.mCalls[i];
+  }
+
+  for (size_t i(0); i < COUNTER_COUNT; ++i) {
+    mCounters[i] += other.mCounters[i];
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void Statistics::reset() {
+  mTimes.fill(0.0);
+  mCalls.fill(0);
+  mCounters.fill(0);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+double Statistics::getTime(Stage stage) const {
+  return mTimes.at(static_cast<size_t>(stage));
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+uint64_t Statistics::getCalls(Stage stage) const {
+  return mCalls.at(static_cast<size_t>(stage));
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+uint64_t Statistics::get(Counter counter) const {
+  return mCounters.at(static_cast<size_t>(counter));
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool Statistics::getIsEmpty() const {
+  auto isZero = [](auto value) { return value == 0; };
+  return std::all_of(mCalls.begin(), mCalls.end(), isZero) &&
+         std::all_of(mCounters.begin(), mCounters.end(), isZero);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+std::string Statistics::toString() const {
+  std::ostringstream stream;
+  stream << std::fixed << std::setprecision(2);
+
+  char const* separator = "";
+
+  for (size_t i(0); i < STAGE_COUNT; ++i) {
+    if (mCalls[i] > 0) {
+      stream << separator << getName(static_cast<Stage>(i)) << ": " << mTimes[i] << " ms ("
+             << mCalls[i] << "x)";
+      separator = ", ";
+    }
+  }
+
+  for (size_t i(0); i < COUNTER_COUNT; ++i) {
+    if (mCounters[i] > 0) {
+      stream << separator << getName(static_cast<Counter>(i)) << ": " << mCounters[i];
+      separator = ", ";
+    }
+  }
+
+  return stream.str();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+char const* Statistics::getName(Stage stage) {
+  switch (stage) {
+  case Stage::eVoronoi:
+    return "voronoi";
+  case Stage::eCreateMesh:
+    return "createMesh";
+  case Stage::eCheckSleekness:
+    return "checkSleekness";
+  case Stage::eRefineMesh:
+    return "refineMesh";
+  case Stage::eAreaAndVolume:
+    return "areaAndVolume";
+  case Stage::eLineVertices:
+    return "lineVertices";
+  case Stage::eUpload:
+    return "upload";
+  default:
+    return "";
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+char const* Statistics::getName(Counter counter) {
+  switch (counter) {
+  case Counter::eSites:
+    return "sites";
+  case Counter::eCircleEvents:
+    return "circleEvents";
+  case Counter::eEdges:
+    return "edges";
+  case Counter::eHeightQueries:
+    return "heightQueries";
+  case Counter::eHeightCacheHits:
+    return "heightCacheHits";
+  case Counter::eUploadBytes:
+    return "uploadBytes";
+  case Counter::eAttempts:
+    return "attempts";
+  case Counter::ePoints:
+    return "points";
+  case Counter::eTiles:
+    return "tiles";
+  case Counter::eResultCacheHits:
+    return "resultCacheHits";
+  default:
+    return "";
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+} // namespace csp::measurementtools
@@ -0,0 +1,110 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//                               This file is part of CosmoScout VR                               //
+//      and may be used under the terms of the MIT license. See the LICENSE file for details.     //
+//                        Copyright: (c) 2019 German Aerospace Center (DLR)                       //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef CSP_MEASUREMENT_TOOLS_STATISTICS_HPP
+#define CSP_MEASUREMENT_TOOLS_STATISTICS_HPP
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+namespace csp::measurementtools {
+
+/// Timings and counters of the hot paths of the measurements. An instance is not synchronized;
+/// work which runs in parallel records into separate instances which are merged afterwards. The
+/// PolygonCalculator returns the statistics of its calculation, the tools and the LineRenderer
+/// record their per-frame work and the Plugin aggregates and reports all of them.
+class Statistics {
+ public:
+  /// The stages which are timed. eVoronoi is VoronoiGenerator::parse(), the next four are the
+  /// steps of the PolygonCalculator, eLineVertices is the sampling of the tools' lines on the
+  /// terrain and eUpload is the update of the LineRenderer's buffer objects.
+  enum class Stage {
+    eVoronoi,
+    eCreateMesh,
+    eCheckSleekness,
+    eRefineMesh,
+    eAreaAndVolume,
+    eLineVertices,
+    eUpload,
+    eCount
+  };
+
+  /// The quantities which are counted. eHeightQueries are the terrain heights which were not found
+  /// in the HeightCache, eAttempts and ePoints are the refinement attempts and the points of the
+  /// final mesh of the polygon calculations and eTiles the tiles large polygons are split into.
+  /// eResultCacheHits are the polygon calculations which were skipped as their result was cached.
+  enum class Counter {
+    eSites,
+    eCircleEvents,
+    eEdges,
+    eHeightQueries,
+    eHeightCacheHits,
+    eUploadBytes,
+    eAttempts,
+    ePoints,
+    eTiles,
+    eResultCacheHits,
+    eCount
+  };
+
+  /// Adds the time from its construction to its destruction to the given stage.
+  class ScopedTimer {
+   public:
+    ScopedTimer(Statistics& statistics, Stage stage);
+
+    ScopedTimer(ScopedTimer const& other) = delete;
+    ScopedTimer(ScopedTimer&& other)      = delete;
+
+    ScopedTimer& operator=(ScopedTimer const& other) = delete;
+    ScopedTimer& operator=(ScopedTimer&& other) = delete;
+
+    ~ScopedTimer();
+
+   private:
+    Statistics&                           mStatistics;
+    Stage                                 mStage;
+    std::chrono::steady_clock::time_point mStart;
+  };
+
+  /// Adds one call with the given duration to the stage.
+  void addTime(Stage stage, double milliseconds);
+
+  void add(Counter counter, uint64_t value);
+
+  /// Adds all timings and counters of the other instance to this one.
+  void merge(Statistics const& other);
+
+  /// Sets all timings and counters to zero.
+  void reset();
+
+  double   getTime(Stage stage) const;
+  uint64_t getCalls(Stage stage) const;
+  uint64_t get(Counter counter) const;
+
+  /// Returns true if nothing has been recorded since the last reset().
+  bool getIsEmpty() const;
+
+  /// A single line with all stages and counters which are not zero, for the log.
+  std::string toString() const;
+
+  /// The names which are used by toString() and by the statistics panel of the tab.
+  static char const* getName(Stage stage);
+  static char const* getName(Counter counter);
+
+ private:
+  static const size_t STAGE_COUNT   = static_cast<size_t>(Stage::eCount);
+  static const size_t COUNTER_COUNT = static_cast<size_t>(Counter::eCount);
+
+  std::array<double, STAGE_COUNT>     mTimes{};
+  std::array<uint64_t, STAGE_COUNT>   mCalls{};
+  std::array<uint64_t, COUNTER_COUNT> mCounters{};
+};
+
+} // namespace csp::measurementtools
+
+#endif // CSP_MEASUREMENT_TOOLS_STATISTICS_HPP
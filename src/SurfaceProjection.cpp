@@ -0,0 +1,142 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//                               This file is part of CosmoScout VR                               //
+//      and may be used under the terms of the MIT license. See the LICENSE file for details.     //
+//                        Copyright: (c) 2019 German Aerospace Center (DLR)                       //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "SurfaceProjection.hpp"
+
+#include <cmath>
+
+namespace csp::measurementtools::projection {
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+size_t SurfaceSamples::size() const {
+  return mHeights.size();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool SurfaceSamples::empty() const {
+  return mHeights.empty();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void SurfaceSamples::clear() {
+  mDirections.clear();
+  mHeights.clear();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void SurfaceSamples::append(SurfaceSamples const& other, size_t begin, size_t end) {
+  mDirections.insert(
+      mDirections.end(), other.mDirections.begin() + begin, other.mDirections.begin() + end);
+  mHeights.insert(mHeights.end(), other.mHeights.begin() + begin, other.mHeights.begin() + end);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void planeToSurface(TangentPlane const& plane, double radius,
+    std::vector<glm::dvec2> const& points, std::vector<glm::dvec3>& positions) {
+  positions.resize(points.size());
+
+  glm::dvec3 east  = plane.mEast * plane.mScale;
+  glm::dvec3 north = plane.mNorth * plane.mScale;
+
+  for (size_t i = 0; i < points.size(); ++i) {
+    double x = plane.mOrigin.x + points[i].x * east.x + points[i].y * north.x;
+    double y = plane.mOrigin.y + points[i].x * east.y + points[i].y * north.y;
+    double z = plane.mOrigin.z + points[i].x * east.z + points[i].y * north.z;
+    double f = radius / std::sqrt(x * x + y * y + z * z);
+
+    positions[i] = glm::dvec3(x * f, y * f, z * f);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void toSurface(double radius, std::vector<glm::dvec3> const& positions,
+    std::vector<glm::dvec3>& surfacePositions) {
+  surfacePositions.resize(positions.size());
+
+  for (size_t i = 0; i < positions.size(); ++i) {
+    glm::dvec3 p = positions[i];
+    double     f = radius / std::sqrt(p.x * p.x + p.y * p.y + p.z * p.z);
+
+    surfacePositions[i] = glm::dvec3(p.x * f, p.y * f, p.z * f);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void toLngLat(std::vector<glm::dvec3> const& positions, std::vector<glm::dvec2>& lngLats) {
+  lngLats.resize(positions.size());
+
+  for (size_t i = 0; i < positions.size(); ++i) {
+    glm::dvec3 p = positions[i];
+    double     l = std::sqrt(p.x * p.x + p.y * p.y + p.z * p.z);
+
+    lngLats[i] = glm::dvec2(std::atan2(p.x, p.z), std::asin(p.y / l));
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void toCartesian(double radius, std::vector<glm::dvec2> const& lngLats,
+    std::vector<double> const& heights, double heightScale, std::vector<glm::dvec3>& positions) {
+  positions.resize(lngLats.size());
+
+  for (size_t i = 0; i < lngLats.size(); ++i) {
+    double cosLat = std::cos(lngLats[i].y);
+    double f      = radius + heights[i] * heightScale;
+
+    positions[i] = glm::dvec3(cosLat * std::sin(lngLats[i].x) * f, std::sin(lngLats[i].y) * f,
+        cosLat * std::cos(lngLats[i].x) * f);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void toSurfaceSamples(std::vector<glm::dvec2> const& lngLats, std::vector<double> const& heights,
+    SurfaceSamples& samples) {
+  samples.mDirections.resize(lngLats.size());
+  samples.mHeights = heights;
+
+  for (size_t i = 0; i < lngLats.size(); ++i) {
+    double cosLat = std::cos(lngLats[i].y);
+
+    samples.mDirections[i] = glm::dvec3(
+        cosLat * std::sin(lngLats[i].x), std::sin(lngLats[i].y), cosLat * std::cos(lngLats[i].x));
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void toCartesian(double radius, SurfaceSamples const& samples, double heightScale,
+    std::vector<glm::dvec3>& positions) {
+  positions.resize(samples.size());
+
+  for (size_t i = 0; i < samples.size(); ++i) {
+    positions[i] = samples.mDirections[i] * (radius + samples.mHeights[i] * heightScale);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void queryHeights(HeightCache::HeightSource const& source, std::vector<glm::dvec2> const& lngLats,
+    std::vector<double>& heights) {
+  heights.resize(lngLats.size());
+
+  // The bodies do not offer a batched query yet, so this is the single place where the points
+  // would be grouped by terrain tile.
+  for (size_t i = 0; i < lngLats.size(); ++i) {
+    heights[i] = source(lngLats[i]);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+} // namespace csp::measurementtools::projection
@@ -0,0 +1,83 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//                               This file is part of CosmoScout VR                               //
+//      and may be used under the terms of the MIT license. See the LICENSE file for details.     //
+//                        Copyright: (c) 2019 German Aerospace Center (DLR)                       //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef CSP_MEASUREMENT_TOOLS_SURFACE_PROJECTION_HPP
+#define CSP_MEASUREMENT_TOOLS_SURFACE_PROJECTION_HPP
+
+#include "HeightCache.hpp"
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+/// Converts whole batches of coordinates between a tool's plane, cartesian space and lng/lat. The
+/// tools gather all points they need, convert them with one call per stage and scatter the results
+/// afterwards. The loops only contain plain arithmetic on contiguous arrays, so that the compiler
+/// can vectorize them. All functions treat the body as a sphere with the given radius, as the
+/// tools only use the equatorial radius of a body anyways. The output vectors are resized to the
+/// size of the input.
+namespace csp::measurementtools::projection {
+
+/// A plane which touches the body at mOrigin. Points on the plane are given in the coordinate
+/// system which is spanned by mEast and mNorth, scaled by mScale.
+struct TangentPlane {
+  glm::dvec3 mOrigin;
+  glm::dvec3 mEast;
+  glm::dvec3 mNorth;
+  double     mScale;
+};
+
+/// Points on the surface of a body which are stored independently of the height scale. The tools
+/// keep these, so that their positions can be rebuilt without querying the terrain again if only
+/// the height scale changes.
+struct SurfaceSamples {
+  /// Normalized directions from the body's center.
+  std::vector<glm::dvec3> mDirections;
+
+  /// Heights above the surface, without the height scale.
+  std::vector<double> mHeights;
+
+  size_t size() const;
+  bool   empty() const;
+  void   clear();
+
+  /// Appends all samples of other in [begin, end).
+  void append(SurfaceSamples const& other, size_t begin, size_t end);
+};
+
+/// Projects the given points of the plane onto the surface, along the rays through the center.
+void planeToSurface(TangentPlane const& plane, double radius,
+    std::vector<glm::dvec2> const& points, std::vector<glm::dvec3>& positions);
+
+/// Projects the given cartesian positions onto the surface, along the rays through the center.
+void toSurface(double radius, std::vector<glm::dvec3> const& positions,
+    std::vector<glm::dvec3>& surfacePositions);
+
+/// Converts cartesian positions to lng/lat in radians.
+void toLngLat(std::vector<glm::dvec3> const& positions, std::vector<glm::dvec2>& lngLats);
+
+/// Converts lng/lat in radians to cartesian positions. The heights are multiplied with the given
+/// height scale.
+void toCartesian(double radius, std::vector<glm::dvec2> const& lngLats,
+    std::vector<double> const& heights, double heightScale, std::vector<glm::dvec3>& positions);
+
+/// Stores the given lng/lat in radians and the unscaled heights as surface samples.
+void toSurfaceSamples(std::vector<glm::dvec2> const& lngLats, std::vector<double> const& heights,
+    SurfaceSamples& samples);
+
+/// Converts surface samples to cartesian positions. The heights are multiplied with the given
+/// height scale. This does not involve any trigonometry, so it is cheap enough to be called
+/// whenever the height scale changes.
+void toCartesian(double radius, SurfaceSamples const& samples, double heightScale,
+    std::vector<glm::dvec3>& positions);
+
+/// Queries the heights at all given lng/lat coordinates from the source with one request.
+void queryHeights(HeightCache::HeightSource const& source, std::vector<glm::dvec2> const& lngLats,
+    std::vector<double>& heights);
+
+} // namespace csp::measurementtools::projection
+
+#endif // CSP_MEASUREMENT_TOOLS_SURFACE_PROJECTION_HPP
@@ -0,0 +1,74 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//                               This file is part of CosmoScout VR                               //
+//      and may be used under the terms of the MIT license. See the LICENSE file for details.     //
+//                        Copyright: (c) 2019 German Aerospace Center (DLR)                       //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "ThreadPool.hpp"
+
+#include <algorithm>
+
+namespace csp::measurementtools {
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+ThreadPool::ThreadPool(size_t threadCount) {
+  if (threadCount == 0) {
+    threadCount = std::max(std::thread::hardware_concurrency(), 2U) - 1;
+  }
+
+  mThreads.reserve(threadCount);
+  for (size_t i(0); i < threadCount; ++i) {
+    mThreads.emplace_back([this]() { run(); });
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+ThreadPool::~ThreadPool() {
+  {
+    std::unique_lock<std::mutex> lock(mMutex);
+    mStop = true;
+
+    // Pending tasks are dropped; their futures will report a broken promise.
+    mTasks = {};
+  }
+
+  mCondition.notify_all();
+
+  for (auto& thread : mThreads) {
+    thread.join();
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+size_t ThreadPool::getThreadCount() const {
+  return mThreads.size();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void ThreadPool::run() {
+  while (true) {
+    std::function<void()> task;
+
+    {
+      std::unique_lock<std::mutex> lock(mMutex);
+      mCondition.wait(lock, [this]() { return mStop || !mTasks.empty(); });
+
+      if (mStop) {
+        return;
+      }
+
+      task = std::move(mTasks.front());
+      mTasks.pop();
+    }
+
+    task();
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+} // namespace csp::measurementtools
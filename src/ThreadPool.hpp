@@ -0,0 +1,160 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//                               This file is part of CosmoScout VR                               //
+//      and may be used under the terms of the MIT license. See the LICENSE file for details.     //
+//                        Copyright: (c) 2019 German Aerospace Center (DLR)                       //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef CSP_MEASUREMENT_TOOLS_THREAD_POOL_HPP
+#define CSP_MEASUREMENT_TOOLS_THREAD_POOL_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace csp::measurementtools {
+
+/// A simple pool of worker threads which is used by the tools to run expensive calculations off
+/// the render thread. Tasks are executed in the order they were enqueued. When the pool is
+/// destroyed, all tasks which have not been started yet are discarded and the running tasks are
+/// waited for.
+class ThreadPool {
+ public:
+  /// If threadCount is zero, one thread less than the number of hardware threads is used (but at
+  /// least one), so that the render thread keeps a core for itself.
+  explicit ThreadPool(size_t threadCount = 0);
+
+  ThreadPool(ThreadPool const& other) = delete;
+  ThreadPool(ThreadPool&& other)      = delete;
+
+  ThreadPool& operator=(ThreadPool const& other) = delete;
+  ThreadPool& operator=(ThreadPool&& other) = delete;
+
+  ~ThreadPool();
+
+  /// Schedules the given callable for execution on one of the worker threads. The returned future
+  /// can be polled from the main thread; other than futures returned by std::async, it does not
+  /// block on destruction.
+  template <typename F>
+  std::future<std::invoke_result_t<F>> enqueue(F&& task);
+
+  /// Calls task(i) for each i in [0, count) and returns once all calls have finished. The calls
+  /// are distributed over the worker threads and the calling thread. As the calling thread works
+  /// on the tasks as well, this can safely be used from within a task of this pool. If a call
+  /// throws, the first exception is rethrown once all calls have finished.
+  template <typename F>
+  void parallelFor(size_t count, F const& task);
+
+  size_t getThreadCount() const;
+
+ private:
+  void run();
+
+  std::vector<std::thread>          mThreads;
+  std::queue<std::function<void()>> mTasks;
+  std::mutex                        mMutex;
+  std::condition_variable           mCondition;
+  bool                              mStop = false;
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+template <typename F>
+std::future<std::invoke_result_t<F>> ThreadPool::enqueue(F&& task) {
+  // std::function requires copyable callables, therefore the packaged_task is shared.
+  auto packagedTask =
+      std::make_shared<std::packaged_task<std::invoke_result_t<F>()>>(std::forward<F>(task));
+  auto future = packagedTask->get_future();
+
+  {
+    std::unique_lock<std::mutex> lock(mMutex);
+    mTasks.emplace([packagedTask]() { (*packagedTask)(); });
+  }
+
+  mCondition.notify_one();
+  return future;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+template <typename F>
+void ThreadPool::parallelFor(size_t count, F const& task) {
+  if (count == 0) {
+    return;
+  }
+
+  // The state is shared with the helper tasks, as these may be started only after all indices
+  // have been processed and this method has returned. In this case they do nothing.
+  struct State {
+    std::atomic_size_t      mNext{0};
+    size_t                  mDone = 0;
+    std::exception_ptr      mException;
+    std::mutex              mMutex;
+    std::condition_variable mCondition;
+  };
+
+  auto state = std::make_shared<State>();
+
+  auto work = [state, count, &task]() {
+    size_t             done = 0;
+    std::exception_ptr exception;
+
+    for (size_t i = state->mNext++; i < count; i = state->mNext++) {
+      try {
+        task(i);
+      } catch (...) {
+        if (!exception) {
+          exception = std::current_exception();
+        }
+      }
+      ++done;
+    }
+
+    if (done > 0) {
+      std::unique_lock<std::mutex> lock(state->mMutex);
+      state->mDone += done;
+
+      if (exception && !state->mException) {
+        state->mException = exception;
+      }
+
+      if (state->mDone == count) {
+        state->mCondition.notify_all();
+      }
+    }
+  };
+
+  size_t helpers = std::min(mThreads.size(), count - 1);
+
+  if (helpers > 0) {
+    {
+      std::unique_lock<std::mutex> lock(mMutex);
+      for (size_t i(0); i < helpers; ++i) {
+        mTasks.emplace(work);
+      }
+    }
+
+    mCondition.notify_all();
+  }
+
+  work();
+
+  std::unique_lock<std::mutex> lock(state->mMutex);
+  state->mCondition.wait(lock, [&state, count]() { return state->mDone == count; });
+
+  if (state->mException) {
+    std::rethrow_exception(state->mException);
+  }
+}
+
+} // namespace csp::measurementtools
+
+#endif // CSP_MEASUREMENT_TOOLS_THREAD_POOL_HPP
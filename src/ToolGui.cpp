@@ -0,0 +1,180 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//                               This file is part of CosmoScout VR                               //
+//      and may be used under the terms of the MIT license. See the LICENSE file for details.     //
+//                        Copyright: (c) 2019 German Aerospace Center (DLR)                       //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "ToolGui.hpp"
+
+#include "../../../src/cs-core/GuiManager.hpp"
+#include "../../../src/cs-core/InputManager.hpp"
+#include "../../../src/cs-gui/WorldSpaceGuiArea.hpp"
+#include "../../../src/cs-scene/CelestialAnchorNode.hpp"
+#include "../../../src/cs-scene/CelestialObserver.hpp"
+#include "../../../src/cs-utils/utils.hpp"
+
+#include <VistaKernel/GraphicsManager/VistaOpenGLNode.h>
+#include <VistaKernel/GraphicsManager/VistaSceneGraph.h>
+#include <VistaKernel/GraphicsManager/VistaTransformNode.h>
+#include <VistaKernel/VistaSystem.h>
+#include <VistaKernelOpenSGExt/VistaOpenSGMaterialTools.h>
+
+#include <algorithm>
+
+namespace csp::measurementtools {
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+ToolGui::ToolGui(std::shared_ptr<cs::core::InputManager> pInputManager,
+    std::shared_ptr<cs::scene::CelestialAnchorNode> pAnchor, std::string sUrl, int width,
+    int height, glm::vec3 const& offset)
+    : mInputManager(std::move(pInputManager))
+    , mAnchor(std::move(pAnchor))
+    , mUrl(std::move(sUrl))
+    , mWidth(width)
+    , mHeight(height)
+    , mOffset(offset) {
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+ToolGui::~ToolGui() {
+  destroy();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void ToolGui::update(
+    GuiPool& pool, cs::scene::CelestialObserver const& observer, double simulationTime) {
+  mPool     = &pool;
+  mDistance = observer.getAnchorScale() *
+              glm::length(observer.getRelativePosition(simulationTime, *mAnchor));
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+double ToolGui::getDistance() const {
+  return mDistance;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void ToolGui::setShouldBeCreated(bool shouldBeCreated) {
+  mShouldBeCreated = shouldBeCreated;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool ToolGui::getIsCreated() const {
+  return mItem != nullptr;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool ToolGui::hasPendingUpdate() const {
+  return getIsCreated() != mShouldBeCreated;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+double ToolGui::getUpdatePriority() const {
+  // Releasing a web view is cheap and allows other tools to use it, so this is done before
+  // anything else.
+  if (getIsCreated()) {
+    return -1.0;
+  }
+
+  return mDistance;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void ToolGui::processPendingUpdate() {
+  if (getIsCreated()) {
+    destroy();
+  } else {
+    create();
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void ToolGui::create() {
+  if (mItem || !mPool) {
+    return;
+  }
+
+  // If all web views are in use, this is tried again in the next frame. By then the tools which
+  // are further away have given theirs back.
+  mItem = mPool->acquire(mUrl, mWidth, mHeight);
+
+  if (!mItem) {
+    return;
+  }
+
+  auto* pSG = GetVistaSystem()->GetGraphicsManager()->GetSceneGraph();
+
+  mGuiTransform.reset(pSG->NewTransformNode(mAnchor.get()));
+  mGuiTransform->Translate(mOffset.x, mOffset.y, mOffset.z);
+  mGuiTransform->Scale(0.001F * static_cast<float>(mItem->mGuiArea->getWidth()),
+      0.001F * static_cast<float>(mItem->mGuiArea->getHeight()), 1.F);
+  mGuiTransform->Rotate(VistaAxisAndAngle(VistaVector3D(0.0, 1.0, 0.0), -glm::pi<float>() / 2.F));
+
+  mGuiNode.reset(pSG->NewOpenGLNode(mGuiTransform.get(), mItem->mGuiArea.get()));
+  mInputManager->registerSelectable(mGuiNode.get());
+
+  VistaOpenSGMaterialTools::SetSortKeyOnSubtree(
+      mGuiNode.get(), static_cast<int>(cs::utils::DrawOrder::eTransparentItems));
+
+  auto& guiItem = *mItem->mGuiItem;
+  guiItem.setCursorChangeCallback([](cs::gui::Cursor c) { cs::core::GuiManager::setCursor(c); });
+
+  for (auto const& callback : mCallbacks) {
+    callback(guiItem);
+  }
+
+  for (auto const& call : mCalls) {
+    call.mCall(guiItem);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void ToolGui::destroy() {
+  if (!mItem) {
+    return;
+  }
+
+  for (auto const& name : mCallbackNames) {
+    mItem->mGuiItem->unregisterCallback(name);
+  }
+
+  mInputManager->unregisterSelectable(mGuiNode.get());
+  mAnchor->DisconnectChild(mGuiTransform.get());
+
+  mGuiNode.reset();
+  mGuiTransform.reset();
+
+  mPool->release(std::move(mItem));
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void ToolGui::storeCall(std::string const& key, std::function<void(cs::gui::GuiItem&)> call) {
+  if (mItem) {
+    call(*mItem->mGuiItem);
+  }
+
+  auto it = std::find_if(
+      mCalls.begin(), mCalls.end(), [&key](Call const& stored) { return stored.mKey == key; });
+
+  if (it != mCalls.end()) {
+    it->mCall = std::move(call);
+  } else {
+    mCalls.push_back({key, std::move(call)});
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+} // namespace csp::measurementtools
@@ -0,0 +1,169 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//                               This file is part of CosmoScout VR                               //
+//      and may be used under the terms of the MIT license. See the LICENSE file for details.     //
+//                        Copyright: (c) 2019 German Aerospace Center (DLR)                       //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef CSP_MEASUREMENT_TOOLS_TOOL_GUI_HPP
+#define CSP_MEASUREMENT_TOOLS_TOOL_GUI_HPP
+
+#include "../../../src/cs-gui/GuiItem.hpp"
+#include "GuiPool.hpp"
+#include "UpdateScheduler.hpp"
+
+#include <functional>
+#include <glm/glm.hpp>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace cs::core {
+class InputManager;
+} // namespace cs::core
+
+namespace cs::scene {
+class CelestialAnchorNode;
+class CelestialObserver;
+} // namespace cs::scene
+
+class VistaOpenGLNode;
+class VistaTransformNode;
+
+namespace csp::measurementtools {
+
+/// The web based user interface of a tool. The tool only has a web view while the GuiPool assigns
+/// one to it, which happens when it is one of the tools closest to the observer. This way, loading
+/// a session with many tools does not create a web view for each of them.
+///
+/// The tools register their callbacks and call JavaScript functions at any time. The callbacks
+/// are registered whenever the tool gets a web view. For each JavaScript function, the arguments
+/// of the latest call are stored and sent to each web view the tool gets, so that it shows the
+/// current state of the tool.
+///
+/// Creating a web view blocks until its page is loaded. Therefore web views are acquired by the
+/// UpdateScheduler, which handles the user interfaces closest to the observer first and spreads
+/// the others over the following frames.
+class ToolGui : public UpdateScheduler::Client {
+ public:
+  /// The user interface is attached to the given anchor and shifted by the given offset. The
+  /// offset is given in units of the anchor, before the user interface is scaled to its size.
+  ToolGui(std::shared_ptr<cs::core::InputManager> pInputManager,
+      std::shared_ptr<cs::scene::CelestialAnchorNode> pAnchor, std::string sUrl, int width,
+      int height, glm::vec3 const& offset);
+
+  ToolGui(ToolGui const& other) = delete;
+  ToolGui(ToolGui&& other)      = delete;
+
+  ToolGui& operator=(ToolGui const& other) = delete;
+  ToolGui& operator=(ToolGui&& other) = delete;
+
+  ~ToolGui() override;
+
+  /// Registers the callback with each web view the tool gets.
+  template <typename... Args>
+  void registerCallback(std::string const& name, std::string const& comment,
+      std::function<void(Args...)> const& callback);
+
+  /// Calls the given JavaScript function if the tool currently has a web view. The call is stored
+  /// and repeated on each web view the tool gets later. Only the latest call to each function is
+  /// stored.
+  template <typename... Args>
+  void callJavascript(std::string const& function, Args&&... args);
+
+  /// The same as above, but the call replaces the stored call with the given key instead of the
+  /// one with the same function name. This is required for functions which are called for
+  /// several elements of the user interface, such as CosmoScout.gui.setSliderValue.
+  template <typename... Args>
+  void callJavascriptWithKey(std::string const& key, std::string const& function, Args&&... args);
+
+  /// Updates the distance of the user interface to the observer. This is called by the GuiPool
+  /// once per frame.
+  void update(
+      GuiPool& pool, cs::scene::CelestialObserver const& observer, double simulationTime);
+  double getDistance() const;
+
+  /// This is set by the GuiPool. If the user interface should have a web view, it is acquired
+  /// the next time the UpdateScheduler processes this.
+  void setShouldBeCreated(bool shouldBeCreated);
+
+  /// Returns true if the tool currently has a web view.
+  bool getIsCreated() const;
+
+  /// These are called by the UpdateScheduler. The web view is acquired or released in
+  /// processPendingUpdate().
+  bool   hasPendingUpdate() const override;
+  double getUpdatePriority() const override;
+  void   processPendingUpdate() override;
+
+ private:
+  void create();
+  void destroy();
+
+  struct Call {
+    std::string                            mKey;
+    std::function<void(cs::gui::GuiItem&)> mCall;
+  };
+
+  void storeCall(std::string const& key, std::function<void(cs::gui::GuiItem&)> call);
+
+  std::shared_ptr<cs::core::InputManager>         mInputManager;
+  std::shared_ptr<cs::scene::CelestialAnchorNode> mAnchor;
+  std::string                                     mUrl;
+  int                                             mWidth;
+  int                                             mHeight;
+  glm::vec3                                       mOffset;
+
+  GuiPool*                            mPool = nullptr;
+  std::unique_ptr<GuiPool::Item>      mItem;
+  std::unique_ptr<VistaTransformNode> mGuiTransform;
+  std::unique_ptr<VistaOpenGLNode>    mGuiNode;
+
+  // The callbacks and JavaScript calls which are applied to each web view the tool gets. The
+  // calls are repeated in the order in which their keys were first used.
+  std::vector<std::string>                            mCallbackNames;
+  std::vector<std::function<void(cs::gui::GuiItem&)>> mCallbacks;
+  std::vector<Call>                                   mCalls;
+
+  double mDistance        = 0.0;
+  bool   mShouldBeCreated = false;
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+template <typename... Args>
+void ToolGui::registerCallback(std::string const& name, std::string const& comment,
+    std::function<void(Args...)> const& callback) {
+  mCallbackNames.push_back(name);
+  mCallbacks.emplace_back([name, comment, callback](cs::gui::GuiItem& item) {
+    item.registerCallback(name, comment, callback);
+  });
+
+  if (mItem) {
+    mCallbacks.back()(*mItem->mGuiItem);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+template <typename... Args>
+void ToolGui::callJavascript(std::string const& function, Args&&... args) {
+  callJavascriptWithKey(function, function, std::forward<Args>(args)...);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+template <typename... Args>
+void ToolGui::callJavascriptWithKey(
+    std::string const& key, std::string const& function, Args&&... args) {
+  storeCall(key, [function, args = std::make_tuple(std::decay_t<Args>(args)...)](
+                     cs::gui::GuiItem& item) {
+    std::apply([&](auto const&... values) { item.callJavascript(function, values...); }, args);
+  });
+}
+
+} // namespace csp::measurementtools
+
+#endif // CSP_MEASUREMENT_TOOLS_TOOL_GUI_HPP
@@ -0,0 +1,75 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//                               This file is part of CosmoScout VR                               //
+//      and may be used under the terms of the MIT license. See the LICENSE file for details.     //
+//                        Copyright: (c) 2019 German Aerospace Center (DLR)                       //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "UpdateScheduler.hpp"
+
+#include "../../../src/cs-scene/CelestialObserver.hpp"
+
+#include <glm/glm.hpp>
+
+#include <chrono>
+#include <utility>
+
+namespace csp::measurementtools {
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void UpdateScheduler::setBudget(double milliseconds) {
+  mBudget = milliseconds;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void UpdateScheduler::run(std::vector<Client*> const& clients) {
+  auto start = std::chrono::steady_clock::now();
+
+  std::vector<std::pair<double, Client*>> pending;
+
+  for (auto* client : clients) {
+    if (client->hasPendingUpdate()) {
+      pending.emplace_back(client->getUpdatePriority(), client);
+    }
+  }
+
+  std::sort(pending.begin(), pending.end(),
+      [](auto const& a, auto const& b) { return a.first < b.first; });
+
+  size_t processed = 0;
+
+  while (processed < pending.size()) {
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+    if (processed > 0 && elapsed.count() >= mBudget) {
+      break;
+    }
+
+    pending[processed].second->processPendingUpdate();
+    ++processed;
+  }
+
+  mPostponedCount = pending.size() - processed;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+size_t UpdateScheduler::getPostponedCount() const {
+  return mPostponedCount;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+double UpdateScheduler::getPriority(cs::scene::CelestialObserver const& observer,
+    double simulationTime, cs::scene::CelestialAnchor const& anchor, bool edited) {
+  if (edited) {
+    return -1.0;
+  }
+
+  return glm::length(observer.getRelativePosition(simulationTime, anchor));
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+} // namespace csp::measurementtools
@@ -0,0 +1,77 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//                               This file is part of CosmoScout VR                               //
+//      and may be used under the terms of the MIT license. See the LICENSE file for details.     //
+//                        Copyright: (c) 2019 German Aerospace Center (DLR)                       //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef CSP_MEASUREMENT_TOOLS_UPDATE_SCHEDULER_HPP
+#define CSP_MEASUREMENT_TOOLS_UPDATE_SCHEDULER_HPP
+
+#include <algorithm>
+#include <vector>
+
+namespace cs::scene {
+class CelestialAnchor;
+class CelestialObserver;
+} // namespace cs::scene
+
+namespace csp::measurementtools {
+
+/// Spreads the expensive recomputations of the tools over several frames. The tools only do their
+/// cheap per-frame work in update(); work like sampling the terrain along their lines is
+/// postponed until the scheduler asks for it. Once per frame, the Plugin passes all tools to
+/// run(), which processes the pending ones in the order of their priority until the time budget
+/// of the frame is used up. The calculations which the tools start on the thread pool are not
+/// part of the budget.
+class UpdateScheduler {
+ public:
+  /// A tool with work which can be postponed.
+  class Client {
+   public:
+    virtual ~Client() = default;
+
+    /// Should return true if the tool has to be recomputed.
+    virtual bool hasPendingUpdate() const = 0;
+
+    /// Clients with a lower value are processed first. See getPriority().
+    virtual double getUpdatePriority() const = 0;
+
+    /// Does the postponed work.
+    virtual void processPendingUpdate() = 0;
+  };
+
+  /// The time in milliseconds which may be spent on the clients in each frame. At least one
+  /// pending client is processed per frame, so all work finishes eventually.
+  void setBudget(double milliseconds);
+
+  /// Processes the pending clients in the order of their priority until the budget is used up.
+  void run(std::vector<Client*> const& clients);
+
+  /// The number of clients which had to be postponed to the next frame in the last call to run().
+  size_t getPostponedCount() const;
+
+  /// A priority for tools which are placed at the given anchor. Tools which are being edited come
+  /// first, all others are ordered by their distance to the observer.
+  static double getPriority(cs::scene::CelestialObserver const& observer, double simulationTime,
+      cs::scene::CelestialAnchor const& anchor, bool edited);
+
+  /// Returns true if one of the given marks is being dragged or is selected.
+  template <typename Marks>
+  static bool isEdited(Marks const& marks);
+
+ private:
+  double mBudget         = 2.0;
+  size_t mPostponedCount = 0;
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+template <typename Marks>
+bool UpdateScheduler::isEdited(Marks const& marks) {
+  return std::any_of(marks.begin(), marks.end(),
+      [](auto const& mark) { return mark->pActive.get() || mark->pSelected.get(); });
+}
+
+} // namespace csp::measurementtools
+
+#endif // CSP_MEASUREMENT_TOOLS_UPDATE_SCHEDULER_HPP
@@ -6,7 +6,6 @@
 
 #include "Beachline.hpp"
 
-#include "Arc.hpp"
 #include "VoronoiGenerator.hpp"
 
 namespace csp::measurementtools {
@@ -19,11 +18,11 @@ Beachline::Beachline(VoronoiGenerator* parent)
 Arc* Beachline::insertArcFor(Site const& site) {
   // if site creates the very first Arc of the Beachline
   if (mRoot == nullptr) {
-    mRoot = new Arc(site); // NOLINT(cppcoreguidelines-owning-memory): TODO
+    mRoot = mArcPool.create(site);
     return mRoot;
   }
 
-  Arc* newArc = new Arc(site); // NOLINT(cppcoreguidelines-owning-memory): TODO
+  Arc* newArc = mArcPool.create(site);
 
   Arc* brokenArcLeft = mBreakPoints.empty() ? mRoot : mBreakPoints.getArcAt(site.mX);
   brokenArcLeft->invalidateEvent();
@@ -31,31 +30,30 @@ Arc* Beachline::insertArcFor(Site const& site) {
   // site inserted at exactly the same height as brokenArcLeft
   if (site.mY == brokenArcLeft->mSite.mY) {
     if (site.mX < brokenArcLeft->mSite.mX) {
-      // NOLINTNEXTLINE(cppcoreguidelines-owning-memory): TODO
-      newArc->mRightBreak = new Breakpoint(newArc, brokenArcLeft, mParent);
-      mParent->addTriangulationEdge(brokenArcLeft->mSite, newArc->mSite);
+      newArc->mRightBreak = mBreakpointPool.create(newArc, brokenArcLeft, mParent);
+      newArc->mRightBreak->mEdge =
+          mParent->addTriangulationEdge(brokenArcLeft->mSite, newArc->mSite);
       brokenArcLeft->mLeftBreak = newArc->mRightBreak;
       mBreakPoints.insert(newArc->mRightBreak);
     }
     // new one is right of brokenArcLeft
     else {
-      // NOLINTNEXTLINE(cppcoreguidelines-owning-memory): TODO
-      newArc->mLeftBreak = new Breakpoint(brokenArcLeft, newArc, mParent);
-      mParent->addTriangulationEdge(brokenArcLeft->mSite, newArc->mSite);
+      newArc->mLeftBreak = mBreakpointPool.create(brokenArcLeft, newArc, mParent);
+      newArc->mLeftBreak->mEdge =
+          mParent->addTriangulationEdge(brokenArcLeft->mSite, newArc->mSite);
       brokenArcLeft->mRightBreak = newArc->mLeftBreak;
       mBreakPoints.insert(newArc->mLeftBreak);
     }
   } else {
-    // NOLINTNEXTLINE(cppcoreguidelines-owning-memory): TODO
-    Arc* brokenArcRight = new Arc(brokenArcLeft->mSite);
+    Arc* brokenArcRight = mArcPool.create(brokenArcLeft->mSite);
 
-    // NOLINTNEXTLINE(cppcoreguidelines-owning-memory): TODO
-    newArc->mLeftBreak = new Breakpoint(brokenArcLeft, newArc, mParent);
+    newArc->mLeftBreak = mBreakpointPool.create(brokenArcLeft, newArc, mParent);
 
-    // NOLINTNEXTLINE(cppcoreguidelines-owning-memory): TODO
-    newArc->mRightBreak = new Breakpoint(newArc, brokenArcRight, mParent);
+    newArc->mRightBreak = mBreakpointPool.create(newArc, brokenArcRight, mParent);
 
-    mParent->addTriangulationEdge(brokenArcLeft->mSite, newArc->mSite);
+    // Both breakpoints trace the same Voronoi edge in opposite directions.
+    newArc->mLeftBreak->mEdge  = mParent->addTriangulationEdge(brokenArcLeft->mSite, newArc->mSite);
+    newArc->mRightBreak->mEdge = newArc->mLeftBreak->mEdge;
 
     brokenArcRight->mRightBreak = brokenArcLeft->mRightBreak;
     if (brokenArcRight->mRightBreak) {
@@ -84,10 +82,9 @@ void Beachline::removeArc(Arc* arc) {
   }
 
   if (leftArc && rightArc) {
-    // NOLINTNEXTLINE(cppcoreguidelines-owning-memory): TODO
-    auto* merged = new Breakpoint(leftArc, rightArc, mParent);
+    auto* merged = mBreakpointPool.create(leftArc, rightArc, mParent);
 
-    mParent->addTriangulationEdge(leftArc->mSite, rightArc->mSite);
+    merged->mEdge = mParent->addTriangulationEdge(leftArc->mSite, rightArc->mSite);
 
     leftArc->mRightBreak = merged;
     rightArc->mLeftBreak = merged;
@@ -96,23 +93,23 @@ void Beachline::removeArc(Arc* arc) {
     mBreakPoints.remove(arc->mLeftBreak);
 
     mBreakPoints.insert(merged);
-
-    delete arc->mLeftBreak;  // NOLINT(cppcoreguidelines-owning-memory): TODO
-    delete arc->mRightBreak; // NOLINT(cppcoreguidelines-owning-memory): TODO
   } else if (leftArc) {
     mBreakPoints.remove(arc->mLeftBreak);
     leftArc->mRightBreak = nullptr;
-    delete arc->mLeftBreak; // NOLINT(cppcoreguidelines-owning-memory): TODO
   } else if (rightArc) {
     mBreakPoints.remove(arc->mRightBreak);
     rightArc->mLeftBreak = nullptr;
-    delete arc->mRightBreak; // NOLINT(cppcoreguidelines-owning-memory): TODO
   }
-
-  delete arc; // NOLINT(cppcoreguidelines-owning-memory): TODO
 }
 
 void Beachline::finish(std::vector<Edge>& edges) {
   mBreakPoints.finishAll(edges);
 }
+
+void Beachline::clear() {
+  mBreakPoints.clear();
+  mRoot = nullptr;
+  mArcPool.clear();
+  mBreakpointPool.clear();
+}
 } // namespace csp::measurementtools
@@ -7,8 +7,10 @@
 #ifndef CSP_MEASUREMENT_TOOLS_BEACHLINE_HPP
 #define CSP_MEASUREMENT_TOOLS_BEACHLINE_HPP
 
+#include "Arc.hpp"
 #include "Breakpoint.hpp"
 #include "BreakpointTree.hpp"
+#include "ObjectPool.hpp"
 #include "Site.hpp"
 
 #include <memory>
@@ -21,14 +23,29 @@ class Beachline {
  public:
   explicit Beachline(VoronoiGenerator* parent);
 
+  Beachline(Beachline const& other) = delete;
+  Beachline(Beachline&& other)      = delete;
+
+  Beachline& operator=(Beachline const& other) = delete;
+  Beachline& operator=(Beachline&& other) = delete;
+
+  ~Beachline() = default;
+
   Arc* insertArcFor(Site const& site);
   void removeArc(Arc* arc);
   void finish(std::vector<Edge>& edges);
 
+  /// Destroys all arcs and breakpoints at once. The memory of the pools is kept for the next
+  /// parse.
+  void clear();
+
  private:
   BreakpointTree    mBreakPoints;
   VoronoiGenerator* mParent;
   Arc*              mRoot;
+
+  ObjectPool<Arc>        mArcPool;
+  ObjectPool<Breakpoint> mBreakpointPool;
 };
 } // namespace csp::measurementtools
 #endif // CSP_MEASUREMENT_TOOLS_BEACHLINE_HPP
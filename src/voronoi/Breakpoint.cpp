@@ -8,6 +8,7 @@
 #include "Arc.hpp"
 #include "VoronoiGenerator.hpp"
 
+#include <algorithm>
 #include <cmath>
 
 namespace csp::measurementtools {
@@ -18,6 +19,8 @@ Breakpoint::Breakpoint()
     , mLeftChild(nullptr)
     , mRightChild(nullptr)
     , mParent(nullptr)
+    , mPriority(0)
+    , mEdge(0)
     , mGenerator(nullptr)
     , mSweepline(-1.0) {
 }
@@ -28,6 +31,8 @@ Breakpoint::Breakpoint(Arc* left, Arc* right, VoronoiGenerator* generator)
     , mLeftChild(nullptr)
     , mRightChild(nullptr)
     , mParent(nullptr)
+    , mPriority(0)
+    , mEdge(0)
     , mGenerator(generator)
     , mSweepline(-1.0)
     , mStart(position()) {
@@ -56,30 +61,39 @@ void Breakpoint::updatePosition() const {
   double rX = mRightArc->mSite.mX;
   double rY = mRightArc->mSite.mY;
 
+  // The distances of both sites from the sweep line and their horizontal distance.
+  double dp = mSweepline - pY;
+  double dr = mSweepline - rY;
+  double w  = rX - pX;
+
   if (pY == rY) {
     mPosition.mX = (pX + rX) * 0.5;
-  } else if (rY == mSweepline) {
+  } else if (dr <= 0.0) {
     mPosition.mX = rX;
-  } else if (pY == mSweepline) {
+  } else if (dp <= 0.0) {
     mPosition.mX = pX;
-    pX           = rX;
-    pY           = rY;
   } else {
-    double leftDiff  = 2 * (pY - mSweepline);
-    double rightDiff = 2 * (rY - mSweepline);
-
-    // Use the quadratic formula.
-    double a = 1.0 / leftDiff - 1.0 / rightDiff;
-    double b = -2.0 * (pX / leftDiff - rX / rightDiff);
-    double c = (pX * pX + pY * pY - mSweepline * mSweepline) / leftDiff -
-               (rX * rX + rY * rY - mSweepline * mSweepline) / rightDiff;
-    mPosition.mX = (-b - std::sqrt(b * b - 4.0 * a * c)) / (2.0 * a);
+    // The intersection of both parabolas relative to pX. The textbook quadratic formula cancels
+    // catastrophically when both sites are at almost the same height, which happens all the time
+    // for sites on a grid. Hence the root is written in whichever of its two equivalent forms
+    // adds terms of the same sign.
+    double g = std::sqrt(dp * dr) * std::sqrt(w * w + (pY - rY) * (pY - rY));
+
+    if (w >= 0.0) {
+      mPosition.mX = pX + dp * (w * w + dr * (pY - rY)) / (dp * w + g);
+    } else {
+      mPosition.mX = pX + (g - dp * w) / (pY - rY);
+    }
   }
 
-  // Plug back into one of the parabola equations.
-  if (pY != mSweepline) {
-    mPosition.mY = (pY * pY + (pX - mPosition.mX) * (pX - mPosition.mX) - mSweepline * mSweepline) /
-                   (2.0 * pY - 2.0 * mSweepline);
+  // Plug back into the parabola equation of the site which is farther from the sweep line, as
+  // the other one may be degenerate.
+  double fX = dp >= dr ? pX : rX;
+  double fY = dp >= dr ? pY : rY;
+  double d  = std::max(dp, dr);
+
+  if (d > 0.0) {
+    mPosition.mY = 0.5 * (fY + mSweepline) - (fX - mPosition.mX) * (fX - mPosition.mX) / (2.0 * d);
   } else {
     mPosition.mY = mGenerator->minY();
   }
@@ -9,6 +9,8 @@
 
 #include "Vector2f.hpp"
 
+#include <cstdint>
+
 namespace csp::measurementtools {
 
 struct Arc;
@@ -27,6 +29,12 @@ class Breakpoint {
   Arc *       mLeftArc, *mRightArc;
   Breakpoint *mLeftChild, *mRightChild, *mParent;
 
+  // Heap priority of the node in the BreakpointTree.
+  uint32_t mPriority;
+
+  // Index of the triangulation edge between the two arcs.
+  uint32_t mEdge;
+
  private:
   void updatePosition() const;
 
@@ -13,128 +13,108 @@
 
 namespace csp::measurementtools {
 
-BreakpointTree::BreakpointTree()
-    : mRoot(nullptr) {
-}
+namespace {
+
+// Seed of the xorshift generator for the node priorities. A fixed seed keeps the triangulation
+// deterministic.
+const uint32_t PRIORITY_SEED = 2463534242U;
 
-BreakpointTree::~BreakpointTree() {
-  clear(mRoot);
+} // namespace
+
+BreakpointTree::BreakpointTree()
+    : mRoot(nullptr)
+    , mSeed(PRIORITY_SEED) {
 }
 
 void BreakpointTree::insert(Breakpoint* point) {
+  point->mPriority = nextPriority();
+
   if (empty()) {
     mRoot = point;
-  } else {
-    insert(point, mRoot);
+    return;
   }
-}
 
-void BreakpointTree::remove(Breakpoint* point) {
-  if (point->mParent == nullptr) {
-
-    if (point->mLeftChild && point->mRightChild) {
-      mRoot          = point->mRightChild;
-      mRoot->mParent = nullptr;
-      attachLeftOf(point->mLeftChild, mRoot);
-    } else if (point->mLeftChild) {
-      mRoot          = point->mLeftChild;
-      mRoot->mParent = nullptr;
-    } else if (point->mRightChild) {
-      mRoot          = point->mRightChild;
-      mRoot->mParent = nullptr;
-    } else {
-      mRoot = nullptr;
-    }
-  } else {
+  double      newX   = point->position().mX;
+  Breakpoint* atNode = mRoot;
 
-    const bool isLeftChild(point == point->mParent->mLeftChild);
-
-    if (point->mLeftChild && point->mRightChild) {
-      if (isLeftChild) {
-        point->mParent->mLeftChild = point->mLeftChild;
-        point->mLeftChild->mParent = point->mParent;
-        attachRightOf(point->mRightChild, point->mParent->mLeftChild);
-      } else {
-        point->mParent->mRightChild = point->mRightChild;
-        point->mRightChild->mParent = point->mParent;
-        attachLeftOf(point->mLeftChild, point->mParent->mRightChild);
+  while (true) {
+    double atX = atNode->position().mX;
+    if (newX < atX || (newX == atX && point->mRightArc == atNode->mLeftArc)) {
+      if (!atNode->mLeftChild) {
+        atNode->mLeftChild = point;
+        break;
       }
-    } else if (point->mLeftChild) {
-      if (isLeftChild) {
-        point->mParent->mLeftChild = point->mLeftChild;
-      } else {
-        point->mParent->mRightChild = point->mLeftChild;
-      }
-      point->mLeftChild->mParent = point->mParent;
-    } else if (point->mRightChild) {
-      if (isLeftChild) {
-        point->mParent->mLeftChild = point->mRightChild;
-      } else {
-        point->mParent->mRightChild = point->mRightChild;
-      }
-      point->mRightChild->mParent = point->mParent;
+      atNode = atNode->mLeftChild;
     } else {
-      if (isLeftChild) {
-        point->mParent->mLeftChild = nullptr;
-      } else {
-        point->mParent->mRightChild = nullptr;
+      if (!atNode->mRightChild) {
+        atNode->mRightChild = point;
+        break;
       }
+      atNode = atNode->mRightChild;
     }
   }
-}
 
-Arc* BreakpointTree::getArcAt(double x) const {
+  point->mParent = atNode;
 
-  Breakpoint* nearest = getNearestNode(x, mRoot);
+  while (point->mParent && point->mParent->mPriority < point->mPriority) {
+    rotateUp(point);
+  }
+}
 
-  if (x < nearest->position().mX) {
-    return nearest->mLeftArc;
+void BreakpointTree::remove(Breakpoint* point) {
+  // Rotate the point down until it has at most one child.
+  while (point->mLeftChild && point->mRightChild) {
+    rotateUp(point->mLeftChild->mPriority > point->mRightChild->mPriority ? point->mLeftChild
+                                                                          : point->mRightChild);
   }
 
-  return nearest->mRightArc;
-}
+  Breakpoint* child = point->mLeftChild ? point->mLeftChild : point->mRightChild;
 
-bool BreakpointTree::empty() const {
-  return !mRoot;
-}
+  if (child) {
+    child->mParent = point->mParent;
+  }
 
-void BreakpointTree::insert(Breakpoint* newNode, Breakpoint* atNode) {
-  double newX = newNode->position().mX;
-  double atX  = atNode->position().mX;
-  if (newX < atX || (newX == atX && newNode->mRightArc == atNode->mLeftArc)) {
-    if (atNode->mLeftChild) {
-      insert(newNode, atNode->mLeftChild);
-    } else {
-      atNode->mLeftChild = newNode;
-      newNode->mParent   = atNode;
-    }
+  if (!point->mParent) {
+    mRoot = child;
+  } else if (point == point->mParent->mLeftChild) {
+    point->mParent->mLeftChild = child;
   } else {
-    if (atNode->mRightChild) {
-      insert(newNode, atNode->mRightChild);
-    } else {
-      atNode->mRightChild = newNode;
-      newNode->mParent    = atNode;
-    }
+    point->mParent->mRightChild = child;
   }
+
+  point->mLeftChild  = nullptr;
+  point->mRightChild = nullptr;
+  point->mParent     = nullptr;
 }
 
-Breakpoint* BreakpointTree::getNearestNode(double x, Breakpoint* current) const {
-  if (!current) {
-    return nullptr;
+Arc* BreakpointTree::getArcAt(double x) const {
+  // The arc at x is right of the last breakpoint which is not right of x, or left of the first
+  // breakpoint if there is none. Several breakpoints may be at the same position, for example the
+  // two of an arc whose site is on the sweep line. These are found in the order of the tree, so
+  // that no arc of zero width is returned for an x beside it.
+  Breakpoint* left  = nullptr;
+  Breakpoint* right = nullptr;
+
+  for (Breakpoint* current = mRoot; current;) {
+    if (x < current->position().mX) {
+      right   = current;
+      current = current->mLeftChild;
+    } else {
+      left    = current;
+      current = current->mRightChild;
+    }
   }
 
-  Breakpoint* nearestChild = (x < current->position().mX) ? getNearestNode(x, current->mLeftChild)
-                                                          : getNearestNode(x, current->mRightChild);
-  Breakpoint* nearest = current;
+  return left ? left->mRightArc : right->mLeftArc;
+}
 
-  if (nearestChild &&
-      (std::fabs(x - nearestChild->position().mX) < std::fabs(x - nearest->position().mX))) {
-    {
-      nearest = nearestChild;
-    }
-  }
+bool BreakpointTree::empty() const {
+  return !mRoot;
+}
 
-  return nearest;
+void BreakpointTree::clear() {
+  mRoot = nullptr;
+  mSeed = PRIORITY_SEED;
 }
 
 void BreakpointTree::finishAll(std::vector<Edge>& edges) {
@@ -149,44 +129,40 @@ void BreakpointTree::finishAll(std::vector<Edge>& edges, Breakpoint* atNode) {
   }
 }
 
-void BreakpointTree::clear(Breakpoint* atNode) {
-  if (atNode) {
-    clear(atNode->mLeftChild);
-    clear(atNode->mRightChild);
+void BreakpointTree::rotateUp(Breakpoint* node) {
+  Breakpoint* parent      = node->mParent;
+  Breakpoint* grandParent = parent->mParent;
 
-    if (atNode->mLeftArc) {
-      if (atNode->mLeftArc->mLeftBreak) {
-        atNode->mLeftArc->mLeftBreak->mRightArc = nullptr;
-      }
-      delete atNode->mLeftArc; // NOLINT(cppcoreguidelines-owning-memory): TODO
+  if (node == parent->mLeftChild) {
+    parent->mLeftChild = node->mRightChild;
+    if (node->mRightChild) {
+      node->mRightChild->mParent = parent;
     }
-
-    if (atNode->mRightArc) {
-      if (atNode->mRightArc->mRightBreak) {
-        atNode->mRightArc->mRightBreak->mLeftArc = nullptr;
-      }
-      delete atNode->mRightArc; // NOLINT(cppcoreguidelines-owning-memory): TODO
+    node->mRightChild = parent;
+  } else {
+    parent->mRightChild = node->mLeftChild;
+    if (node->mLeftChild) {
+      node->mLeftChild->mParent = parent;
     }
-
-    delete atNode; // NOLINT(cppcoreguidelines-owning-memory): TODO
+    node->mLeftChild = parent;
   }
-}
 
-void BreakpointTree::attachRightOf(Breakpoint* newNode, Breakpoint* atNode) {
-  if (atNode->mRightChild) {
-    attachRightOf(newNode, atNode->mRightChild);
+  parent->mParent = node;
+  node->mParent   = grandParent;
+
+  if (!grandParent) {
+    mRoot = node;
+  } else if (grandParent->mLeftChild == parent) {
+    grandParent->mLeftChild = node;
   } else {
-    atNode->mRightChild = newNode;
-    newNode->mParent    = atNode;
+    grandParent->mRightChild = node;
   }
 }
 
-void BreakpointTree::attachLeftOf(Breakpoint* newNode, Breakpoint* atNode) {
-  if (atNode->mLeftChild) {
-    attachLeftOf(newNode, atNode->mLeftChild);
-  } else {
-    atNode->mLeftChild = newNode;
-    newNode->mParent   = atNode;
-  }
+uint32_t BreakpointTree::nextPriority() {
+  mSeed ^= mSeed << 13U;
+  mSeed ^= mSeed >> 17U;
+  mSeed ^= mSeed << 5U;
+  return mSeed;
 }
 } // namespace csp::measurementtools
@@ -9,6 +9,7 @@
 
 #include "Vector2f.hpp"
 
+#include <cstdint>
 #include <vector>
 
 namespace csp::measurementtools {
@@ -18,17 +19,21 @@ typedef std::pair<Vector2f, Vector2f> Edge;
 class Breakpoint;
 struct Arc;
 
+/// Stores the breakpoints of the beachline ordered by their x-position. The tree is a treap: each
+/// breakpoint gets a pseudo-random priority on insertion and the tree is kept heap-ordered by
+/// rotations. This keeps the expected depth logarithmic, even if the sites arrive in an order
+/// which would make a plain binary search tree degenerate into a list.
 class BreakpointTree {
  public:
   BreakpointTree();
 
-  BreakpointTree(BreakpointTree const& other) = default;
-  BreakpointTree(BreakpointTree&& other)      = default;
+  BreakpointTree(BreakpointTree const& other) = delete;
+  BreakpointTree(BreakpointTree&& other)      = delete;
 
-  BreakpointTree& operator=(BreakpointTree const& other) = default;
-  BreakpointTree& operator=(BreakpointTree&& other) = default;
+  BreakpointTree& operator=(BreakpointTree const& other) = delete;
+  BreakpointTree& operator=(BreakpointTree&& other) = delete;
 
-  ~BreakpointTree();
+  ~BreakpointTree() = default;
 
   void insert(Breakpoint* point);
   void remove(Breakpoint* point);
@@ -38,16 +43,18 @@ class BreakpointTree {
 
   bool empty() const;
 
+  /// Removes all breakpoints from the tree. The breakpoints are owned by the Beachline's pool.
+  void clear();
+
  private:
-  void        insert(Breakpoint* newNode, Breakpoint* atNode);
-  Breakpoint* getNearestNode(double x, Breakpoint* current) const;
-  void        finishAll(std::vector<Edge>& edges, Breakpoint* atNode);
-  void        clear(Breakpoint* atNode);
+  void finishAll(std::vector<Edge>& edges, Breakpoint* atNode);
 
-  void attachRightOf(Breakpoint* newNode, Breakpoint* atNode);
-  void attachLeftOf(Breakpoint* newNode, Breakpoint* atNode);
+  // Rotates the given node above its parent.
+  void     rotateUp(Breakpoint* node);
+  uint32_t nextPriority();
 
   Breakpoint* mRoot;
+  uint32_t    mSeed;
 };
 } // namespace csp::measurementtools
 #endif // CSP_MEASUREMENT_TOOLS_BREAKPOINTTREE_HPP
@@ -13,6 +13,16 @@
 
 namespace csp::measurementtools {
 
+namespace {
+
+// The priority of an event which is recomputed after the beachline changed may differ in the last
+// bits from the sweep line that reached it. Events which lie less than this fraction of the
+// circle's extent behind the sweep line are therefore still valid; this happens whenever more
+// than three sites are cocircular, e.g. for every cell of a grid.
+const double PRIORITY_TOLERANCE = 1e-12;
+
+} // namespace
+
 Circle::Circle(Arc* a, double sweepLine)
     : mSite(a->mSite)
     , mArc(a)
@@ -52,10 +62,10 @@ Circle::Circle(Arc* a, double sweepLine)
   mCenter.mX = (D * E - B * F) / G;
   mCenter.mY = (A * F - C * E) / G;
 
-  mPriority =
-      Vector2f(mCenter.mX, mCenter.mY + (mCenter - Vector2f(site1->mX, site1->mY)).length());
+  double radius = (mCenter - Vector2f(site1->mX, site1->mY)).length();
+  mPriority     = Vector2f(mCenter.mX, mCenter.mY + radius);
 
-  if (mPriority.mY < sweepLine) {
+  if (mPriority.mY < sweepLine - PRIORITY_TOLERANCE * (std::fabs(mCenter.mY) + radius)) {
     mIsValid = false;
     return;
   }
@@ -0,0 +1,88 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//                               This file is part of CosmoScout VR                               //
+//      and may be used under the terms of the MIT license. See the LICENSE file for details.     //
+//                        Copyright: (c) 2019 German Aerospace Center (DLR)                       //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef CSP_MEASUREMENT_TOOLS_OBJECT_POOL_HPP
+#define CSP_MEASUREMENT_TOOLS_OBJECT_POOL_HPP
+
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace csp::measurementtools {
+
+/// Allocates objects of one type in chunks. Objects cannot be freed individually; instead all of
+/// them are destroyed at once with clear(). The memory is kept for subsequent allocations, so a
+/// pool which is cleared after each use does not allocate at all once it has grown large enough.
+template <typename T>
+class ObjectPool {
+ public:
+  explicit ObjectPool(size_t chunkSize = 256)
+      : mChunkSize(chunkSize) {
+  }
+
+  ObjectPool(ObjectPool const& other) = delete;
+  ObjectPool(ObjectPool&& other)      = delete;
+
+  ObjectPool& operator=(ObjectPool const& other) = delete;
+  ObjectPool& operator=(ObjectPool&& other) = delete;
+
+  ~ObjectPool() {
+    clear();
+  }
+
+  /// Constructs a new object with the given arguments. The pointer remains valid until clear()
+  /// is called or the pool is destroyed.
+  template <typename... Args>
+  T* create(Args&&... args) {
+    size_t chunk = mSize / mChunkSize;
+
+    if (chunk == mChunks.size()) {
+      mChunks.push_back(std::make_unique<Storage[]>(mChunkSize));
+    }
+
+    T* object = new (&mChunks[chunk][mSize % mChunkSize]) T(std::forward<Args>(args)...);
+    ++mSize;
+    return object;
+  }
+
+  /// Destroys the most recently created object. This can be used to return objects which turned
+  /// out to be unnecessary right after their creation.
+  void destroyLast() {
+    if (mSize > 0) {
+      --mSize;
+      get(mSize)->~T();
+    }
+  }
+
+  /// Destroys all objects.
+  void clear() {
+    while (mSize > 0) {
+      destroyLast();
+    }
+  }
+
+  size_t size() const {
+    return mSize;
+  }
+
+ private:
+  struct Storage {
+    alignas(T) unsigned char mData[sizeof(T)];
+  };
+
+  T* get(size_t index) {
+    return std::launder(reinterpret_cast<T*>(&mChunks[index / mChunkSize][index % mChunkSize]));
+  }
+
+  std::vector<std::unique_ptr<Storage[]>> mChunks;
+  size_t                                  mChunkSize;
+  size_t                                  mSize = 0;
+};
+
+} // namespace csp::measurementtools
+
+#endif // CSP_MEASUREMENT_TOOLS_OBJECT_POOL_HPP
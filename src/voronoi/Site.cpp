@@ -9,12 +9,53 @@
 
 namespace csp::measurementtools {
 
-Site::Site(double x_in, double y_in, uint16_t a)
+Site::Site(double x_in, double y_in, uint32_t a)
     : mX(x_in)
     , mY(y_in)
     , mAddr(a) {
 }
 
+SiteArray::SiteArray(std::vector<Site> const& sites) {
+  reserve(sites.size());
+  for (auto const& site : sites) {
+    push_back(site);
+  }
+}
+
+size_t SiteArray::size() const {
+  return mAddr.size();
+}
+
+bool SiteArray::empty() const {
+  return mAddr.empty();
+}
+
+void SiteArray::clear() {
+  mX.clear();
+  mY.clear();
+  mAddr.clear();
+}
+
+void SiteArray::reserve(size_t size) {
+  mX.reserve(size);
+  mY.reserve(size);
+  mAddr.reserve(size);
+}
+
+void SiteArray::emplace_back(double x, double y, uint32_t a) {
+  mX.push_back(x);
+  mY.push_back(y);
+  mAddr.push_back(a);
+}
+
+void SiteArray::push_back(Site const& site) {
+  emplace_back(site.mX, site.mY, site.mAddr);
+}
+
+Site SiteArray::operator[](size_t index) const {
+  return Site(mX[index], mY[index], mAddr[index]);
+}
+
 bool operator<(Site const& lhs, Site const& rhs) {
   return lhs.mAddr < rhs.mAddr;
 }
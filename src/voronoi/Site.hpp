@@ -7,16 +7,39 @@
 #ifndef CSP_MEASUREMENT_TOOLS_SITE_HPP
 #define CSP_MEASUREMENT_TOOLS_SITE_HPP
 
+#include <cstddef>
 #include <cstdint>
+#include <vector>
+
 namespace csp::measurementtools {
 
 struct Site {
-  Site(double x, double y, uint16_t a = 0);
+  Site(double x, double y, uint32_t a = 0);
 
   double mX;
   double mY;
 
-  uint16_t mAddr;
+  uint32_t mAddr;
+};
+
+/// Stores sites as structure of arrays, so that loops over the coordinates can be vectorized.
+struct SiteArray {
+  SiteArray() = default;
+  explicit SiteArray(std::vector<Site> const& sites);
+
+  size_t size() const;
+  bool   empty() const;
+  void   clear();
+  void   reserve(size_t size);
+
+  void emplace_back(double x, double y, uint32_t a);
+  void push_back(Site const& site);
+
+  Site operator[](size_t index) const;
+
+  std::vector<double>   mX;
+  std::vector<double>   mY;
+  std::vector<uint32_t> mAddr;
 };
 
 bool operator<(Site const& lhs, Site const& rhs);
@@ -5,15 +5,65 @@
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 #include "VoronoiGenerator.hpp"
-#include "../logger.hpp"
 #include "Arc.hpp"
 
+#include <algorithm>
+#include <deque>
 #include <glm/glm.hpp>
 #include <iomanip>
 #include <limits>
 
 namespace csp::measurementtools {
 
+namespace {
+
+// Twice the signed area of the triangle (a, b, c); positive if counter-clockwise.
+double orientation(glm::dvec2 const& a, glm::dvec2 const& b, glm::dvec2 const& c) {
+  return (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+}
+
+// Positive if d lies inside the circumcircle of the counter-clockwise triangle (a, b, c).
+double inCircle(
+    glm::dvec2 const& a, glm::dvec2 const& b, glm::dvec2 const& c, glm::dvec2 const& d) {
+  glm::dvec2 ad = a - d;
+  glm::dvec2 bd = b - d;
+  glm::dvec2 cd = c - d;
+
+  double a2 = ad.x * ad.x + ad.y * ad.y;
+  double b2 = bd.x * bd.x + bd.y * bd.y;
+  double c2 = cd.x * cd.x + cd.y * cd.y;
+
+  return ad.x * (bd.y * c2 - b2 * cd.y) - ad.y * (bd.x * c2 - b2 * cd.x) +
+         a2 * (bd.x * cd.y - bd.y * cd.x);
+}
+
+// Points closer to an edge than this fraction of the edge's length are considered to be on it.
+const double EDGE_TOLERANCE = 1e-10;
+
+glm::dvec2 position(Site const& site) {
+  return glm::dvec2(site.mX, site.mY);
+}
+
+glm::dvec2 position(SiteArray const& sites, uint32_t index) {
+  return glm::dvec2(sites.mX[index], sites.mY[index]);
+}
+
+// True if the segments (a, b) and (c, d) cross each other in a single point which is not one of
+// their end points.
+bool crosses(glm::dvec2 const& a, glm::dvec2 const& b, glm::dvec2 const& c, glm::dvec2 const& d) {
+  return orientation(a, b, c) * orientation(a, b, d) < 0 &&
+         orientation(c, d, a) * orientation(c, d, b) < 0;
+}
+
+uint64_t edgeKey(uint32_t site1, uint32_t site2) {
+  if (site1 > site2) {
+    std::swap(site1, site2);
+  }
+  return (static_cast<uint64_t>(site1) << 32U) | site2;
+}
+
+} // namespace
+
 VoronoiGenerator::VoronoiGenerator()
     : mBeachline(this)
     , mSweepline(0.0)
@@ -22,25 +72,41 @@ VoronoiGenerator::VoronoiGenerator()
 }
 
 void VoronoiGenerator::parse(std::vector<Site> const& sites) {
+  parse(SiteArray(sites));
+}
+
+void VoronoiGenerator::parse(SiteArray const& sites) {
+  Statistics::ScopedTimer timer(mStatistics, Statistics::Stage::eVoronoi);
+
   mSites     = sites;
-  mBeachline = Beachline(this);
   mSweepline = 0.0;
   mMaxY      = 0.0;
   mMinY      = 0.0;
   mVoronoiEdges.clear();
   mTriangulationEdges.clear();
-  mTriangles.clear();
-  mNeighbors.clear();
+  mSiteIndices.clear();
+  mTriangleVertices.clear();
+  mTriangleNeighbors.clear();
+  mVertexTriangles.assign(sites.size(), -1);
+  mPendingEdges.clear();
+  mConstraints.clear();
+  mLastTriangle      = 0;
+  mIndexed           = false;
+  mEdgesOutdated     = false;
+
+  for (uint32_t i = 0; i < mSites.size(); ++i) {
+    mSiteIndices.emplace(mSites.mAddr[i], i);
+  }
 
   if (sites.size() > 1) {
-    for (auto site : sites) {
-      if (site.mY > mMaxY) {
-        mMaxY = site.mY;
+    for (size_t i = 0; i < mSites.size(); ++i) {
+      if (mSites.mY[i] > mMaxY) {
+        mMaxY = mSites.mY[i];
       }
-      if (site.mY < mMinY) {
-        mMinY = site.mY;
+      if (mSites.mY[i] < mMinY) {
+        mMinY = mSites.mY[i];
       }
-      mSiteEvents.push(site);
+      mSiteEvents.push(mSites[i]);
     }
 
     while (!mCircleEvents.empty() || !mSiteEvents.empty()) {
@@ -54,7 +120,7 @@ void VoronoiGenerator::parse(std::vector<Site> const& sites) {
         mCircleEvents.pop();
         mSweepline = next->mPriority.mY;
         process(next);
-        delete next; // NOLINT(cppcoreguidelines-owning-memory): TODO
+        mStatistics.add(Statistics::Counter::eCircleEvents, 1);
       } else {
         Site next = mSiteEvents.top();
         mSiteEvents.pop();
@@ -71,6 +137,16 @@ void VoronoiGenerator::parse(std::vector<Site> const& sites) {
     }
 
     finishEdges();
+
+    mStatistics.add(Statistics::Counter::eSites, mSites.size());
+    mStatistics.add(Statistics::Counter::eEdges, mVoronoiEdges.size());
+
+    // All arcs, breakpoints and circle events of this parse are released at once.
+    mBeachline.clear();
+    mCircles.clear();
+    mPendingEdges.clear();
+
+    mIndexed = !mTriangleVertices.empty();
   }
 }
 
@@ -86,7 +162,7 @@ double VoronoiGenerator::minY() const {
   return mMinY;
 }
 
-std::vector<Site> const& VoronoiGenerator::getSites() const {
+SiteArray const& VoronoiGenerator::getSites() const {
   return mSites;
 }
 
@@ -95,147 +171,93 @@ std::vector<Edge> const& VoronoiGenerator::getEdges() const {
 }
 
 std::vector<Edge2> const& VoronoiGenerator::getTriangulation() const {
+  updateOutput();
   return mTriangulationEdges;
 }
 
 std::vector<Triangle> const& VoronoiGenerator::getTriangles() const {
-  return mTriangles;
+  return mTriangleVertices;
 }
 
-std::map<uint16_t, std::vector<Site>> const& VoronoiGenerator::getNeighbors() const {
-  return mNeighbors;
-}
+std::vector<Site> VoronoiGenerator::getNeighbors(Site const& site) const {
+  std::vector<Site> neighbors;
+  uint32_t          index{};
 
-void VoronoiGenerator::addTriangulationEdge(Site const& site1, Site const& site2) {
-  mTriangulationEdges.emplace_back(site1, site2);
+  if (!findSite(site, index)) {
+    return neighbors;
+  }
 
-  // site, place of site in mTriangles
-  std::vector<std::pair<Site, int>> tri;
-  int                               element = 0;
-
-  // checks if triangle with site1 and site2 corners exist in mTriangles
-  // if yes, saves the location in mTriangles and it's third corner
-  for (auto const& t : mTriangles) {
-    Site si1(0, 0, 0);
-    Site si2(0, 0, 0);
-    Site si3(0, 0, 0);
-    std::tie(si1, si2, si3) = t;
-
-    if (((site1.mAddr == si1.mAddr) || (site1.mAddr == si2.mAddr) || (site1.mAddr == si3.mAddr)) &&
-        ((site2.mAddr == si1.mAddr) || (site2.mAddr == si2.mAddr) || (site2.mAddr == si3.mAddr))) {
-      if ((si1.mAddr != site1.mAddr) && (si1.mAddr != site2.mAddr)) {
-        tri.emplace_back(si1, element);
-      } else if ((si2.mAddr != site1.mAddr) && (si2.mAddr != site2.mAddr)) {
-        tri.emplace_back(si2, element);
-      } else {
-        tri.emplace_back(si3, element);
+  std::vector<int32_t> triangles;
+  getTrianglesAround(index, triangles);
+
+  for (int32_t t : triangles) {
+    auto const& v = mTriangleVertices[t];
+    int32_t     k = v[0] == index ? 0 : (v[1] == index ? 1 : 2);
+
+    for (uint32_t n : {v[(k + 1) % 3], v[(k + 2) % 3]}) {
+      if (std::none_of(neighbors.begin(), neighbors.end(),
+              [&](Site const& s) { return s.mAddr == mSites.mAddr[n]; })) {
+        neighbors.push_back(mSites[n]);
       }
     }
-    element++;
   }
 
-  // if sites have a common neighbor, the three form a triangle
-  for (auto const& s1 : mNeighbors[site1.mAddr]) {
-    for (auto const& s2 : mNeighbors[site2.mAddr]) {
-      // common neighbor found
-      if (s1.mAddr == s2.mAddr) {
-        // emplace back triangle to vectors
-        if (tri.empty()) {
-          mTriangles.emplace_back(std::make_tuple(site1, site2, s1));
-          tri.emplace_back(s1, static_cast<uint16_t>(mTriangles.size() - 1));
-        }
-        // if there are already triangles between site1 and site2
-        else {
-          // variables to remove elements from tri
-          std::vector<int> remove;
-          int              elementTri = 0;
-
-          // examines every triangle
-          for (auto const& p : tri) {
-            // edges
-            glm::dvec2 edge1 = glm::dvec2(site2.mX, site2.mY) - glm::dvec2(site1.mX, site1.mY);
-            glm::dvec2 edge2 = glm::dvec2(s1.mX, s1.mY) - glm::dvec2(site1.mX, site1.mY);
-            glm::dvec2 edge3 = glm::dvec2(p.first.mX, p.first.mY) - glm::dvec2(site1.mX, site1.mY);
-
-            // cross products of edges to find out the order (clockwise, counterclockwise)
-            double cross1 = edge1.x * edge2.y - edge1.y * edge2.x;
-            double cross2 = edge1.x * edge3.y - edge1.y * edge3.x;
-            double cross3 = edge2.x * edge3.y - edge2.y * edge3.x;
-
-            // s1 and p.first are on the same side of edge1 (site1, site2)
-            // they are overlapping each other -> one of them are unnecessary
-            if ((cross1 > 0) == (cross2 > 0)) {
-              // p_first is the outer site -> needs to be eliminated
-              if ((cross1 > 0) == (cross3 > 0)) {
-                // deletes unnecessary triangle from mTriangles and add new
-                try {
-                  mTriangles.at(p.second) = std::make_tuple(site1, site2, s1);
-                  tri.emplace_back(s1, p.second);
-                  remove.emplace_back(elementTri);
-                } catch (std::exception const& e) {
-                  logger().error("Triangle elimination in VoronoiGenerator: {}", e.what());
-                }
-              }
-              // else: does not add unnecessary triangle
-            }
-            elementTri++;
-          }
-
-          // removes outdated elements from tri
-          for (size_t i = remove.size(); i > 0; i--) {
-            tri.erase(tri.begin() + i - 1);
-          }
-        }
-      }
-    }
+  return neighbors;
+}
+
+bool VoronoiGenerator::hasEdge(Site const& site1, Site const& site2) const {
+  // Without triangles (e.g. for co-linear sites) there are only the edges of the sweep.
+  if (!mIndexed) {
+    return std::any_of(mTriangulationEdges.begin(), mTriangulationEdges.end(), [&](auto const& e) {
+      return (e.first.mAddr == site1.mAddr && e.second.mAddr == site2.mAddr) ||
+             (e.first.mAddr == site2.mAddr && e.second.mAddr == site1.mAddr);
+    });
   }
 
-  mNeighbors[site1.mAddr].push_back(site2);
-  mNeighbors[site2.mAddr].push_back(site1);
+  uint32_t index1{};
+  uint32_t index2{};
+  int32_t  triangle{};
+  int32_t  edge{};
+
+  return findSite(site1, index1) && findSite(site2, index2) &&
+         findEdge(index1, index2, triangle, edge);
 }
 
-void VoronoiGenerator::removeTriangulationEdge(Site const& site1, Site const& site2) {
-  // removes edge
-  int i = 0;
-  for (auto const& s : mTriangulationEdges) {
-    if (((s.first == site1) && (s.second == site2)) ||
-        ((s.first == site2) && (s.second == site1))) {
-      mTriangulationEdges.erase(mTriangulationEdges.begin() + i);
-    }
+uint32_t VoronoiGenerator::addTriangulationEdge(Site const& site1, Site const& site2) {
+  mTriangulationEdges.emplace_back(site1, site2);
+  mPendingEdges.emplace_back(-1, -1);
 
-    i++;
-  }
+  return static_cast<uint32_t>(mTriangulationEdges.size() - 1);
+}
 
-  // removes triangles
-  i = 0;
-  for (auto const& t : mTriangles) {
-    Site s1(0, 0, 0);
-    Site s2(0, 0, 0);
-    Site s3(0, 0, 0);
-    std::tie(s1, s2, s3) = t;
-    if (((s1 == site1 || s2 == site1) && s3 == site2) ||
-        ((s1 == site1 || s3 == site1) && s2 == site2) ||
-        ((s2 == site1 || s3 == site1) && s1 == site2)) {
-      mTriangles.erase(mTriangles.begin() + i);
-    }
-    i++;
+void VoronoiGenerator::removeTriangulationEdge(Site const& site1, Site const& site2) {
+  if (!mIndexed) {
+    mTriangulationEdges.erase(std::remove_if(mTriangulationEdges.begin(),
+                                  mTriangulationEdges.end(),
+                                  [&](auto const& e) {
+                                    return (e.first == site1 && e.second == site2) ||
+                                           (e.first == site2 && e.second == site1);
+                                  }),
+        mTriangulationEdges.end());
+    return;
   }
 
-  // removes neigbours
-  i = 0;
-  for (auto const& s : mNeighbors[site1.mAddr]) {
-    if (s == site2) {
-      mNeighbors[site1.mAddr].erase(mNeighbors[site1.mAddr].begin() + i);
-    }
-    i++;
+  uint32_t index1{};
+  uint32_t index2{};
+  int32_t  triangle{};
+  int32_t  edge{};
+
+  if (!findSite(site1, index1) || !findSite(site2, index2)) {
+    return;
   }
-  i = 0;
-  for (auto const& s : mNeighbors[site2.mAddr]) {
-    if (s == site1) {
-      mNeighbors[site2.mAddr].erase(mNeighbors[site2.mAddr].begin() + i);
-    }
-    i++;
+
+  // This removes the triangles on both sides of the edge.
+  while (findEdge(index1, index2, triangle, edge)) {
+    removeTriangle(triangle);
   }
+
+  mIndexed       = !mTriangleVertices.empty();
+  mEdgesOutdated = true;
 }
 
 void VoronoiGenerator::process(Circle* event) {
@@ -252,8 +274,19 @@ void VoronoiGenerator::process(Circle* event) {
       mVoronoiEdges.push_back(event->mArc->mRightBreak->finishEdge(event->mCenter));
     }
 
+    uint32_t leftEdge  = leftArc ? event->mArc->mLeftBreak->mEdge : 0;
+    uint32_t rightEdge = rightArc ? event->mArc->mRightBreak->mEdge : 0;
+
     mBeachline.removeArc(event->mArc);
 
+    // Each Voronoi vertex is the circumcenter of a Delaunay triangle. The three arcs' sites are
+    // its corners, the new breakpoint between the left and the right arc traces its third edge.
+    if (leftArc && rightArc) {
+      addTriangle({mSiteIndices[leftArc->mSite.mAddr], mSiteIndices[event->mArc->mSite.mAddr],
+                      mSiteIndices[rightArc->mSite.mAddr]},
+          {rightEdge, leftArc->mRightBreak->mEdge, leftEdge});
+    }
+
     addCircleEvent(leftArc);
     addCircleEvent(rightArc);
   }
@@ -269,12 +302,12 @@ void VoronoiGenerator::process(Site const& event) {
 
 void VoronoiGenerator::addCircleEvent(Arc* arc) {
   if (arc) {
-    // NOLINTNEXTLINE(cppcoreguidelines-owning-memory): TODO
-    auto* circle = new Circle(arc, sweepLine());
+    Circle* circle = mCircles.create(arc, sweepLine());
     if (circle->mIsValid) {
       mCircleEvents.push(circle);
     } else {
-      delete circle; // NOLINT(cppcoreguidelines-owning-memory): TODO
+      // Invalid circles are not referenced by their arc, so the slot can be reused right away.
+      mCircles.destroyLast();
     }
   }
 }
@@ -283,4 +316,721 @@ void VoronoiGenerator::finishEdges() {
   mSweepline = 2 * mMaxY;
   mBeachline.finish(mVoronoiEdges);
 }
+
+void VoronoiGenerator::insert(Site const& site) {
+  mSites.push_back(site);
+  mSiteIndices.emplace(site.mAddr, static_cast<uint32_t>(mSites.size() - 1));
+  mVertexTriangles.push_back(-1);
+
+  if (!mIndexed) {
+    // There is no valid triangulation yet (e.g. all sites were co-linear), so start from scratch.
+    SiteArray sites(mSites);
+    parse(sites);
+    return;
+  }
+
+  int32_t triangle{};
+  int32_t edge{};
+
+  if (!locate(position(site), triangle, edge)) {
+    SiteArray sites(mSites);
+    parse(sites);
+    return;
+  }
+
+  uint32_t index = static_cast<uint32_t>(mSites.size() - 1);
+
+  // Sites which coincide with an existing vertex are skipped, like in parse().
+  if (edge == -2) {
+    return;
+  }
+
+  if (edge == -1) {
+    splitTriangle(triangle, index);
+  } else {
+    splitEdge(triangle, edge, index);
+  }
+
+  mEdgesOutdated = true;
+}
+
+void VoronoiGenerator::addTriangle(Triangle vertices, std::array<uint32_t, 3> edges) {
+  double area = orientation(
+      position(mSites[vertices[0]]), position(mSites[vertices[1]]), position(mSites[vertices[2]]));
+  if (area == 0) {
+    return;
+  }
+  if (area < 0) {
+    std::swap(vertices[1], vertices[2]);
+    std::swap(edges[1], edges[2]);
+  }
+
+  auto current = static_cast<int32_t>(mTriangleVertices.size());
+  mTriangleVertices.push_back(vertices);
+  mTriangleNeighbors.push_back({-1, -1, -1});
+  updateVertexTriangles(current);
+
+  for (int32_t k = 0; k < 3; ++k) {
+    auto& pending = mPendingEdges[edges[k]];
+    if (pending.first < 0) {
+      pending = {current, k};
+    } else {
+      mTriangleNeighbors[current][k]                    = pending.first;
+      mTriangleNeighbors[pending.first][pending.second] = current;
+    }
+  }
+}
+
+void VoronoiGenerator::removeTriangle(int32_t triangle) {
+  auto vertices  = mTriangleVertices[triangle];
+  auto neighbors = mTriangleNeighbors[triangle];
+
+  for (int32_t n : neighbors) {
+    replaceNeighbor(n, triangle, -1);
+  }
+
+  // The neighbors next to a vertex share it.
+  for (int32_t k = 0; k < 3; ++k) {
+    if (mVertexTriangles[vertices[k]] == triangle) {
+      int32_t next = neighbors[(k + 1) % 3] >= 0 ? neighbors[(k + 1) % 3] : neighbors[(k + 2) % 3];
+      mVertexTriangles[vertices[k]] = next;
+    }
+  }
+
+  // The last triangle is moved into the gap.
+  auto last = static_cast<int32_t>(mTriangleVertices.size() - 1);
+  if (triangle != last) {
+    mTriangleVertices[triangle]  = mTriangleVertices[last];
+    mTriangleNeighbors[triangle] = mTriangleNeighbors[last];
+
+    for (int32_t n : mTriangleNeighbors[triangle]) {
+      replaceNeighbor(n, last, triangle);
+    }
+
+    updateVertexTriangles(triangle);
+  }
+
+  mTriangleVertices.pop_back();
+  mTriangleNeighbors.pop_back();
+}
+
+void VoronoiGenerator::updateVertexTriangles(int32_t triangle) {
+  for (uint32_t v : mTriangleVertices[triangle]) {
+    mVertexTriangles[v] = triangle;
+  }
+}
+
+void VoronoiGenerator::getTrianglesAround(uint32_t vertex, std::vector<int32_t>& triangles) const {
+  int32_t start = mVertexTriangles[vertex];
+  if (start < 0) {
+    return;
+  }
+
+  auto indexOf = [this, vertex](int32_t t) {
+    auto const& v = mTriangleVertices[t];
+    return v[0] == vertex ? 0 : (v[1] == vertex ? 1 : 2);
+  };
+
+  // Walks around the vertex in one direction. If a boundary is hit, the remaining triangles are
+  // on the other side of the start triangle.
+  int32_t current = start;
+  do {
+    triangles.push_back(current);
+    current = mTriangleNeighbors[current][(indexOf(current) + 2) % 3];
+  } while (current >= 0 && current != start && triangles.size() <= mTriangleVertices.size());
+
+  if (current < 0) {
+    current = mTriangleNeighbors[start][(indexOf(start) + 1) % 3];
+    while (current >= 0 && triangles.size() <= mTriangleVertices.size()) {
+      triangles.push_back(current);
+      current = mTriangleNeighbors[current][(indexOf(current) + 1) % 3];
+    }
+  }
+}
+
+bool VoronoiGenerator::findEdge(
+    uint32_t site1, uint32_t site2, int32_t& triangle, int32_t& edge) const {
+  std::vector<int32_t> triangles;
+  getTrianglesAround(site1, triangles);
+
+  for (int32_t t : triangles) {
+    auto const& v = mTriangleVertices[t];
+    for (int32_t k = 0; k < 3; ++k) {
+      if (v[k] == site2) {
+        triangle = t;
+        // The edge is opposite to the third vertex.
+        edge = 3 - k - (v[0] == site1 ? 0 : (v[1] == site1 ? 1 : 2));
+        return true;
+      }
+    }
+  }
+
+  return false;
+}
+
+bool VoronoiGenerator::findSite(Site const& site, uint32_t& index) const {
+  auto it = mSiteIndices.find(site.mAddr);
+  if (it == mSiteIndices.end()) {
+    return false;
+  }
+
+  index = it->second;
+  return true;
+}
+
+bool VoronoiGenerator::locate(glm::dvec2 const& point, int32_t& triangle, int32_t& edge) const {
+  // Result for a given triangle: -1 if the point is inside, the index of the edge if it is on an
+  // edge, -2 if it is on a vertex and -3 if it is outside.
+  auto classify = [this, &point](int32_t t, int32_t& exitEdge) {
+    auto const& v       = mTriangleVertices[t];
+    int32_t     result  = -1;
+    int32_t     onEdges = 0;
+    exitEdge            = -1;
+
+    for (int32_t k = 0; k < 3; ++k) {
+      glm::dvec2 a = position(mSites[v[(k + 1) % 3]]);
+      glm::dvec2 b = position(mSites[v[(k + 2) % 3]]);
+
+      double area      = orientation(a, b, point);
+      double tolerance = EDGE_TOLERANCE * glm::dot(b - a, b - a);
+
+      if (area < -tolerance) {
+        exitEdge = k;
+        return -3;
+      }
+
+      if (area <= tolerance) {
+        result = k;
+        ++onEdges;
+      }
+    }
+
+    return onEdges > 1 ? -2 : result;
+  };
+
+  // Walks through the mesh towards the point, starting at the last modified triangle. As new
+  // sites are usually close to each other, this only visits a few triangles.
+  int32_t current = std::min(mLastTriangle, static_cast<int32_t>(mTriangleVertices.size()) - 1);
+
+  for (size_t step = 0; step < mTriangleVertices.size(); ++step) {
+    int32_t exitEdge{};
+    int32_t result = classify(current, exitEdge);
+
+    if (result != -3) {
+      triangle = current;
+      edge     = result;
+      return true;
+    }
+
+    int32_t next = mTriangleNeighbors[current][exitEdge];
+    if (next < 0) {
+      break;
+    }
+    current = next;
+  }
+
+  // The walk may fail for badly shaped meshes, fall back to checking every triangle.
+  for (int32_t t = 0; t < static_cast<int32_t>(mTriangleVertices.size()); ++t) {
+    int32_t exitEdge{};
+    int32_t result = classify(t, exitEdge);
+
+    if (result != -3) {
+      triangle = t;
+      edge     = result;
+      return true;
+    }
+  }
+
+  return false;
+}
+
+void VoronoiGenerator::splitTriangle(int32_t triangle, uint32_t site) {
+  auto [a, b, c]    = mTriangleVertices[triangle];
+  auto [nA, nB, nC] = mTriangleNeighbors[triangle];
+
+  auto t0 = triangle;
+  auto t1 = static_cast<int32_t>(mTriangleVertices.size());
+  auto t2 = t1 + 1;
+
+  mTriangleVertices[t0] = {site, b, c};
+  mTriangleVertices.push_back({site, c, a});
+  mTriangleVertices.push_back({site, a, b});
+
+  mTriangleNeighbors[t0] = {nA, t1, t2};
+  mTriangleNeighbors.push_back({nB, t2, t0});
+  mTriangleNeighbors.push_back({nC, t0, t1});
+
+  replaceNeighbor(nB, triangle, t1);
+  replaceNeighbor(nC, triangle, t2);
+
+  updateVertexTriangles(t0);
+  updateVertexTriangles(t1);
+  updateVertexTriangles(t2);
+
+  legalize(t0, 0);
+  legalize(t1, 0);
+  legalize(t2, 0);
+
+  mLastTriangle = t0;
+}
+
+void VoronoiGenerator::splitEdge(int32_t triangle, int32_t edge, uint32_t site) {
+  // Rotates the triangle so that the split edge is opposite to its first vertex.
+  auto const& v = mTriangleVertices[triangle];
+  auto const& n = mTriangleNeighbors[triangle];
+
+  uint32_t a  = v[edge];
+  uint32_t b  = v[(edge + 1) % 3];
+  uint32_t c  = v[(edge + 2) % 3];
+  int32_t  nA = n[edge];
+  int32_t  nB = n[(edge + 1) % 3];
+  int32_t  nC = n[(edge + 2) % 3];
+
+  // Both halves of a constrained edge are constrained as well.
+  if (isConstrained(b, c)) {
+    mConstraints.erase(edgeKey(b, c));
+    mConstraints.insert(edgeKey(b, site));
+    mConstraints.insert(edgeKey(site, c));
+  }
+
+  auto t0 = triangle;
+  auto t1 = static_cast<int32_t>(mTriangleVertices.size());
+
+  // The triangle on the other side of the edge (d, c, b) is split as well, if there is one.
+  int32_t u  = nA;
+  int32_t u0 = -1;
+  int32_t u1 = -1;
+
+  mTriangleVertices[t0] = {a, b, site};
+  mTriangleVertices.push_back({a, site, c});
+
+  mTriangleNeighbors[t0] = {-1, t1, nC};
+  mTriangleNeighbors.push_back({-1, nB, t0});
+
+  replaceNeighbor(nB, triangle, t1);
+
+  if (u >= 0) {
+    auto const& uv = mTriangleVertices[u];
+    auto const& un = mTriangleNeighbors[u];
+
+    int32_t j = 0;
+    while (un[j] != triangle) {
+      ++j;
+    }
+
+    uint32_t d  = uv[j];
+    int32_t  nD = un[(j + 1) % 3]; // opposite of c, edge (b, d)
+    int32_t  nE = un[(j + 2) % 3]; // opposite of b, edge (d, c)
+
+    u0 = u;
+    u1 = static_cast<int32_t>(mTriangleVertices.size());
+
+    mTriangleVertices[u0] = {d, c, site};
+    mTriangleVertices.push_back({d, site, b});
+
+    mTriangleNeighbors[u0] = {t1, u1, nE};
+    mTriangleNeighbors.push_back({t0, nD, u0});
+
+    replaceNeighbor(nD, u, u1);
+
+    mTriangleNeighbors[t0][0] = u1;
+    mTriangleNeighbors[t1][0] = u0;
+
+    updateVertexTriangles(u0);
+    updateVertexTriangles(u1);
+  }
+
+  updateVertexTriangles(t0);
+  updateVertexTriangles(t1);
+
+  // The split triangles have the new site as vertex 2 (t0), 1 (t1), 2 (u0) and 1 (u1). The
+  // edges opposite to the new site may have become illegal.
+  legalize(t0, 2);
+  legalize(t1, 1);
+  if (u >= 0) {
+    legalize(u0, 2);
+    legalize(u1, 1);
+  }
+
+  mLastTriangle = t0;
+}
+
+void VoronoiGenerator::legalize(int32_t triangle, int32_t edge) {
+  std::vector<std::pair<int32_t, int32_t>> stack{{triangle, edge}};
+
+  while (!stack.empty()) {
+    auto [t, k] = stack.back();
+    stack.pop_back();
+
+    int32_t u = mTriangleNeighbors[t][k];
+    if (u < 0) {
+      continue;
+    }
+
+    // t = (p, b, c) with the new site p at index k, u = (d, c, b).
+    uint32_t p = mTriangleVertices[t][k];
+    uint32_t b = mTriangleVertices[t][(k + 1) % 3];
+    uint32_t c = mTriangleVertices[t][(k + 2) % 3];
+
+    int32_t j = 0;
+    while (mTriangleNeighbors[u][j] != t) {
+      ++j;
+    }
+
+    uint32_t d = mTriangleVertices[u][j];
+
+    if (isConstrained(b, c) || inCircle(position(mSites, p), position(mSites, b),
+                                   position(mSites, c), position(mSites, d)) <= 0) {
+      continue;
+    }
+
+    flip(t, k);
+
+    stack.emplace_back(t, 0);
+    stack.emplace_back(u, 0);
+  }
+}
+
+int32_t VoronoiGenerator::flip(int32_t triangle, int32_t edge) {
+  int32_t t = triangle;
+  int32_t k = edge;
+  int32_t u = mTriangleNeighbors[t][k];
+
+  // t = (p, b, c) with p at index k, u = (d, c, b).
+  uint32_t p  = mTriangleVertices[t][k];
+  uint32_t b  = mTriangleVertices[t][(k + 1) % 3];
+  uint32_t c  = mTriangleVertices[t][(k + 2) % 3];
+  int32_t  nB = mTriangleNeighbors[t][(k + 1) % 3]; // edge (c, p)
+  int32_t  nC = mTriangleNeighbors[t][(k + 2) % 3]; // edge (p, b)
+
+  int32_t j = 0;
+  while (mTriangleNeighbors[u][j] != t) {
+    ++j;
+  }
+
+  uint32_t d  = mTriangleVertices[u][j];
+  int32_t  nD = mTriangleNeighbors[u][(j + 1) % 3]; // edge (b, d)
+  int32_t  nE = mTriangleNeighbors[u][(j + 2) % 3]; // edge (d, c)
+
+  // Flips the edge (b, c) to (p, d).
+  mTriangleVertices[t] = {p, b, d};
+  mTriangleVertices[u] = {p, d, c};
+
+  mTriangleNeighbors[t] = {nD, u, nC};
+  mTriangleNeighbors[u] = {nE, nB, t};
+
+  replaceNeighbor(nB, t, u);
+  replaceNeighbor(nD, u, t);
+
+  updateVertexTriangles(t);
+  updateVertexTriangles(u);
+
+  return u;
+}
+
+void VoronoiGenerator::replaceNeighbor(int32_t triangle, int32_t oldNeighbor, int32_t newNeighbor) {
+  if (triangle < 0) {
+    return;
+  }
+
+  for (auto& n : mTriangleNeighbors[triangle]) {
+    if (n == oldNeighbor) {
+      n = newNeighbor;
+      return;
+    }
+  }
+}
+
+void VoronoiGenerator::updateOutput() const {
+  if (!mEdgesOutdated) {
+    return;
+  }
+
+  mTriangulationEdges.clear();
+
+  // Every inner edge is shared by two triangles, so it is only added by the one with the smaller
+  // index.
+  for (int32_t t = 0; t < static_cast<int32_t>(mTriangleVertices.size()); ++t) {
+    auto const& v = mTriangleVertices[t];
+    for (int32_t k = 0; k < 3; ++k) {
+      int32_t neighbor = mTriangleNeighbors[t][k];
+      if (neighbor < 0 || neighbor > t) {
+        mTriangulationEdges.emplace_back(mSites[v[(k + 1) % 3]], mSites[v[(k + 2) % 3]]);
+      }
+    }
+  }
+
+  mEdgesOutdated = false;
+}
+
+bool VoronoiGenerator::insertConstraint(Site const& site1, Site const& site2) {
+  uint32_t a{};
+  uint32_t b{};
+
+  if (!mIndexed || !findSite(site1, a) || !findSite(site2, b)) {
+    return false;
+  }
+
+  // Each step inserts the part of the segment up to the next site on it.
+  for (size_t step = 0; a != b && step < mSites.size(); ++step) {
+    uint32_t reached = b;
+    if (!insertConstraintSegment(a, b, reached)) {
+      return false;
+    }
+    a = reached;
+  }
+
+  mEdgesOutdated = true;
+
+  return a == b;
+}
+
+std::vector<uint32_t> VoronoiGenerator::getConstraintDepths() const {
+  std::vector<uint32_t> depths(mTriangleVertices.size(), std::numeric_limits<uint32_t>::max());
+  std::deque<int32_t>   queue;
+
+  // The boundary triangles are reached from the outside by crossing their boundary edges.
+  for (int32_t t = 0; t < static_cast<int32_t>(mTriangleVertices.size()); ++t) {
+    auto const& v = mTriangleVertices[t];
+    for (int32_t k = 0; k < 3; ++k) {
+      if (mTriangleNeighbors[t][k] < 0) {
+        uint32_t depth = isConstrained(v[(k + 1) % 3], v[(k + 2) % 3]) ? 1 : 0;
+        depths[t]      = std::min(depths[t], depth);
+      }
+    }
+  }
+
+  for (int32_t t = 0; t < static_cast<int32_t>(mTriangleVertices.size()); ++t) {
+    if (depths[t] == 0) {
+      queue.push_front(t);
+    } else if (depths[t] == 1) {
+      queue.push_back(t);
+    }
+  }
+
+  // Flood fill, crossing a constrained edge increases the depth by one. As the depth changes by
+  // zero or one only, triangles of the same depth are processed first by adding them to the front
+  // of the queue.
+  while (!queue.empty()) {
+    int32_t t = queue.front();
+    queue.pop_front();
+
+    auto const& v = mTriangleVertices[t];
+    for (int32_t k = 0; k < 3; ++k) {
+      int32_t u = mTriangleNeighbors[t][k];
+      if (u < 0) {
+        continue;
+      }
+
+      bool     constrained = isConstrained(v[(k + 1) % 3], v[(k + 2) % 3]);
+      uint32_t depth       = depths[t] + (constrained ? 1 : 0);
+
+      if (depth < depths[u]) {
+        depths[u] = depth;
+        if (constrained) {
+          queue.push_back(u);
+        } else {
+          queue.push_front(u);
+        }
+      }
+    }
+  }
+
+  return depths;
+}
+
+bool VoronoiGenerator::insertConstraintSegment(uint32_t site1, uint32_t site2, uint32_t& reached) {
+  int32_t triangle{};
+  int32_t edge{};
+
+  reached = site2;
+
+  if (findEdge(site1, site2, triangle, edge)) {
+    mConstraints.insert(edgeKey(site1, site2));
+    return true;
+  }
+
+  glm::dvec2 a = position(mSites, site1);
+  glm::dvec2 b = position(mSites, site2);
+
+  auto indexOf = [this](int32_t t, uint32_t vertex) {
+    auto const& v = mTriangleVertices[t];
+    return v[0] == vertex ? 0 : (v[1] == vertex ? 1 : 2);
+  };
+
+  // Finds the triangle around site1 through which the segment leaves it. The edge opposite to
+  // site1 is the first one which crosses the segment. The vertices of the crossing edges are
+  // stored with the one on the right side of the segment first.
+  std::vector<int32_t> around;
+  getTrianglesAround(site1, around);
+
+  int32_t  current = -1;
+  uint32_t right{};
+  uint32_t left{};
+
+  for (int32_t t : around) {
+    int32_t  i  = indexOf(t, site1);
+    uint32_t v1 = mTriangleVertices[t][(i + 1) % 3];
+    uint32_t v2 = mTriangleVertices[t][(i + 2) % 3];
+
+    glm::dvec2 p1 = position(mSites, v1);
+    glm::dvec2 p2 = position(mSites, v2);
+
+    // The segment passes through one of the neighbors, so only the part up to it is inserted.
+    for (auto [v, p] : {std::make_pair(v1, p1), std::make_pair(v2, p2)}) {
+      if (orientation(a, p, b) == 0 && glm::dot(p - a, b - a) > 0) {
+        reached = v;
+        mConstraints.insert(edgeKey(site1, v));
+        return true;
+      }
+    }
+
+    if (orientation(a, p1, b) > 0 && orientation(a, p2, b) < 0) {
+      current = t;
+      right   = v1;
+      left    = v2;
+      break;
+    }
+  }
+
+  if (current < 0) {
+    return false;
+  }
+
+  // Walks along the segment towards site2 and collects all crossing edges.
+  std::deque<std::pair<uint32_t, uint32_t>> crossing;
+
+  for (size_t step = 0; step <= mTriangleVertices.size(); ++step) {
+    if (isConstrained(right, left)) {
+      return false;
+    }
+
+    crossing.emplace_back(right, left);
+
+    // The crossing edge is opposite to the third vertex of the current triangle.
+    int32_t k = 3 - indexOf(current, right) - indexOf(current, left);
+    int32_t u = mTriangleNeighbors[current][k];
+    if (u < 0) {
+      return false;
+    }
+
+    int32_t j = 0;
+    while (mTriangleNeighbors[u][j] != current) {
+      ++j;
+    }
+
+    uint32_t d = mTriangleVertices[u][j];
+    if (d == site2) {
+      break;
+    }
+
+    double side = orientation(a, b, position(mSites, d));
+    if (side == 0) {
+      reached = d;
+      break;
+    }
+
+    if (side > 0) {
+      left = d;
+    } else {
+      right = d;
+    }
+
+    current = u;
+  }
+
+  b = position(mSites, reached);
+
+  // Flips the crossing edges until none is left. Edges of non-convex quadrilaterals cannot be
+  // flipped yet, they are moved to the back of the queue. The newly created edges which do not
+  // cross the segment are checked for the Delaunay property afterwards.
+  std::vector<std::pair<uint32_t, uint32_t>> created;
+
+  size_t maxSteps = 16 * crossing.size() * crossing.size() + 16;
+
+  for (size_t step = 0; !crossing.empty(); ++step) {
+    if (step > maxSteps) {
+      return false;
+    }
+
+    auto [r, l] = crossing.front();
+    crossing.pop_front();
+
+    int32_t t{};
+    int32_t k{};
+    if (!findEdge(r, l, t, k) || mTriangleNeighbors[t][k] < 0) {
+      return false;
+    }
+
+    int32_t u = mTriangleNeighbors[t][k];
+    int32_t j = 0;
+    while (mTriangleNeighbors[u][j] != t) {
+      ++j;
+    }
+
+    uint32_t p = mTriangleVertices[t][k];
+    uint32_t d = mTriangleVertices[u][j];
+
+    glm::dvec2 pp = position(mSites, p);
+    glm::dvec2 pb = position(mSites, mTriangleVertices[t][(k + 1) % 3]);
+    glm::dvec2 pc = position(mSites, mTriangleVertices[t][(k + 2) % 3]);
+    glm::dvec2 pd = position(mSites, d);
+
+    if (orientation(pp, pb, pd) <= 0 || orientation(pp, pd, pc) <= 0) {
+      crossing.emplace_back(r, l);
+      continue;
+    }
+
+    flip(t, k);
+
+    if (p != site1 && p != reached && d != site1 && d != reached && crosses(a, b, pp, pd)) {
+      crossing.emplace_back(p, d);
+    } else {
+      created.emplace_back(p, d);
+    }
+  }
+
+  mConstraints.insert(edgeKey(site1, reached));
+
+  // Restores the Delaunay property for the new edges, except for the constrained ones.
+  bool flipped = true;
+  for (size_t step = 0; flipped && step <= created.size(); ++step) {
+    flipped = false;
+
+    for (auto& e : created) {
+      int32_t t{};
+      int32_t k{};
+      if (isConstrained(e.first, e.second) || !findEdge(e.first, e.second, t, k) ||
+          mTriangleNeighbors[t][k] < 0) {
+        continue;
+      }
+
+      int32_t u = mTriangleNeighbors[t][k];
+      int32_t j = 0;
+      while (mTriangleNeighbors[u][j] != t) {
+        ++j;
+      }
+
+      uint32_t p = mTriangleVertices[t][k];
+      uint32_t d = mTriangleVertices[u][j];
+
+      if (inCircle(position(mSites, p), position(mSites, mTriangleVertices[t][(k + 1) % 3]),
+              position(mSites, mTriangleVertices[t][(k + 2) % 3]), position(mSites, d)) > 0) {
+        flip(t, k);
+        e       = {p, d};
+        flipped = true;
+      }
+    }
+  }
+
+  return true;
+}
+
+Statistics const& VoronoiGenerator::getStatistics() const {
+  return mStatistics;
+}
+
+bool VoronoiGenerator::isConstrained(uint32_t site1, uint32_t site2) const {
+  return !mConstraints.empty() && mConstraints.count(edgeKey(site1, site2)) > 0;
+}
 } // namespace csp::measurementtools
@@ -7,59 +7,146 @@
 #ifndef CSP_MEASUREMENT_TOOLS_VORONOI_GENERATOR_HPP
 #define CSP_MEASUREMENT_TOOLS_VORONOI_GENERATOR_HPP
 
+#include "../Statistics.hpp"
 #include "Beachline.hpp"
 #include "Circle.hpp"
+#include "ObjectPool.hpp"
 #include "Site.hpp"
 #include "Vector2f.hpp"
 
-#include <map>
+#include <glm/glm.hpp>
+
+#include <array>
 #include <queue>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 namespace csp::measurementtools {
 
 using Edge     = std::pair<Vector2f, Vector2f>;
 using Edge2    = std::pair<Site, Site>;
-using Triangle = std::tuple<Site, Site, Site>;
+using Triangle = std::array<uint32_t, 3>;
 
 class VoronoiGenerator {
  public:
   VoronoiGenerator();
 
   void parse(std::vector<Site> const& sites);
+  void parse(SiteArray const& sites);
+
+  /// Inserts a single site into the triangulation created by parse(). Only the triangles around
+  /// the new site are updated with local edge flips, which is much cheaper than parsing all sites
+  /// again. The Voronoi edges (getEdges()) are not updated by this. If the site is outside of the
+  /// current triangulation, all sites are parsed again.
+  void insert(Site const& site);
 
   double sweepLine() const;
 
   double maxY() const;
   double minY() const;
 
-  std::vector<Site> const&                     getSites() const;
-  std::vector<Edge> const&                     getEdges() const;
-  std::vector<Edge2> const&                    getTriangulation() const;
-  std::vector<Triangle> const&                 getTriangles() const;
-  std::map<uint16_t, std::vector<Site>> const& getNeighbors() const;
+  SiteArray const&          getSites() const;
+  std::vector<Edge> const&  getEdges() const;
+  std::vector<Edge2> const& getTriangulation() const;
+
+  /// The triangles are given by the indices of their corners in getSites(), in counter-clockwise
+  /// order.
+  std::vector<Triangle> const& getTriangles() const;
+
+  /// Returns all sites which are connected to the given site by an edge of the triangulation.
+  std::vector<Site> getNeighbors(Site const& site) const;
+
+  /// Returns true if the two sites are connected by an edge of the triangulation.
+  bool hasEdge(Site const& site1, Site const& site2) const;
 
-  void addTriangulationEdge(Site const& site1, Site const& site2);
+  /// Called by the Beachline for each new edge of the triangulation. Returns the index of the
+  /// edge which is used to connect the triangles on both sides of it.
+  uint32_t addTriangulationEdge(Site const& site1, Site const& site2);
+
+  /// Removes the edge and the triangles on both sides of it from the triangulation.
   void removeTriangulationEdge(Site const& site1, Site const& site2);
 
+  /// Inserts the segment between the two sites as a constraint into the triangulation created by
+  /// parse(). All edges which cross it are flipped away and the Delaunay property is restored
+  /// around it afterwards. Constrained edges are never flipped, neither by this nor by insert().
+  /// If the segment passes through other sites, it is split at them. Returns false if the segment
+  /// crosses another constraint or cannot be inserted for numerical reasons.
+  bool insertConstraint(Site const& site1, Site const& site2);
+
+  /// Returns the minimal number of constrained edges which have to be crossed to get from outside
+  /// of the triangulation into each of the triangles. For the edges of a closed polygon, the
+  /// triangles with an odd depth are inside of it.
+  std::vector<uint32_t> getConstraintDepths() const;
+
+  /// The time spent in parse() and the parsed sites, processed circle events and created edges of
+  /// all calls to parse() of this instance.
+  Statistics const& getStatistics() const;
+
  private:
   void process(Site const& event);
   void process(Circle* event);
   void addCircleEvent(Arc* arc);
   void finishEdges();
 
+  // Triangle mesh
+  void addTriangle(Triangle vertices, std::array<uint32_t, 3> edges);
+  void removeTriangle(int32_t triangle);
+  void updateVertexTriangles(int32_t triangle);
+  void getTrianglesAround(uint32_t vertex, std::vector<int32_t>& triangles) const;
+  bool findEdge(uint32_t site1, uint32_t site2, int32_t& triangle, int32_t& edge) const;
+  bool findSite(Site const& site, uint32_t& index) const;
+
+  // Incremental insertion
+  bool locate(glm::dvec2 const& point, int32_t& triangle, int32_t& edge) const;
+  void splitTriangle(int32_t triangle, uint32_t site);
+  void splitEdge(int32_t triangle, int32_t edge, uint32_t site);
+  void legalize(int32_t triangle, int32_t edge);
+  int32_t flip(int32_t triangle, int32_t edge);
+  void replaceNeighbor(int32_t triangle, int32_t oldNeighbor, int32_t newNeighbor);
+  void updateOutput() const;
+
+  // Constrained triangulation
+  bool insertConstraintSegment(uint32_t site1, uint32_t site2, uint32_t& reached);
+  bool isConstrained(uint32_t site1, uint32_t site2) const;
+
   Beachline mBeachline;
   double    mSweepline;
   double    mMaxY, mMinY;
 
   std::priority_queue<Site, std::vector<Site>, SitePosComp>        mSiteEvents;
   std::priority_queue<Circle*, std::vector<Circle*>, CirclePtrCmp> mCircleEvents;
+  ObjectPool<Circle>                                               mCircles;
+
+  SiteArray                  mSites;
+  std::vector<Edge>          mVoronoiEdges;
+  mutable std::vector<Edge2> mTriangulationEdges;
+
+  // Maps the addresses of the sites to their index in mSites.
+  std::unordered_map<uint32_t, uint32_t> mSiteIndices;
+
+  // The triangles of the Delaunay triangulation. A triangle is added for each circle event of the
+  // sweep and modified by insert(). The vertices are indices into mSites in counter-clockwise
+  // order, neighbor k is the triangle opposite to vertex k (or -1). Once the mesh was modified,
+  // mTriangulationEdges is derived from it when it is requested.
+  std::vector<Triangle>               mTriangleVertices;
+  std::vector<std::array<int32_t, 3>> mTriangleNeighbors;
+
+  // One triangle for each site (or -1), used to find the triangles around a site.
+  std::vector<int32_t> mVertexTriangles;
+
+  // The first triangle (and the index of the opposite vertex) found for each edge during the
+  // sweep. The second triangle of an edge is connected to it.
+  std::vector<std::pair<int32_t, int32_t>> mPendingEdges;
+
+  // The constrained edges, given by the indices of both sites (the smaller one in the upper half).
+  std::unordered_set<uint64_t> mConstraints;
+
+  int32_t      mLastTriangle  = 0;
+  bool         mIndexed       = false;
+  mutable bool mEdgesOutdated = false;
 
-  std::vector<Site>                     mSites;
-  std::vector<Edge>                     mVoronoiEdges;
-  std::vector<Edge2>                    mTriangulationEdges;
-  std::vector<Triangle>                 mTriangles;
-  std::map<uint16_t, std::vector<Site>> mNeighbors;
+  Statistics mStatistics;
 };
 } // namespace csp::measurementtools
 #endif // CSP_MEASUREMENT_TOOLS_VORONOI_GENERATOR_HPP